@@ -0,0 +1,35 @@
+#version 400
+
+// Passed from the vertex shader
+in vec2 uv;
+
+// Passed from outside
+uniform sampler2D source_map;
+uniform vec4 texel_size; // Of the source level
+uniform float threshold;
+uniform int bright_pass;
+
+
+void main() 
+{
+	// The destination texel covers 2x2 source texels; four bilinear taps
+	// around its centre average the surrounding 4x4 block
+	vec2 d = texel_size.xy;
+	vec3 colour = 0.25*(texture(source_map, uv + vec2(-d.x, -d.y)).rgb +
+	                    texture(source_map, uv + vec2( d.x, -d.y)).rgb +
+	                    texture(source_map, uv + vec2(-d.x,  d.y)).rgb +
+	                    texture(source_map, uv + vec2( d.x,  d.y)).rgb);
+
+	if (bright_pass != 0)
+	{
+		// Keep what exceeds the threshold; the quadratic knee below it
+		// lets the glow fade in instead of popping
+		float knee = 0.5*threshold;
+		float brightness = max(colour.r, max(colour.g, colour.b));
+		float soft = clamp(brightness - threshold + knee, 0.0, 2.0*knee);
+		soft = soft*soft/(4.0*knee + 0.00001);
+		colour *= max(soft, brightness - threshold)/max(brightness, 0.00001);
+	}
+
+	gl_FragColor = vec4(colour, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 400
+
+// Passed from the vertex shader
+in vec2 uv;
+
+// Passed from outside
+uniform sampler2D source_map;
+uniform vec4 texel_size; // Of the source level, the smaller one
+
+
+void main() 
+{
+	// 3x3 tent filter; the result is added to the level above by blending
+	vec2 d = texel_size.xy;
+	vec3 colour = 4.0*texture(source_map, uv).rgb;
+	colour += 2.0*(texture(source_map, uv + vec2(-d.x, 0.0)).rgb +
+	               texture(source_map, uv + vec2( d.x, 0.0)).rgb +
+	               texture(source_map, uv + vec2(0.0, -d.y)).rgb +
+	               texture(source_map, uv + vec2(0.0,  d.y)).rgb);
+	colour += texture(source_map, uv + vec2(-d.x, -d.y)).rgb +
+	          texture(source_map, uv + vec2( d.x, -d.y)).rgb +
+	          texture(source_map, uv + vec2(-d.x,  d.y)).rgb +
+	          texture(source_map, uv + vec2( d.x,  d.y)).rgb;
+
+	gl_FragColor = vec4(colour/16.0, 1.0);
+}
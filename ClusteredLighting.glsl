@@ -0,0 +1,47 @@
+#version 400
+
+// Shared by the Shiny* fragment shaders (see "attach" in their material files)
+// The light data, cluster grid and light lists are rebuilt on the CPU every frame by ClusteredLighting
+
+uniform sampler2D light_data;        // Row 0: view-space position and radius, row 1: colour and intensity
+uniform sampler2D cluster_grid;      // One texel per cluster: offset and count in the light index list
+uniform sampler2D light_indices;     // Light index list, 1024 entries per row
+uniform vec3 cluster_grid_size;      // Tiles in x, tiles in y, depth slices
+uniform vec3 cluster_depth;          // Near, far, 1/log(far/near)
+uniform vec4 cluster_projection;     // Projection entries [0][0], [1][1], [0][2], [1][2] used for binning
+
+
+// Find the light list of the cluster that contains a view-space position
+void GetClusterLights(vec3 position, out int offset, out int count)
+{
+	// Project with the same matrix the CPU used, so render target flipping does not matter
+	float depth = max(-position.z, cluster_depth.x);
+	vec2 ndc = (cluster_projection.xy*position.xy + cluster_projection.zw*position.z)/depth;
+	ivec2 tile = ivec2(clamp((ndc*0.5 + 0.5)*cluster_grid_size.xy, vec2(0.0), cluster_grid_size.xy - 1.0));
+
+	// Exponential depth slices
+	float slice = log(depth/cluster_depth.x)*cluster_depth.z*cluster_grid_size.z;
+	int z = int(clamp(slice, 0.0, cluster_grid_size.z - 1.0));
+
+	vec4 cluster = texelFetch(cluster_grid, ivec2(tile.y*int(cluster_grid_size.x) + tile.x, z), 0);
+	offset = int(cluster.x);
+	count = int(cluster.y);
+}
+
+
+// Fetch a light of a cluster list; returns its contribution weight at the position
+float GetClusterLight(int index, vec3 position, out vec3 L, out vec3 colour)
+{
+	int light = int(texelFetch(light_indices, ivec2(index % 1024, index / 1024), 0).r);
+	vec4 position_radius = texelFetch(light_data, ivec2(light, 0), 0);
+	vec4 colour_intensity = texelFetch(light_data, ivec2(light, 1), 0);
+
+	L = position_radius.xyz - position;
+	float distance = length(L);
+	L = L/max(distance, 1e-5);
+	colour = colour_intensity.rgb;
+
+	// Smooth falloff that reaches zero at the light radius
+	float falloff = clamp(1.0 - pow(distance/position_radius.w, 4.0), 0.0, 1.0);
+	return colour_intensity.a*falloff*falloff;
+}
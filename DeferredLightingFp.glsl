@@ -0,0 +1,92 @@
+#version 400
+
+// Lighting pass of the deferred path: every screen pixel is shaded exactly once
+
+// Passed from the vertex shader
+in vec2 uv;
+
+// Passed from outside
+uniform sampler2D gbuffer_normal_depth;
+uniform sampler2D gbuffer_albedo;
+uniform sampler2D gbuffer_specular;
+uniform vec4 cluster_projection; // Also used by ClusteredLighting.glsl
+uniform vec4 background_colour;
+
+// Defined in GBufferPacking.glsl
+vec3 DecodeNormal(vec2 e);
+
+// Defined in ClusteredLighting.glsl
+void GetClusterLights(vec3 position, out int offset, out int count);
+float GetClusterLight(int index, vec3 position, out vec3 L, out vec3 colour);
+
+
+void main() 
+{
+	vec4 normal_depth = texture(gbuffer_normal_depth, uv);
+	float depth = normal_depth.z;
+
+	// Nothing was drawn here
+	if (depth <= 0.0)
+	{
+		gl_FragColor = background_colour;
+		return;
+	}
+
+	vec4 albedo = texture(gbuffer_albedo, uv);
+	vec4 specular = texture(gbuffer_specular, uv);
+	int model = int(normal_depth.w + 0.5);
+	float phong_exponent = specular.a*255.0;
+
+	// Rebuild the view-space position from the screen position and depth
+	vec2 ndc = vec2(uv.x*2.0 - 1.0, 1.0 - uv.y*2.0);
+	vec3 position = vec3((ndc + cluster_projection.zw)*depth/cluster_projection.xy, -depth);
+
+	vec3 N = DecodeNormal(normal_depth.xy);
+	vec3 V = normalize(-position);
+	vec3 L;
+
+	int offset, count;
+	GetClusterLights(position, offset, count);
+
+	vec3 diffuse_light = vec3(0.0);
+	vec3 specular_light = vec3(0.0);
+	float intensity = 0.0;
+	for (int i = offset; i < offset + count; i++)
+	{
+		vec3 light_colour;
+		float weight = GetClusterLight(i, position, L, light_colour);
+
+		float Id = max(dot(N, L), 0.0);
+		float spec_angle_cos;
+		if (model == 2)
+			spec_angle_cos = max(dot(N, normalize(V + L)), 0.0); // Blinn-Phong
+		else
+			spec_angle_cos = max(dot(V, reflect(-L, N)), 0.0); // Phong
+		float Is = pow(spec_angle_cos, phong_exponent);
+
+		diffuse_light += weight*Id*light_colour;
+		specular_light += weight*Is*light_colour;
+		intensity += weight*(Id + Is);
+	}
+
+	// Same shading models as the forward Shiny* shaders
+	if (model == 1)
+	{
+		vec4 color;
+		if (intensity > 0.95)
+			color = vec4(1.0,0.5,0.5,1.0);
+		else if (intensity > 0.5)
+			color = vec4(0.6,0.3,0.3,1.0);
+		else if (intensity > 0.25)
+			color = vec4(0.4,0.2,0.2,1.0);
+		else
+			color = vec4(0.2,0.1,0.1,1.0);
+		if (dot(V, N) < 0.2)
+			color = vec4(0.0,0.0,0.0,1.0);
+		gl_FragColor = color;
+	}
+	else
+	{
+		gl_FragColor = vec4((albedo.a + diffuse_light)*albedo.rgb + specular_light*specular.rgb, 1.0);
+	}
+}
@@ -0,0 +1,14 @@
+#version 400
+
+// Passed from the vertex shader
+in vec2 uv;
+
+// Passed from outside
+uniform sampler2D capture_map;
+
+
+void main() 
+{
+	// Copy of the captured image to the window
+	gl_FragColor = texture(capture_map, uv);
+}
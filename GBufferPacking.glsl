@@ -0,0 +1,26 @@
+#version 400
+
+// Normal packing shared by the G-buffer, deferred lighting and vertex decoding programs
+// Unit normals are stored with an octahedral mapping in two channels
+
+
+vec2 OctahedronWrap(vec2 v)
+{
+	return (1.0 - abs(v.yx))*vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+
+vec2 EncodeNormal(vec3 n)
+{
+	n /= (abs(n.x) + abs(n.y) + abs(n.z));
+	n.xy = n.z >= 0.0 ? n.xy : OctahedronWrap(n.xy);
+	return n.xy;
+}
+
+
+vec3 DecodeNormal(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	n.xy = n.z >= 0.0 ? n.xy : OctahedronWrap(n.xy);
+	return normalize(n);
+}
@@ -0,0 +1,27 @@
+#version 400
+
+// Geometry pass of the deferred path for the ShinyTexture materials
+
+// Attributes passed from the vertex shader
+in vec3 position_interp;
+in vec3 normal_interp;
+in vec2 uv_interp;
+
+// Attributes passed with the material file
+uniform vec4 specular_colour;
+uniform float ambient_amount;
+uniform float phong_exponent;
+uniform sampler2D diffuse_map;
+
+// Defined in GBufferPacking.glsl
+vec2 EncodeNormal(vec3 n);
+
+void main() 
+{
+	// 0: normal and view depth, plus the shading model (2 textured Blinn-Phong)
+	gl_FragData[0] = vec4(EncodeNormal(normalize(normal_interp)), -position_interp.z, 2.0);
+	// 1: albedo and the ambient amount
+	gl_FragData[1] = vec4(texture(diffuse_map, uv_interp).rgb, ambient_amount);
+	// 2: specular colour and exponent
+	gl_FragData[2] = vec4(specular_colour.rgb, phong_exponent/255.0);
+}
@@ -0,0 +1,8 @@
+#version 400
+
+
+void main() 
+{
+	// Colour writes are off; only the samples that pass the depth test count
+	gl_FragColor = vec4(1.0);
+}
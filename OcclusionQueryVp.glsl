@@ -0,0 +1,13 @@
+#version 400
+
+in vec3 vertex;
+
+uniform mat4 world_mat;
+uniform mat4 view_mat;
+uniform mat4 projection_mat;
+
+void main()
+{
+    // Unit box scaled and moved onto an entity's bounds by the world matrix
+    gl_Position = projection_mat * view_mat * world_mat * vec4(vertex, 1.0);
+}
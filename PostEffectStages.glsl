@@ -0,0 +1,108 @@
+#version 400
+
+// Stages of the screen-space effects, shared by ScreenSpaceFp.glsl and the passes
+// generated by EffectGraph. A stage is one of
+//   UV remap:     vec2 Stage(vec2 uv)                 where the stage reads its input
+//   point-wise:   vec4 Stage(vec4 colour, vec2 uv)    the input texel at uv only
+//   neighborhood: vec4 Stage(sampler2D map, vec2 uv)  any texels of the input
+
+// Passed from outside
+uniform float time;
+// Active waves of ShockwavePool: centre, radius, strength
+uniform vec4 shockwaves[16];
+uniform int num_shockwaves;
+
+
+vec2 Waver(vec2 uv)
+{
+	vec2 pos = uv;
+	pos.x = pos.x + 0.05*(sin(time/10.0+8.0*pos.y));
+	return pos;
+}
+
+
+vec4 Blur(sampler2D map, vec2 uv)
+{
+	//find out the pixel size
+	float px = 1.0/100;
+	float py = 1.0/100;
+
+	//for each pixel, calculate the average color of a 5x5 neighborhood
+	vec4 tempColor = vec4(0.0,0.0,0.0,1.0);
+	for(int i=-2; i<3;i++){
+		for(int j=-2; j<3; j++){
+			tempColor += texture(map, uv+vec2(px*i, py*j) );
+		}
+	}
+	return tempColor * (1.0/25.0);
+}
+
+
+vec2 Tile(vec2 uv)
+{
+	//2X2 tiling of the scene
+	return uv*2;
+}
+
+
+vec4 Wipe(vec4 colour, vec2 uv)
+{
+	//horizontal wipe
+	float distToLeft = uv.x;
+	float sweepCurve =  time/500.0+ 0.1;
+
+	if(distToLeft<sweepCurve)
+		return vec4(0.0,0.0,1.0,1.0);
+	return colour;
+}
+
+
+vec4 HeartBeat(vec4 colour, vec2 uv)
+{
+	float delta = 0.0;
+	if(sin(time/24.0)>0)
+		delta = 0.8*abs(sin(time/12.0));
+	colour.r += delta;
+	colour.g -= delta;
+	colour.b -= delta;
+	return colour;
+}
+
+
+vec2 Shockwave(vec2 uv)
+{
+	float shockParams = 80.0;
+	vec2 texCoord = uv;
+	vec2 center = vec2(0.5,0.5);
+	float distace = distance(uv, center);
+	if ( (distace <= ( time/1000 + 0.1)) &&
+		 (distace >= ( time/1000 - 0.1)) )
+	{
+		float diff = (distace - time/1000 );
+		float powDiff = 1.0 - pow(abs(diff*10.0),
+									0.8);
+		float diffTime = diff  * powDiff;
+		vec2 diffUV = normalize(uv - center);
+		texCoord = uv + (diffUV * diffTime);
+	}
+	return texCoord;
+}
+
+
+vec2 Shockwaves(vec2 uv)
+{
+	// The ring of Shockwave for every active wave, in one pass
+	vec2 offset = vec2(0.0);
+	for (int i = 0; i < num_shockwaves; i++)
+	{
+		vec2 center = shockwaves[i].xy;
+		float distace = distance(uv, center);
+		float diff = distace - shockwaves[i].z;
+		if ((abs(diff) <= 0.1) && (distace > 0.0))
+		{
+			float powDiff = 1.0 - pow(abs(diff*10.0), 0.8);
+			offset += normalize(uv - center) * diff * powDiff * shockwaves[i].w;
+		}
+	}
+	return uv + offset;
+}
@@ -1,93 +1,92 @@
-#version 400
-
-// Attributes passed from the vertex shader
-in vec3 position_interp;
-in vec3 normal_interp;
-in vec4 colour_interp;
-in vec3 light_pos;
-in vec3 light_pos2;
-
-// Attributes passed with the material file
-uniform vec4 ambient_colour;
-uniform vec4 diffuse_colour;
-uniform vec4 specular_colour;
-uniform float phong_exponent;
-uniform int type;
-
-void main() 
-{
-    // BlinnPhong shading
-
-    vec3 N, // Interpolated normal for fragment
-	     L, // Light-source direction
-		 L2,
-		 V, // View direction
-		 H, // Half-way vector
-		 R,
-		 R2; //Reflection
-
-	// Compute Lambertian lighting Id
-    N = normalize(normal_interp);
-
-	L = (light_pos - position_interp);
-	L = normalize(L);
-	L2 = (light_pos2 - position_interp);
-	L2 = normalize(L2);
-
-	float Id = max(dot(N, L), 0.0);
-	float Id2 = max(dot(N, L2), 0.0);
-	
-	// Compute specular term for BlinnPhong shading
-	// Initially: V = (eye_position - position_interp);
-	V = - position_interp; // Eye position is (0, 0, 0) in view coordinates
-    V = normalize(V);
-
-    H = 0.5*(V + L); // Halfway vector
-    H = normalize(H);
-
-	//for Q1 plain Phong (V.R)
-	R = reflect(-L, N);
-	R2 = reflect(-L2, N);
-	//R = 2*dot(N, L)*N -L;
-	float spec_angle_cos = max(dot(V, R), 0.0);
-	float spec_angle_cos2 = max(dot(V, R2), 0.0);
-
-    //float spec_angle_cos = max(dot(N, H), 0.0);
-	float Is = pow(spec_angle_cos, phong_exponent);
-	float Is2 = pow(spec_angle_cos2, phong_exponent);
-	    
-	// Assign light to the fragment
-	if(type == 0)
-		gl_FragColor = ambient_colour + (Id+Id2)/2*diffuse_colour + (Is+Is2)/2*specular_colour;
-	
-	if(type == 1)
-	{
-			float intensity = (Id+Id2)/2+(Is+Is2)/2;
-			vec4 color;
-			if (intensity > 0.95)
-				color = vec4(1.0,0.5,0.5,1.0);
-			else if (intensity > 0.5)
-				color = vec4(0.6,0.3,0.3,1.0);
-			else if (intensity > 0.25)
-				color = vec4(0.4,0.2,0.2,1.0);
-			else
-				color = vec4(0.2,0.1,0.1,1.0);
-			gl_FragColor = color;
-			
-			if(dot(V, N) < 0.2)
-			{
-				gl_FragColor = vec4(0.0,0.0,0.0,1.0);
-			}
-
-
-	}
-
-	// For debug, we can display the different values
-	//gl_FragColor = ambient_colour;
-	//gl_FragColor = diffuse_colour;
-	//gl_FragColor = specular_colour;
-	//gl_FragColor = colour_interp;
-	//gl_FragColor = vec4(N.xyz, 1.0);
-	//gl_FragColor = vec4(L.xyz, 1.0);
-	//gl_FragColor = vec4(V.xyz, 1.0);
-}
+#version 400
+
+// Attributes passed from the vertex shader
+in vec3 position_interp;
+in vec3 normal_interp;
+in vec4 colour_interp;
+
+// Attributes passed with the material file
+uniform vec4 ambient_colour;
+uniform vec4 diffuse_colour;
+uniform vec4 specular_colour;
+uniform float phong_exponent;
+uniform int type;
+
+// Defined in ClusteredLighting.glsl
+void GetClusterLights(vec3 position, out int offset, out int count);
+float GetClusterLight(int index, vec3 position, out vec3 L, out vec3 colour);
+
+void main() 
+{
+    // BlinnPhong shading
+
+    vec3 N, // Interpolated normal for fragment
+	     L, // Light-source direction
+		 V, // View direction
+		 R; //Reflection
+
+    N = normalize(normal_interp);
+
+	// Initially: V = (eye_position - position_interp);
+	V = - position_interp; // Eye position is (0, 0, 0) in view coordinates
+    V = normalize(V);
+
+	// Only the lights whose range touches this fragment's cluster
+	int offset, count;
+	GetClusterLights(position_interp, offset, count);
+
+	vec3 diffuse_light = vec3(0.0);
+	vec3 specular_light = vec3(0.0);
+	float intensity = 0.0;
+	for (int i = offset; i < offset + count; i++)
+	{
+		vec3 light_colour;
+		float weight = GetClusterLight(i, position_interp, L, light_colour);
+
+		// Compute Lambertian lighting Id
+		float Id = max(dot(N, L), 0.0);
+
+		//for Q1 plain Phong (V.R)
+		R = reflect(-L, N);
+		float spec_angle_cos = max(dot(V, R), 0.0);
+		float Is = pow(spec_angle_cos, phong_exponent);
+
+		diffuse_light += weight*Id*light_colour;
+		specular_light += weight*Is*light_colour;
+		intensity += weight*(Id + Is);
+	}
+	    
+	// Assign light to the fragment
+	if(type == 0)
+		gl_FragColor = ambient_colour + vec4(diffuse_light, 1.0)*diffuse_colour + vec4(specular_light, 1.0)*specular_colour;
+	
+	if(type == 1)
+	{
+			vec4 color;
+			if (intensity > 0.95)
+				color = vec4(1.0,0.5,0.5,1.0);
+			else if (intensity > 0.5)
+				color = vec4(0.6,0.3,0.3,1.0);
+			else if (intensity > 0.25)
+				color = vec4(0.4,0.2,0.2,1.0);
+			else
+				color = vec4(0.2,0.1,0.1,1.0);
+			gl_FragColor = color;
+			
+			if(dot(V, N) < 0.2)
+			{
+				gl_FragColor = vec4(0.0,0.0,0.0,1.0);
+			}
+
+
+	}
+
+	// For debug, we can display the different values
+	//gl_FragColor = ambient_colour;
+	//gl_FragColor = diffuse_colour;
+	//gl_FragColor = specular_colour;
+	//gl_FragColor = colour_interp;
+	//gl_FragColor = vec4(N.xyz, 1.0);
+	//gl_FragColor = vec4(L.xyz, 1.0);
+	//gl_FragColor = vec4(V.xyz, 1.0);
+}
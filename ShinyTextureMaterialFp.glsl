@@ -1,53 +1,64 @@
-#version 400
-
-// Attributes passed from the vertex shader
-in vec3 position_interp;
-in vec3 normal_interp;
-in vec4 colour_interp;
-in vec2 uv_interp;
-in vec3 light_pos;
-
-// Attributes passed with the material file
-uniform vec4 ambient_colour;
-uniform vec4 diffuse_colour;
-uniform vec4 specular_colour;
-uniform float ambient_amount;
-uniform float phong_exponent;
-uniform sampler2D diffuse_map;
-
-
-void main() 
-{
-    // BlinnPhong shading
-
-    vec3 N, // Interpolated normal for fragment
-	     L, // Light-source direction
-		 V, // View direction
-		 H; // Half-way vector
-
-	// Compute Lambertian lighting
-    N = normalize(normal_interp);
-
-	L = (light_pos - position_interp);
-	L = normalize(L);
-
-	float lambertian_amount = max(dot(N, L), 0.0);
-	
-	// Compute specular term for BlinnPhong shading
-	V = - position_interp; // Eye position is (0, 0, 0)
-    V = normalize(V);
-
-    H = 0.5*(V + L);
-    H = normalize(H);
-
-    float spec_angle_cos = max(dot(N, H), 0.0);
-	float specular_amount = pow(spec_angle_cos, phong_exponent);
-	    
-	// Retrieve texture value
-	vec4 pixel = texture(diffuse_map, uv_interp);
-
-	// Use texture in determining fragment colour
-	//gl_FragColor = pixel;
-	gl_FragColor = (ambient_amount + lambertian_amount)*pixel + specular_amount*specular_colour;
-	//gl_FragColor = (ambient_amount + lambertian_amount + specular_amount)*pixel;
+#version 400
+
+// Attributes passed from the vertex shader
+in vec3 position_interp;
+in vec3 normal_interp;
+in vec4 colour_interp;
+in vec2 uv_interp;
+
+// Attributes passed with the material file
+uniform vec4 ambient_colour;
+uniform vec4 diffuse_colour;
+uniform vec4 specular_colour;
+uniform float ambient_amount;
+uniform float phong_exponent;
+uniform sampler2D diffuse_map;
+
+// Defined in ClusteredLighting.glsl
+void GetClusterLights(vec3 position, out int offset, out int count);
+float GetClusterLight(int index, vec3 position, out vec3 L, out vec3 colour);
+
+void main() 
+{
+    // BlinnPhong shading
+
+    vec3 N, // Interpolated normal for fragment
+	     L, // Light-source direction
+		 V, // View direction
+		 H; // Half-way vector
+
+    N = normalize(normal_interp);
+
+	V = - position_interp; // Eye position is (0, 0, 0)
+    V = normalize(V);
+
+	// Only the lights whose range touches this fragment's cluster
+	int offset, count;
+	GetClusterLights(position_interp, offset, count);
+
+	vec3 lambertian_amount = vec3(0.0);
+	vec3 specular_amount = vec3(0.0);
+	for (int i = offset; i < offset + count; i++)
+	{
+		vec3 light_colour;
+		float weight = GetClusterLight(i, position_interp, L, light_colour);
+
+		// Compute Lambertian lighting
+		lambertian_amount += weight*max(dot(N, L), 0.0)*light_colour;
+
+		// Compute specular term for BlinnPhong shading
+		H = 0.5*(V + L);
+		H = normalize(H);
+
+		float spec_angle_cos = max(dot(N, H), 0.0);
+		specular_amount += weight*pow(spec_angle_cos, phong_exponent)*light_colour;
+	}
+	    
+	// Retrieve texture value
+	vec4 pixel = texture(diffuse_map, uv_interp);
+
+	// Use texture in determining fragment colour
+	//gl_FragColor = pixel;
+	gl_FragColor = vec4(ambient_amount + lambertian_amount, 1.0)*pixel + vec4(specular_amount, 1.0)*specular_colour;
+	//gl_FragColor = vec4(ambient_amount + lambertian_amount + specular_amount, 1.0)*pixel;
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#version 400
+
+// Decoding of the vertex layouts written by VertexCompression
+// The parameters are set per entity, so meshes of every layout share the Shiny* programs
+
+// Passed from outside
+uniform vec4 vertex_scale; // Position scale, w is 1 for octahedral short normals
+uniform vec4 vertex_bias; // Position offset, w scales the texture coordinates
+
+// Defined in GBufferPacking.glsl
+vec3 DecodeNormal(vec2 e);
+
+
+vec3 DecodeVertexPosition(vec3 vertex)
+{
+	return vertex*vertex_scale.xyz + vertex_bias.xyz;
+}
+
+
+vec3 DecodeVertexNormal(vec3 normal)
+{
+	if (vertex_scale.w > 0.5)
+		return DecodeNormal(normal.xy/32767.0);
+	return normal;
+}
+
+
+vec2 DecodeVertexUv(vec2 uv)
+{
+	return uv*vertex_bias.w;
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <new>
+
+#include "arena.h"
+
+namespace ogre_application {
+
+Arena::Arena(size_t block_size){
+
+	block_size_ = block_size;
+	offset_ = 0;
+	used_ = 0;
+	capacity_ = 0;
+	peak_ = 0;
+}
+
+
+Arena::~Arena(void){
+
+	Release();
+}
+
+
+void *Arena::Allocate(size_t size, size_t alignment){
+
+	/* Align within the current block, or start a block large enough for the request */
+	if (!blocks_.empty()){
+		Block &block = blocks_.back();
+		size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+		if (start + size <= block.size){
+			offset_ = start + size;
+			used_ += size;
+			return block.data + start;
+		}
+	}
+
+	/* Blocks come from operator new, which aligns for any fundamental type */
+	Block block;
+	block.size = std::max(block_size_, size);
+	block.data = static_cast<char *>(::operator new(block.size));
+	blocks_.push_back(block);
+	capacity_ += block.size;
+	peak_ = std::max(peak_, capacity_);
+	offset_ = size;
+	used_ += size;
+	return block.data;
+}
+
+
+void Arena::Reset(void){
+
+	/* Requests larger than a block get a block of their own, which is not worth keeping */
+	for (size_t i = blocks_.size(); i > 1; i--){
+		capacity_ -= blocks_[i - 1].size;
+		::operator delete(blocks_[i - 1].data);
+	}
+	if (blocks_.size() > 1){
+		blocks_.resize(1);
+	}
+	if (!blocks_.empty() && blocks_[0].size > block_size_){
+		Release();
+	}
+	offset_ = 0;
+	used_ = 0;
+}
+
+
+void Arena::Release(void){
+
+	for (size_t i = 0; i < blocks_.size(); i++){
+		::operator delete(blocks_[i].data);
+	}
+	blocks_.clear();
+	offset_ = 0;
+	used_ = 0;
+	capacity_ = 0;
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,52 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace ogre_application {
+
+	/* Bump allocator for short-lived construction data */
+	/* Allocations only move a pointer forward inside a block; a new block is taken when
+	   the current one is full. Nothing is freed on its own: Reset() drops everything at
+	   once, after the data was uploaded. Only use it for types that need no destructor */
+	class Arena
+	{
+		public:
+			Arena(size_t block_size = 64*1024);
+			~Arena(void);
+
+			// Uninitialized room for count objects of type T, aligned for T
+			template <typename T> T *Allocate(size_t count) { return static_cast<T *>(Allocate(count*sizeof(T), alignof(T))); }
+			void *Allocate(size_t size, size_t alignment);
+
+			// Free every allocation; the first block is kept for the next construction
+			void Reset(void);
+			// Free every allocation and block
+			void Release(void);
+
+			size_t GetUsed(void) const { return used_; } // Bytes handed out since the last reset
+			size_t GetCapacity(void) const { return capacity_; } // Bytes of the blocks held
+			size_t GetPeak(void) const { return peak_; } // Largest capacity held so far
+
+		private:
+			struct Block
+			{
+				char *data;
+				size_t size;
+			};
+
+			size_t block_size_;
+			std::vector<Block> blocks_;
+			size_t offset_; // In the last block
+			size_t used_;
+			size_t capacity_;
+			size_t peak_;
+
+			Arena(const Arena &);
+			Arena &operator=(const Arena &);
+	};
+
+} // namespace ogre_application;
+
+#endif // ARENA_H_
@@ -0,0 +1,176 @@
+#include <algorithm>
+
+#include "OGRE/OgreException.h"
+#include "OGRE/OgreStringConverter.h"
+#include "OGRE/OgreCompositorManager.h"
+#include "OGRE/OgreCompositor.h"
+#include "OGRE/OgreCompositionTechnique.h"
+#include "OGRE/OgreCompositionTargetPass.h"
+#include "OGRE/OgreCompositionPass.h"
+#include "OGRE/OgreTechnique.h"
+#include "OGRE/OgrePass.h"
+
+#include "bloom.h"
+
+namespace ogre_application {
+
+/* Materials of Bloom.material */
+const Ogre::String bloom_bright_pass_material_g = "BloomBrightPassMaterial";
+const Ogre::String bloom_downsample_material_g = "BloomDownsampleMaterial";
+const Ogre::String bloom_upsample_material_g = "BloomUpsampleMaterial";
+/* Identify the bloom passes to the listeners; the compositor's own passes use 0, and the
+   listeners of its output pass set uniforms the bloom programs do not have */
+const Ogre::uint32 bloom_bright_pass_id_g = 1;
+const Ogre::uint32 bloom_downsample_pass_id_g = 2;
+const Ogre::uint32 bloom_upsample_pass_id_g = 3;
+/* Levels are half-float RGB, as is the scene they are made from */
+const Ogre::PixelFormat bloom_format_g = Ogre::PF_FLOAT16_RGB;
+const size_t bloom_bytes_per_pixel_g = 6;
+/* Smallest levels are not worth a pass */
+const int max_bloom_levels_g = 8;
+/* Taps of the filters, see BloomDownsampleFp.glsl and BloomUpsampleFp.glsl */
+const size_t bloom_downsample_taps_g = 4;
+const size_t bloom_upsample_taps_g = 9;
+const size_t blur_taps_g = 25;
+
+
+Bloom::Bloom(void){
+
+	num_levels_ = 0;
+	threshold_ = 1.0;
+	intensity_ = 0.5;
+}
+
+
+void Bloom::Init(Ogre::String compositor_name, Ogre::String scene_texture, int num_levels){
+
+	num_levels_ = std::min(num_levels, max_bloom_levels_g);
+	if (num_levels_ <= 0){
+		num_levels_ = 0;
+		return;
+	}
+
+	Ogre::CompositorPtr compositor = Ogre::CompositorManager::getSingleton().getByName(compositor_name);
+	if (compositor.isNull() || compositor->getNumTechniques() == 0){
+		OGRE_EXCEPT(Ogre::Exception::ERR_ITEM_NOT_FOUND, "Cannot find compositor " + compositor_name, "Bloom::Init");
+	}
+	Ogre::CompositionTechnique *technique = compositor->getTechnique(0);
+
+	/* Level i is 1/2^(i+1) of the target size */
+	float factor = 1.0;
+	for (int i = 0; i < num_levels_; i++){
+		factor *= 0.5;
+		Ogre::CompositionTechnique::TextureDefinition *texture = technique->createTextureDefinition(GetLevelName(i));
+		texture->width = 0;
+		texture->height = 0;
+		texture->widthFactor = factor;
+		texture->heightFactor = factor;
+		texture->formatList.push_back(bloom_format_g);
+	}
+
+	/* Down the chain; the first step only keeps what is above the threshold */
+	for (int i = 0; i < num_levels_; i++){
+		Ogre::CompositionTargetPass *target = technique->createTargetPass();
+		target->setOutputName(GetLevelName(i));
+		target->setInputMode(Ogre::CompositionTargetPass::IM_NONE);
+		Ogre::CompositionPass *pass = target->createPass();
+		pass->setType(Ogre::CompositionPass::PT_RENDERQUAD);
+		if (i == 0){
+			pass->setMaterialName(bloom_bright_pass_material_g);
+			pass->setIdentifier(bloom_bright_pass_id_g);
+			pass->setInput(0, scene_texture);
+		}
+		else {
+			pass->setMaterialName(bloom_downsample_material_g);
+			pass->setIdentifier(bloom_downsample_pass_id_g);
+			pass->setInput(0, GetLevelName(i - 1));
+		}
+	}
+
+	/* Up the chain: each level is blended onto the one above, which keeps its content */
+	for (int i = num_levels_ - 1; i > 0; i--){
+		Ogre::CompositionTargetPass *target = technique->createTargetPass();
+		target->setOutputName(GetLevelName(i - 1));
+		target->setInputMode(Ogre::CompositionTargetPass::IM_NONE);
+		Ogre::CompositionPass *pass = target->createPass();
+		pass->setType(Ogre::CompositionPass::PT_RENDERQUAD);
+		pass->setMaterialName(bloom_upsample_material_g);
+		pass->setIdentifier(bloom_upsample_pass_id_g);
+		pass->setInput(0, GetLevelName(i));
+	}
+
+	/* The output pass adds the first level to the image */
+	Ogre::CompositionTargetPass *output = technique->getOutputTargetPass();
+	for (size_t i = 0; i < output->getNumPasses(); i++){
+		if (output->getPass(i)->getType() == Ogre::CompositionPass::PT_RENDERQUAD){
+			output->getPass(i)->setInput(1, GetLevelName(0));
+		}
+	}
+}
+
+
+Ogre::String Bloom::GetLevelName(int level){
+
+	return "bloom" + Ogre::StringConverter::toString(level);
+}
+
+
+BloomCost Bloom::GetCost(size_t width, size_t height) const{
+
+	BloomCost cost;
+	cost.pixels_written = 0;
+	cost.texture_fetches = 0;
+	cost.bytes = 0;
+	cost.blur_texture_fetches = blur_taps_g*width*height;
+	if (num_levels_ == 0){
+		return cost;
+	}
+
+	size_t level_width[max_bloom_levels_g];
+	size_t level_height[max_bloom_levels_g];
+	for (int i = 0; i < num_levels_; i++){
+		level_width[i] = std::max<size_t>(width >> (i + 1), 1);
+		level_height[i] = std::max<size_t>(height >> (i + 1), 1);
+	}
+
+	/* Downsampling reads the level above once and writes its own */
+	size_t source_pixels = width*height;
+	for (int i = 0; i < num_levels_; i++){
+		size_t pixels = level_width[i]*level_height[i];
+		cost.pixels_written += pixels;
+		cost.texture_fetches += bloom_downsample_taps_g*pixels;
+		cost.bytes += (source_pixels + pixels)*bloom_bytes_per_pixel_g;
+		source_pixels = pixels;
+	}
+
+	/* Upsampling reads the level below and blends onto the level above */
+	for (int i = num_levels_ - 1; i > 0; i--){
+		size_t pixels = level_width[i - 1]*level_height[i - 1];
+		cost.pixels_written += pixels;
+		cost.texture_fetches += bloom_upsample_taps_g*pixels;
+		cost.bytes += (level_width[i]*level_height[i] + 2*pixels)*bloom_bytes_per_pixel_g;
+	}
+
+	/* One more fetch per pixel in the output pass */
+	cost.texture_fetches += width*height;
+	cost.bytes += level_width[0]*level_height[0]*bloom_bytes_per_pixel_g;
+	return cost;
+}
+
+
+void Bloom::notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat){
+
+	if (num_levels_ == 0){
+		return;
+	}
+	Ogre::GpuProgramParametersSharedPtr params = mat->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
+	if (pass_id == bloom_bright_pass_id_g){
+		params->setNamedConstant("threshold", threshold_);
+	}
+	else if (pass_id == 0){
+		params->setNamedConstant("bloom_intensity", intensity_);
+	}
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,55 @@
+#ifndef BLOOM_H_
+#define BLOOM_H_
+
+#include "OGRE/OgreString.h"
+#include "OGRE/OgreCompositorInstance.h"
+
+namespace ogre_application {
+
+	/* Estimated per-frame work of a bloom chain at one resolution */
+	struct BloomCost
+	{
+		size_t pixels_written; // Over all levels, downsample and upsample
+		size_t texture_fetches;
+		size_t bytes; // Texture reads and target writes
+		size_t blur_texture_fetches; // Of the 25-tap full-resolution blur, for comparison
+	};
+
+	/* Glow around bright pixels, built from a chain of half-resolution targets */
+	/* A bright pass downsamples the scene into the first level and every further level
+	   halves the previous one with a 4x4 box; the levels are then added back up the chain
+	   with a 3x3 tent filter. Each level blurs twice as far as the one above at a quarter of
+	   the cost, so a wide glow stays close to the cost of the first level, about half the
+	   pixels of the screen. The passes are added to an existing compositor, whose output
+	   pass reads the result as its second input */
+	class Bloom : public Ogre::CompositorInstance::Listener
+	{
+		public:
+			Bloom(void);
+
+			// Add num_levels halvings of scene_texture to the compositor; call before it is instantiated
+			void Init(Ogre::String compositor_name, Ogre::String scene_texture, int num_levels);
+			int GetNumLevels(void) const { return num_levels_; }
+
+			// Scene brightness where glow starts and strength of the glow; can change at any time
+			void SetThreshold(float threshold) { threshold_ = threshold; }
+			void SetIntensity(float intensity) { intensity_ = intensity; }
+			float GetThreshold(void) const { return threshold_; }
+			float GetIntensity(void) const { return intensity_; }
+
+			BloomCost GetCost(size_t width, size_t height) const;
+			// Texture of a level in the compositor; level 0 is the one the output pass reads
+			static Ogre::String GetLevelName(int level);
+
+			// Add to the compositor instance to update the parameters
+			virtual void notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat);
+
+		private:
+			int num_levels_;
+			float threshold_;
+			float intensity_;
+	};
+
+} // namespace ogre_application;
+
+#endif // BLOOM_H_
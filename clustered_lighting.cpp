@@ -0,0 +1,287 @@
+#include <cmath>
+#include <algorithm>
+
+#include "OGRE/OgreTextureManager.h"
+#include "OGRE/OgreMaterialManager.h"
+#include "OGRE/OgreHardwarePixelBuffer.h"
+#include "OGRE/OgreTechnique.h"
+#include "OGRE/OgrePass.h"
+
+#include "clustered_lighting.h"
+
+namespace ogre_application {
+
+/* Cluster grid configuration; must match the texture sizes expected by ClusteredLighting.glsl */
+const int cluster_tiles_x_g = 16;
+const int cluster_tiles_y_g = 9;
+const int cluster_slices_g = 24;
+const int num_clusters_g = cluster_tiles_x_g*cluster_tiles_y_g*cluster_slices_g;
+const int max_lights_g = 1024;
+const int light_index_row_g = 1024; // Width of the light index texture
+const int max_light_indices_g = light_index_row_g*64;
+const float max_cluster_far_g = 1000.0f; // Used when the camera has an infinite far plane
+
+/* Names of the textures referenced by the materials */
+const Ogre::String light_texture_name_g = "ClusterLightData";
+const Ogre::String grid_texture_name_g = "ClusterGrid";
+const Ogre::String index_texture_name_g = "ClusterLightIndices";
+
+
+/* Squared distance test between a light sphere and a cluster box */
+static bool SphereIntersectsBox(const Ogre::Vector3 &center, float radius, const Ogre::AxisAlignedBox &box){
+
+	const Ogre::Vector3 &box_min = box.getMinimum();
+	const Ogre::Vector3 &box_max = box.getMaximum();
+	float distance = 0.0f;
+	for (int k = 0; k < 3; k++){
+		if (center[k] < box_min[k]){
+			distance += (box_min[k] - center[k])*(box_min[k] - center[k]);
+		}
+		else if (center[k] > box_max[k]){
+			distance += (center[k] - box_max[k])*(center[k] - box_max[k]);
+		}
+	}
+	return distance <= radius*radius;
+}
+
+
+ClusteredLighting::ClusteredLighting(void){
+
+	num_lights_ = 0;
+	num_light_indices_ = 0;
+	num_overflows_ = 0;
+	cluster_near_ = 0.0f;
+	cluster_far_ = 0.0f;
+	cluster_projection_ = Ogre::Matrix4::ZERO;
+}
+
+
+void ClusteredLighting::Init(Ogre::String resource_group_name, int num_threads){
+
+	workers_.Init(num_threads);
+
+	cluster_bounds_.resize(num_clusters_g);
+	cluster_lights_.resize(num_clusters_g);
+	slice_depths_.resize(cluster_slices_g + 1);
+	light_data_.assign(max_lights_g*2*4, 0.0f);
+	grid_data_.assign(num_clusters_g*4, 0.0f);
+	index_data_.assign(max_light_indices_g, 0.0f);
+
+	/* Point sampled float textures, rewritten every frame */
+	Ogre::TextureManager &texture_manager = Ogre::TextureManager::getSingleton();
+	light_texture_ = texture_manager.createManual(light_texture_name_g, resource_group_name, Ogre::TEX_TYPE_2D,
+		max_lights_g, 2, 0, Ogre::PF_FLOAT32_RGBA, Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+	grid_texture_ = texture_manager.createManual(grid_texture_name_g, resource_group_name, Ogre::TEX_TYPE_2D,
+		cluster_tiles_x_g*cluster_tiles_y_g, cluster_slices_g, 0, Ogre::PF_FLOAT32_RGBA, Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+	index_texture_ = texture_manager.createManual(index_texture_name_g, resource_group_name, Ogre::TEX_TYPE_2D,
+		light_index_row_g, max_light_indices_g/light_index_row_g, 0, Ogre::PF_FLOAT32_R, Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+}
+
+
+void ClusteredLighting::AddMaterial(Ogre::String material_name){
+
+	materials_.push_back(material_name);
+}
+
+
+int ClusteredLighting::AddLight(Ogre::Vector3 position, float radius, Ogre::ColourValue colour, float intensity){
+
+	PointLight light;
+	light.position = position;
+	light.radius = radius;
+	light.colour = colour;
+	light.intensity = intensity;
+	light.enabled = true;
+
+	/* Reuse the slots of removed lights so ids stay small */
+	int light_id;
+	if (!free_light_ids_.empty()){
+		light_id = free_light_ids_.back();
+		free_light_ids_.pop_back();
+		lights_[light_id] = light;
+	}
+	else {
+		light_id = (int) lights_.size();
+		lights_.push_back(light);
+	}
+
+	num_lights_++;
+	return light_id;
+}
+
+
+void ClusteredLighting::RemoveLight(int light_id){
+
+	if (light_id < 0 || light_id >= (int) lights_.size() || !lights_[light_id].enabled){
+		return;
+	}
+	lights_[light_id].enabled = false;
+	free_light_ids_.push_back(light_id);
+	num_lights_--;
+}
+
+
+void ClusteredLighting::UpdateClusterBounds(Ogre::Camera *camera){
+
+	const Ogre::Matrix4 &projection = camera->getProjectionMatrix();
+	float cluster_near = camera->getNearClipDistance();
+	float cluster_far = camera->getFarClipDistance();
+	if (cluster_far == 0.0f){
+		cluster_far = max_cluster_far_g;
+	}
+
+	/* The bounds only change with the projection */
+	if (projection == cluster_projection_ && cluster_near == cluster_near_ && cluster_far == cluster_far_){
+		return;
+	}
+	cluster_projection_ = projection;
+	cluster_near_ = cluster_near;
+	cluster_far_ = cluster_far;
+
+	/* Exponential slices keep clusters roughly cubic */
+	for (int s = 0; s <= cluster_slices_g; s++){
+		slice_depths_[s] = cluster_near*std::pow(cluster_far/cluster_near, (float) s/cluster_slices_g);
+	}
+
+	for (int s = 0; s < cluster_slices_g; s++){
+		for (int y = 0; y < cluster_tiles_y_g; y++){
+			for (int x = 0; x < cluster_tiles_x_g; x++){
+
+				/* Corners of the tile in normalized device coordinates, unprojected at both slice depths */
+				float ndc_x[2] = { -1.0f + 2.0f*x/cluster_tiles_x_g, -1.0f + 2.0f*(x + 1)/cluster_tiles_x_g };
+				float ndc_y[2] = { -1.0f + 2.0f*y/cluster_tiles_y_g, -1.0f + 2.0f*(y + 1)/cluster_tiles_y_g };
+				Ogre::AxisAlignedBox &box = cluster_bounds_[(s*cluster_tiles_y_g + y)*cluster_tiles_x_g + x];
+				box.setNull();
+				for (int d = 0; d < 2; d++){
+					float depth = slice_depths_[s + d];
+					for (int i = 0; i < 2; i++){
+						for (int j = 0; j < 2; j++){
+							box.merge(Ogre::Vector3((ndc_x[i] + projection[0][2])*depth/projection[0][0],
+							                        (ndc_y[j] + projection[1][2])*depth/projection[1][1],
+							                        -depth));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void ClusteredLighting::BinSlice(int slice){
+
+	/* Each slice is binned by one thread, so the cluster lists need no locking */
+	float slice_near = slice_depths_[slice];
+	float slice_far = slice_depths_[slice + 1];
+	int first_cluster = slice*cluster_tiles_x_g*cluster_tiles_y_g;
+
+	for (int c = 0; c < cluster_tiles_x_g*cluster_tiles_y_g; c++){
+		cluster_lights_[first_cluster + c].clear();
+	}
+
+	for (size_t l = 0; l < view_lights_.size(); l++){
+		const ViewLight &light = view_lights_[l];
+		float depth = -light.position.z;
+		if (depth + light.radius < slice_near || depth - light.radius > slice_far){
+			continue;
+		}
+		for (int c = 0; c < cluster_tiles_x_g*cluster_tiles_y_g; c++){
+			if (SphereIntersectsBox(light.position, light.radius, cluster_bounds_[first_cluster + c])){
+				cluster_lights_[first_cluster + c].push_back((unsigned short) l);
+			}
+		}
+	}
+}
+
+
+void ClusteredLighting::Update(Ogre::Camera *camera){
+
+	UpdateClusterBounds(camera);
+
+	/* Move the enabled lights into view space and pack them for the GPU */
+	view_lights_.clear();
+	const Ogre::Matrix4 &view = camera->getViewMatrix();
+	for (size_t i = 0; i < lights_.size() && (int) view_lights_.size() < max_lights_g; i++){
+		const PointLight &light = lights_[i];
+		if (!light.enabled){
+			continue;
+		}
+
+		ViewLight view_light;
+		view_light.position = view*light.position;
+		view_light.radius = light.radius;
+
+		float *position_texel = &light_data_[view_lights_.size()*4];
+		float *colour_texel = &light_data_[(max_lights_g + view_lights_.size())*4];
+		position_texel[0] = view_light.position.x;
+		position_texel[1] = view_light.position.y;
+		position_texel[2] = view_light.position.z;
+		position_texel[3] = view_light.radius;
+		colour_texel[0] = light.colour.r;
+		colour_texel[1] = light.colour.g;
+		colour_texel[2] = light.colour.b;
+		colour_texel[3] = light.intensity;
+
+		view_lights_.push_back(view_light);
+	}
+
+	/* Bin the lights into the clusters in parallel, one depth slice per task */
+	workers_.ParallelFor(cluster_slices_g, [this](int slice){ BinSlice(slice); });
+
+	/* Flatten the cluster lists into one index list */
+	num_light_indices_ = 0;
+	num_overflows_ = 0;
+	for (int c = 0; c < num_clusters_g; c++){
+		const std::vector<unsigned short> &list = cluster_lights_[c];
+		int count = (int) list.size();
+		if (num_light_indices_ + count > max_light_indices_g){
+			count = max_light_indices_g - num_light_indices_;
+			num_overflows_++;
+		}
+		grid_data_[c*4] = (float) num_light_indices_;
+		grid_data_[c*4 + 1] = (float) count;
+		for (int i = 0; i < count; i++){
+			index_data_[num_light_indices_ + i] = (float) list[i];
+		}
+		num_light_indices_ += count;
+	}
+
+	Upload();
+	SetMaterialParameters(camera);
+}
+
+
+void ClusteredLighting::Upload(void){
+
+	light_texture_->getBuffer()->blitFromMemory(Ogre::PixelBox(max_lights_g, 2, 1, Ogre::PF_FLOAT32_RGBA, &light_data_[0]));
+	grid_texture_->getBuffer()->blitFromMemory(Ogre::PixelBox(cluster_tiles_x_g*cluster_tiles_y_g, cluster_slices_g, 1, Ogre::PF_FLOAT32_RGBA, &grid_data_[0]));
+
+	/* Only the rows of the index list that are in use */
+	if (num_light_indices_ > 0){
+		int rows = (num_light_indices_ + light_index_row_g - 1)/light_index_row_g;
+		index_texture_->getBuffer()->blitFromMemory(Ogre::PixelBox(light_index_row_g, rows, 1, Ogre::PF_FLOAT32_R, &index_data_[0]),
+			Ogre::Box(0, 0, light_index_row_g, rows));
+	}
+}
+
+
+void ClusteredLighting::SetMaterialParameters(Ogre::Camera *camera){
+
+	Ogre::Vector3 grid_size((float) cluster_tiles_x_g, (float) cluster_tiles_y_g, (float) cluster_slices_g);
+	Ogre::Vector3 depth(cluster_near_, cluster_far_, 1.0f/std::log(cluster_far_/cluster_near_));
+	Ogre::Vector4 projection(cluster_projection_[0][0], cluster_projection_[1][1], cluster_projection_[0][2], cluster_projection_[1][2]);
+
+	for (size_t i = 0; i < materials_.size(); i++){
+		Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().getByName(materials_[i]);
+		if (material.isNull()){
+			continue;
+		}
+		Ogre::GpuProgramParametersSharedPtr params = material->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
+		params->setNamedConstant("cluster_grid_size", grid_size);
+		params->setNamedConstant("cluster_depth", depth);
+		params->setNamedConstant("cluster_projection", projection);
+	}
+}
+
+
+} // namespace ogre_application;
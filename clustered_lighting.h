@@ -0,0 +1,94 @@
+#ifndef CLUSTERED_LIGHTING_H_
+#define CLUSTERED_LIGHTING_H_
+
+#include <vector>
+
+#include "OGRE/OgreCamera.h"
+#include "OGRE/OgreTexture.h"
+#include "OGRE/OgreMaterial.h"
+#include "OGRE/OgreColourValue.h"
+
+#include "worker_pool.h"
+
+namespace ogre_application {
+
+	/* A point light of the clustered lighting path */
+	struct PointLight
+	{
+		Ogre::Vector3 position; // World space
+		float radius; // The light has no effect beyond this distance
+		Ogre::ColourValue colour;
+		float intensity;
+		bool enabled;
+	};
+
+	/* Clustered forward lighting */
+	/* Every frame the lights are binned on the CPU into a grid of view-frustum clusters
+	   (screen tiles times exponential depth slices). The light data, the per-cluster light
+	   lists and the cluster grid are uploaded as float textures, and the Shiny* fragment
+	   shaders only loop over the lights of the cluster that contains the fragment */
+	class ClusteredLighting
+	{
+		public:
+			ClusteredLighting(void);
+
+			// Create the light textures; call before the materials are loaded
+			void Init(Ogre::String resource_group_name, int num_threads);
+			// Materials whose shaders read the cluster data
+			void AddMaterial(Ogre::String material_name);
+
+			int AddLight(Ogre::Vector3 position, float radius, Ogre::ColourValue colour, float intensity);
+			void RemoveLight(int light_id);
+			PointLight &GetLight(int light_id) { return lights_[light_id]; }
+			int GetNumLights(void) const { return num_lights_; }
+
+			// Bin the lights for the camera and upload the result
+			void Update(Ogre::Camera *camera);
+
+			// Statistics of the last update
+			int GetNumLightIndices(void) const { return num_light_indices_; }
+			int GetNumOverflows(void) const { return num_overflows_; }
+
+		private:
+			/* A light transformed into view space for the current frame */
+			struct ViewLight
+			{
+				Ogre::Vector3 position;
+				float radius;
+			};
+
+			std::vector<PointLight> lights_;
+			std::vector<int> free_light_ids_;
+			int num_lights_;
+
+			std::vector<Ogre::String> materials_;
+
+			// Per-frame binning state
+			std::vector<ViewLight> view_lights_;
+			std::vector<Ogre::AxisAlignedBox> cluster_bounds_; // View-space bounds of every cluster
+			std::vector<std::vector<unsigned short> > cluster_lights_; // Light list of every cluster
+			Ogre::Matrix4 cluster_projection_; // Projection the bounds were computed for
+			float cluster_near_;
+			float cluster_far_;
+			std::vector<float> slice_depths_; // Distance from the camera to the start of every slice
+			WorkerPool workers_;
+			int num_light_indices_;
+			int num_overflows_;
+
+			// Upload buffers and textures
+			std::vector<float> light_data_;
+			std::vector<float> grid_data_;
+			std::vector<float> index_data_;
+			Ogre::TexturePtr light_texture_;
+			Ogre::TexturePtr grid_texture_;
+			Ogre::TexturePtr index_texture_;
+
+			void UpdateClusterBounds(Ogre::Camera *camera);
+			void BinSlice(int slice);
+			void Upload(void);
+			void SetMaterialParameters(Ogre::Camera *camera);
+	};
+
+} // namespace ogre_application;
+
+#endif // CLUSTERED_LIGHTING_H_
@@ -0,0 +1,234 @@
+#include <sstream>
+
+#include "OGRE/OgreException.h"
+#include "OGRE/OgreStringConverter.h"
+#include "OGRE/OgreHighLevelGpuProgramManager.h"
+#include "OGRE/OgreMaterialManager.h"
+#include "OGRE/OgreTechnique.h"
+#include "OGRE/OgrePass.h"
+#include "OGRE/OgreCompositorManager.h"
+#include "OGRE/OgreCompositor.h"
+#include "OGRE/OgreCompositionTechnique.h"
+#include "OGRE/OgreCompositionTargetPass.h"
+#include "OGRE/OgreCompositionPass.h"
+
+#include "effect_graph.h"
+
+namespace ogre_application {
+
+/* Programs the generated passes are built from */
+const Ogre::String effect_vertex_program_g = "deferred_quad_shader/vs";
+const Ogre::String effect_stages_program_g = "post_effect_stages/fs";
+/* Full-screen traffic of one pass: an RGBA8 read and an RGBA8 write per pixel */
+const size_t effect_bytes_per_pixel_g = 4 + 4;
+
+
+EffectGraph::EffectGraph(void){
+
+}
+
+
+void EffectGraph::Init(Ogre::String resource_group_name){
+
+	resource_group_name_ = resource_group_name;
+
+	/* The effects of ScreenSpaceFp.glsl */
+	AddStage("waver", EFFECT_STAGE_UV_REMAP, "Waver");
+	AddStage("blur", EFFECT_STAGE_NEIGHBORHOOD, "Blur");
+	AddStage("tile", EFFECT_STAGE_UV_REMAP, "Tile");
+	AddStage("wipe", EFFECT_STAGE_POINT_WISE, "Wipe");
+	AddStage("heartbeat", EFFECT_STAGE_POINT_WISE, "HeartBeat");
+	AddStage("shockwave", EFFECT_STAGE_UV_REMAP, "Shockwave");
+	AddStage("shockwaves", EFFECT_STAGE_UV_REMAP, "Shockwaves");
+}
+
+
+void EffectGraph::AddStage(Ogre::String name, EffectStageType type, Ogre::String function){
+
+	EffectStage stage;
+	stage.name = name;
+	stage.type = type;
+	stage.function = function;
+	stages_[name] = stage;
+}
+
+
+const EffectStage &EffectGraph::GetStage(const Ogre::String &name) const {
+
+	std::map<Ogre::String, EffectStage>::const_iterator it = stages_.find(name);
+	if (it == stages_.end()){
+		OGRE_EXCEPT(Ogre::Exception::ERR_ITEM_NOT_FOUND, "Unknown effect stage " + name, "EffectGraph::GetStage");
+	}
+	return it->second;
+}
+
+
+std::vector<std::vector<const EffectStage *> > EffectGraph::SplitPasses(const std::vector<Ogre::String> &chain) const {
+
+	/* A neighborhood stage needs its input in a texture, so it starts a new pass */
+	std::vector<std::vector<const EffectStage *> > passes;
+	for (size_t i = 0; i < chain.size(); i++){
+		const EffectStage &stage = GetStage(chain[i]);
+		if (passes.empty() || stage.type == EFFECT_STAGE_NEIGHBORHOOD){
+			passes.push_back(std::vector<const EffectStage *>());
+		}
+		passes.back().push_back(&stage);
+	}
+	return passes;
+}
+
+
+int EffectGraph::GetNumFusedPasses(const std::vector<Ogre::String> &chain) const {
+
+	return (int) SplitPasses(chain).size();
+}
+
+
+double EffectGraph::GetBandwidthSaved(const std::vector<Ogre::String> &chain, size_t width, size_t height) const {
+
+	/* Every pass removed saves one full-screen read and write */
+	int passes_saved = (int) chain.size() - GetNumFusedPasses(chain);
+	return (double) passes_saved*width*height*effect_bytes_per_pixel_g;
+}
+
+
+Ogre::String EffectGraph::GenerateSource(const std::vector<const EffectStage *> &stages) const {
+
+	std::ostringstream source;
+	int num_stages = (int) stages.size();
+
+	source << "#version 400" << std::endl << std::endl;
+	source << "// Generated by EffectGraph:";
+	for (int i = 0; i < num_stages; i++){
+		source << " " << stages[i]->name;
+	}
+	source << std::endl << std::endl;
+	source << "in vec2 uv;" << std::endl;
+	source << "uniform sampler2D input_map;" << std::endl << std::endl;
+
+	/* Prototypes of the stages, defined in PostEffectStages.glsl */
+	for (int i = 0; i < num_stages; i++){
+		const EffectStage &stage = *stages[i];
+		if (stage.type == EFFECT_STAGE_POINT_WISE){
+			source << "vec4 " << stage.function << "(vec4 colour, vec2 uv);" << std::endl;
+		}
+		else if (stage.type == EFFECT_STAGE_UV_REMAP){
+			source << "vec2 " << stage.function << "(vec2 uv);" << std::endl;
+		}
+		else {
+			source << "vec4 " << stage.function << "(sampler2D map, vec2 uv);" << std::endl;
+		}
+	}
+
+	/* uv_i is where the output of stage i is evaluated; walk the remaps back to the input */
+	source << std::endl << "void main()" << std::endl << "{" << std::endl;
+	source << "\tvec2 uv_" << num_stages << " = uv;" << std::endl;
+	for (int i = num_stages; i > 0; i--){
+		const EffectStage &stage = *stages[i - 1];
+		source << "\tvec2 uv_" << i - 1 << " = ";
+		if (stage.type == EFFECT_STAGE_UV_REMAP){
+			source << stage.function << "(uv_" << i << ");" << std::endl;
+		}
+		else {
+			source << "uv_" << i << ";" << std::endl;
+		}
+	}
+
+	/* Then apply the colour stages forwards; only the first stage may read the input texture freely */
+	if (stages[0]->type == EFFECT_STAGE_NEIGHBORHOOD){
+		source << "\tvec4 colour = " << stages[0]->function << "(input_map, uv_0);" << std::endl;
+	}
+	else {
+		source << "\tvec4 colour = texture(input_map, uv_0);" << std::endl;
+	}
+	for (int i = 0; i < num_stages; i++){
+		if (stages[i]->type == EFFECT_STAGE_POINT_WISE){
+			source << "\tcolour = " << stages[i]->function << "(colour, uv_" << i + 1 << ");" << std::endl;
+		}
+	}
+	source << "\tgl_FragColor = colour;" << std::endl << "}" << std::endl;
+
+	return source.str();
+}
+
+
+Ogre::String EffectGraph::CreateMaterial(Ogre::String name, const std::vector<const EffectStage *> &stages){
+
+	Ogre::HighLevelGpuProgramPtr program = Ogre::HighLevelGpuProgramManager::getSingleton().createProgram(
+		name + "/fs", resource_group_name_, "glsl", Ogre::GPT_FRAGMENT_PROGRAM);
+	program->setSource(GenerateSource(stages));
+	program->setParameter("attach", effect_stages_program_g);
+	program->load();
+	program->getDefaultParameters()->setIgnoreMissingParams(true);
+	program->getDefaultParameters()->setNamedConstant("input_map", 0);
+
+	Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().create(name, resource_group_name_);
+	Ogre::Pass *pass = material->getTechnique(0)->getPass(0);
+	pass->setDepthCheckEnabled(false);
+	pass->setDepthWriteEnabled(false);
+	pass->setVertexProgram(effect_vertex_program_g);
+	pass->setFragmentProgram(program->getName());
+	/* The compositor listener sets the uniforms of every effect, not all of which this pass uses */
+	pass->getFragmentProgramParameters()->setIgnoreMissingParams(true);
+	pass->createTextureUnitState()->setTextureAddressingMode(Ogre::TextureUnitState::TAM_WRAP);
+	material->load();
+
+	return material->getName();
+}
+
+
+Ogre::String EffectGraph::Compile(const std::vector<Ogre::String> &chain){
+
+	if (chain.empty()){
+		OGRE_EXCEPT(Ogre::Exception::ERR_INVALIDPARAMS, "Empty effect chain", "EffectGraph::Compile");
+	}
+
+	Ogre::String key = chain[0];
+	for (size_t i = 1; i < chain.size(); i++){
+		key += "+" + chain[i];
+	}
+	std::map<Ogre::String, Ogre::String>::iterator it = compiled_.find(key);
+	if (it != compiled_.end()){
+		return it->second;
+	}
+
+	Ogre::String name = "FusedEffect" + Ogre::StringConverter::toString(compiled_.size());
+	std::vector<std::vector<const EffectStage *> > passes = SplitPasses(chain);
+
+	/* Texture i holds the input of pass i; texture 0 is the previous compositor's output */
+	Ogre::CompositorPtr compositor = Ogre::CompositorManager::getSingleton().create(name, resource_group_name_);
+	Ogre::CompositionTechnique *technique = compositor->createTechnique();
+	for (size_t i = 0; i < passes.size(); i++){
+		Ogre::CompositionTechnique::TextureDefinition *texture = technique->createTextureDefinition(name + "/input" + Ogre::StringConverter::toString(i));
+		texture->width = 0; // Size of the target
+		texture->height = 0;
+		texture->formatList.push_back(Ogre::PF_A8R8G8B8);
+	}
+
+	Ogre::CompositionTargetPass *target = technique->createTargetPass();
+	target->setOutputName(name + "/input0");
+	target->setInputMode(Ogre::CompositionTargetPass::IM_PREVIOUS);
+
+	for (size_t i = 0; i < passes.size(); i++){
+		Ogre::String material_name = CreateMaterial(name + "/pass" + Ogre::StringConverter::toString(i), passes[i]);
+		if (i + 1 < passes.size()){
+			target = technique->createTargetPass();
+			target->setOutputName(name + "/input" + Ogre::StringConverter::toString(i + 1));
+		}
+		else {
+			target = technique->getOutputTargetPass();
+		}
+		target->setInputMode(Ogre::CompositionTargetPass::IM_NONE);
+
+		Ogre::CompositionPass *pass = target->createPass();
+		pass->setType(Ogre::CompositionPass::PT_RENDERQUAD);
+		pass->setMaterialName(material_name);
+		pass->setInput(0, name + "/input" + Ogre::StringConverter::toString(i));
+	}
+
+	compiled_[key] = name;
+	return name;
+}
+
+
+} // namespace ogre_application;
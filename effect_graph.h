@@ -0,0 +1,62 @@
+#ifndef EFFECT_GRAPH_H_
+#define EFFECT_GRAPH_H_
+
+#include <vector>
+#include <map>
+
+#include "OGRE/OgreString.h"
+
+namespace ogre_application {
+
+	/* How a stage of a post-effect chain accesses its input */
+	enum EffectStageType {
+		EFFECT_STAGE_POINT_WISE, // Changes the colour of its own texel
+		EFFECT_STAGE_UV_REMAP, // Moves where its single texel is read from
+		EFFECT_STAGE_NEIGHBORHOOD // Reads any texels, so its input must be a texture
+	};
+
+	/* A stage implemented by a function of PostEffectStages.glsl */
+	struct EffectStage
+	{
+		Ogre::String name;
+		EffectStageType type;
+		Ogre::String function;
+	};
+
+	/* Compiles chains of screen-space effects into compositors */
+	/* Every run of point-wise and UV remapping stages is fused into one generated fragment
+	   shader: the UV remaps are composed backwards from the output texel to find the one
+	   texel to read, and the point-wise stages are applied forwards to its colour. A new
+	   pass only starts at a neighborhood stage, which reads the previous pass's texture.
+	   Each distinct chain is compiled once and its compositor reused afterwards */
+	class EffectGraph
+	{
+		public:
+			EffectGraph(void);
+
+			// Registers the stages of PostEffectStages.glsl
+			void Init(Ogre::String resource_group_name);
+			void AddStage(Ogre::String name, EffectStageType type, Ogre::String function);
+
+			// Name of the compositor that applies the stages in order; compiled on first use
+			Ogre::String Compile(const std::vector<Ogre::String> &chain);
+
+			// Number of full-screen passes of a chain with and without fusion
+			int GetNumFusedPasses(const std::vector<Ogre::String> &chain) const;
+			// Full-screen bytes read and written per frame that fusion saves
+			double GetBandwidthSaved(const std::vector<Ogre::String> &chain, size_t width, size_t height) const;
+
+		private:
+			Ogre::String resource_group_name_;
+			std::map<Ogre::String, EffectStage> stages_;
+			std::map<Ogre::String, Ogre::String> compiled_; // Chain to compositor name
+
+			const EffectStage &GetStage(const Ogre::String &name) const;
+			std::vector<std::vector<const EffectStage *> > SplitPasses(const std::vector<Ogre::String> &chain) const;
+			Ogre::String GenerateSource(const std::vector<const EffectStage *> &stages) const;
+			Ogre::String CreateMaterial(Ogre::String name, const std::vector<const EffectStage *> &stages);
+	};
+
+} // namespace ogre_application;
+
+#endif // EFFECT_GRAPH_H_
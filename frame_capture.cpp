@@ -0,0 +1,462 @@
+#include <fstream>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <GL/gl.h>
+#else
+#include <GL/gl.h>
+#include <GL/glx.h>
+#endif
+
+#include "OGRE/OgreTextureManager.h"
+#include "OGRE/OgreMaterialManager.h"
+#include "OGRE/OgreTechnique.h"
+#include "OGRE/OgreTextureUnitState.h"
+#include "OGRE/OgreHardwarePixelBuffer.h"
+#include "OGRE/OgreHardwareBufferManager.h"
+#include "OGRE/OgreRenderTexture.h"
+#include "OGRE/OgreStringConverter.h"
+
+#include "frame_capture.h"
+
+namespace ogre_application {
+
+/* Frames waiting for the background thread, in multiples of the ring size */
+const int max_pending_rings_g = 2;
+/* Material whose pass copies the source, see FrameCapture.material */
+const Ogre::String capture_material_g = "FrameCaptureMaterial";
+const Ogre::String capture_copy_material_g = "FrameCaptureCopy";
+const Ogre::String capture_camera_name_g = "FrameCaptureCamera";
+
+/* Pixel buffer objects are past what the system's OpenGL headers declare; Ogre does not
+   expose them, so their entry points are looked up once a context exists */
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER_BINDING
+#define GL_PIXEL_PACK_BUFFER_BINDING 0x88ED
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+typedef void (APIENTRY *GenBuffersFunction)(GLsizei n, GLuint *buffers);
+typedef void (APIENTRY *DeleteBuffersFunction)(GLsizei n, const GLuint *buffers);
+typedef void (APIENTRY *BindBufferFunction)(GLenum target, GLuint buffer);
+typedef void (APIENTRY *BufferDataFunction)(GLenum target, ptrdiff_t size, const void *data, GLenum usage);
+typedef void *(APIENTRY *MapBufferFunction)(GLenum target, GLenum access);
+typedef GLboolean (APIENTRY *UnmapBufferFunction)(GLenum target);
+
+GenBuffersFunction gl_gen_buffers_g = NULL;
+DeleteBuffersFunction gl_delete_buffers_g = NULL;
+BindBufferFunction gl_bind_buffer_g = NULL;
+BufferDataFunction gl_buffer_data_g = NULL;
+MapBufferFunction gl_map_buffer_g = NULL;
+UnmapBufferFunction gl_unmap_buffer_g = NULL;
+
+
+static void *GetGLFunction(const char *name){
+
+#ifdef _WIN32
+	return (void *) wglGetProcAddress(name);
+#else
+	return (void *) glXGetProcAddressARB((const GLubyte *) name);
+#endif
+}
+
+
+FrameCapture::FrameCapture(void){
+
+	render_system_ = NULL;
+	scene_manager_ = NULL;
+	camera_ = NULL;
+	ring_size_ = 0;
+	capturing_ = false;
+	source_target_ = NULL;
+	subsample_ = 1;
+	paused_ = false;
+	width_ = 0;
+	height_ = 0;
+	quad_operation_.vertexData = NULL;
+	quad_operation_.indexData = NULL;
+	copy_pass_ = NULL;
+	frame_number_ = 0;
+	num_captured_ = 0;
+	num_dropped_ = 0;
+	quit_ = false;
+}
+
+
+FrameCapture::~FrameCapture(void){
+
+	Stop();
+	for (size_t i = 0; i < free_frames_.size(); i++){
+		delete free_frames_[i];
+	}
+	free_frames_.clear();
+}
+
+
+void FrameCapture::Init(Ogre::RenderSystem *render_system, Ogre::SceneManager *scene_manager, Ogre::String resource_group_name, int ring_size){
+
+	render_system_ = render_system;
+	scene_manager_ = scene_manager;
+	resource_group_name_ = resource_group_name;
+	ring_size_ = std::max(ring_size, 2);
+
+	if (!gl_gen_buffers_g){
+		gl_gen_buffers_g = (GenBuffersFunction) GetGLFunction("glGenBuffers");
+		gl_delete_buffers_g = (DeleteBuffersFunction) GetGLFunction("glDeleteBuffers");
+		gl_bind_buffer_g = (BindBufferFunction) GetGLFunction("glBindBuffer");
+		gl_buffer_data_g = (BufferDataFunction) GetGLFunction("glBufferData");
+		gl_map_buffer_g = (MapBufferFunction) GetGLFunction("glMapBuffer");
+		gl_unmap_buffer_g = (UnmapBufferFunction) GetGLFunction("glUnmapBuffer");
+	}
+	if (!gl_gen_buffers_g || !gl_delete_buffers_g || !gl_bind_buffer_g || !gl_buffer_data_g || !gl_map_buffer_g || !gl_unmap_buffer_g){
+		OGRE_EXCEPT(Ogre::Exception::ERR_RENDERINGAPI_ERROR, "Pixel buffer objects are not supported", "FrameCapture::Init");
+	}
+
+	/* Its own copy of the material, so that its texture can point at any source */
+	Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().getByName(capture_material_g);
+	if (material.isNull()){
+		OGRE_EXCEPT(Ogre::Exception::ERR_ITEM_NOT_FOUND, "Cannot find material " + capture_material_g, "FrameCapture::Init");
+	}
+	material = material->clone(capture_copy_material_g);
+	material->load();
+	copy_pass_ = material->getBestTechnique()->getPass(0);
+
+	camera_ = scene_manager_->createCamera(capture_camera_name_g);
+}
+
+
+void FrameCapture::Start(Ogre::TexturePtr source, const Ogre::Box &region, int subsample, FrameHandler handler){
+
+	Stop();
+
+	source_ = source;
+	requested_region_ = region;
+	region_ = region;
+	if (region_.getWidth() == 0 || region_.getHeight() == 0){
+		region_ = Ogre::Box(0, 0, source_->getWidth(), source_->getHeight());
+	}
+	subsample_ = std::max(subsample, 1);
+	paused_ = false;
+	width_ = std::max<size_t>(region_.getWidth()/subsample_, 1);
+	height_ = std::max<size_t>(region_.getHeight()/subsample_, 1);
+	CreateRing();
+	CreateQuad();
+	copy_pass_->getTextureUnitState(0)->setTextureName(source_->getName());
+
+	frame_number_ = 0;
+	num_captured_ = 0;
+	num_dropped_ = 0;
+	handler_ = handler;
+	quit_ = false;
+	writer_ = std::thread(&FrameCapture::WriterMain, this);
+
+	source_target_ = source_->getBuffer()->getRenderTarget();
+	source_target_->addListener(this);
+	capturing_ = true;
+}
+
+
+void FrameCapture::Stop(void){
+
+	if (!capturing_){
+		return;
+	}
+	source_target_->removeListener(this);
+	source_target_ = NULL;
+
+	/* Oldest frame first; these are the only reads that may wait for the GPU */
+	for (int i = 0; i < ring_size_; i++){
+		int slot = (int) ((frame_number_ + i) % ring_size_);
+		if (issued_[slot]){
+			ReadBack(slot);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	frame_ready_.notify_one();
+	writer_.join();
+
+	copy_pass_->getTextureUnitState(0)->setTextureName("");
+	DestroyQuad();
+	DestroyRing();
+	source_.setNull();
+	capturing_ = false;
+}
+
+
+void FrameCapture::Pause(void){
+
+	if (!capturing_){
+		return;
+	}
+	Stop();
+	paused_ = true;
+}
+
+
+void FrameCapture::Resume(Ogre::TexturePtr source){
+
+	if (!paused_){
+		return;
+	}
+	FrameHandler handler = handler_;
+	unsigned long frame_number = frame_number_;
+	unsigned long num_captured = num_captured_;
+	unsigned long num_dropped = num_dropped_;
+	Start(source, requested_region_, subsample_, handler);
+	frame_number_ = frame_number;
+	num_captured_ = num_captured;
+	num_dropped_ = num_dropped;
+}
+
+
+void FrameCapture::CreateRing(void){
+
+	DestroyRing();
+
+	Ogre::TextureManager &texture_manager = Ogre::TextureManager::getSingleton();
+	ring_.resize(ring_size_);
+	ring_viewports_.resize(ring_size_);
+	pixel_buffers_.resize(ring_size_);
+	issued_.assign(ring_size_, false);
+	ring_frames_.assign(ring_size_, 0);
+	for (int i = 0; i < ring_size_; i++){
+		ring_[i] = texture_manager.createManual("FrameCapture" + Ogre::StringConverter::toString(i), resource_group_name_, Ogre::TEX_TYPE_2D,
+			(Ogre::uint) width_, (Ogre::uint) height_, 0, Ogre::PF_BYTE_RGBA, Ogre::TU_RENDERTARGET);
+
+		/* Only drawn into by Copy(), never updated by Ogre */
+		Ogre::RenderTarget *target = ring_[i]->getBuffer()->getRenderTarget();
+		target->setAutoUpdated(false);
+		ring_viewports_[i] = target->addViewport(camera_);
+		ring_viewports_[i]->setClearEveryFrame(false);
+		ring_viewports_[i]->setOverlaysEnabled(false);
+		ring_viewports_[i]->setSkiesEnabled(false);
+		ring_viewports_[i]->setShadowsEnabled(false);
+	}
+
+	/* Room for one RGBA frame each */
+	GLint bound_buffer = 0;
+	glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &bound_buffer);
+	gl_gen_buffers_g(ring_size_, (GLuint *) &pixel_buffers_[0]);
+	for (int i = 0; i < ring_size_; i++){
+		gl_bind_buffer_g(GL_PIXEL_PACK_BUFFER, pixel_buffers_[i]);
+		gl_buffer_data_g(GL_PIXEL_PACK_BUFFER, width_*height_*4, NULL, GL_STREAM_READ);
+	}
+	gl_bind_buffer_g(GL_PIXEL_PACK_BUFFER, bound_buffer);
+}
+
+
+void FrameCapture::DestroyRing(void){
+
+	for (size_t i = 0; i < ring_.size(); i++){
+		ring_[i]->getBuffer()->getRenderTarget()->removeAllViewports();
+		Ogre::TextureManager::getSingleton().remove(ring_[i]->getHandle());
+	}
+	if (!pixel_buffers_.empty()){
+		gl_delete_buffers_g((GLsizei) pixel_buffers_.size(), (const GLuint *) &pixel_buffers_[0]);
+	}
+	ring_.clear();
+	ring_viewports_.clear();
+	pixel_buffers_.clear();
+	issued_.clear();
+	ring_frames_.clear();
+}
+
+
+void FrameCapture::CreateQuad(void){
+
+	DestroyQuad();
+
+	/* Covers the target; texture coordinates select the region, top row at v = 0 */
+	float u0 = float(region_.left)/float(source_->getWidth());
+	float u1 = float(region_.right)/float(source_->getWidth());
+	float v0 = float(region_.top)/float(source_->getHeight());
+	float v1 = float(region_.bottom)/float(source_->getHeight());
+	const float vertices[4*5] = {
+		-1.0f,  1.0f, 0.0f, u0, v0,
+		-1.0f, -1.0f, 0.0f, u0, v1,
+		 1.0f,  1.0f, 0.0f, u1, v0,
+		 1.0f, -1.0f, 0.0f, u1, v1
+	};
+
+	Ogre::VertexData *vertex_data = new Ogre::VertexData();
+	vertex_data->vertexCount = 4;
+	vertex_data->vertexDeclaration->addElement(0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION);
+	vertex_data->vertexDeclaration->addElement(0, 3*sizeof(float), Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES, 0);
+	Ogre::HardwareVertexBufferSharedPtr vertex_buffer = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(5*sizeof(float), 4, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	vertex_buffer->writeData(0, vertex_buffer->getSizeInBytes(), vertices, true);
+	vertex_data->vertexBufferBinding->setBinding(0, vertex_buffer);
+
+	quad_operation_.operationType = Ogre::RenderOperation::OT_TRIANGLE_STRIP;
+	quad_operation_.useIndexes = false;
+	quad_operation_.vertexData = vertex_data;
+	quad_operation_.indexData = NULL;
+}
+
+
+void FrameCapture::DestroyQuad(void){
+
+	delete quad_operation_.vertexData;
+	quad_operation_.vertexData = NULL;
+}
+
+
+void FrameCapture::postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	/* The download queued ring_size_ frames ago is complete, collect it before reusing its slot */
+	int slot = (int) (frame_number_ % ring_size_);
+	if (issued_[slot]){
+		ReadBack(slot);
+	}
+
+	Copy(slot);
+	issued_[slot] = true;
+	ring_frames_[slot] = frame_number_;
+	frame_number_++;
+}
+
+
+void FrameCapture::Copy(int slot){
+
+	/* GPU to GPU copy, scaled to the capture size */
+	render_system_->_setViewport(ring_viewports_[slot]);
+	render_system_->_beginFrame();
+	scene_manager_->manualRender(&quad_operation_, copy_pass_, ring_viewports_[slot], Ogre::Matrix4::IDENTITY, Ogre::Matrix4::IDENTITY, Ogre::Matrix4::IDENTITY, false);
+	render_system_->_endFrame();
+
+	/* Queue the download into the slot's pixel buffer; with a buffer bound to the pack
+	   target the call returns at once. Ogre caches the texture binding, put it back */
+	GLuint texture = 0;
+	ring_[slot]->getCustomAttribute("GLID", &texture);
+	GLint bound_texture = 0;
+	GLint bound_buffer = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound_texture);
+	glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &bound_buffer);
+	gl_bind_buffer_g(GL_PIXEL_PACK_BUFFER, pixel_buffers_[slot]);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindTexture(GL_TEXTURE_2D, bound_texture);
+	gl_bind_buffer_g(GL_PIXEL_PACK_BUFFER, bound_buffer);
+}
+
+
+void FrameCapture::ReadBack(int slot){
+
+	issued_[slot] = false;
+
+	CapturedFrame *frame = NULL;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if ((int) pending_.size() >= max_pending_rings_g*ring_size_){
+			num_dropped_++;
+			return;
+		}
+		if (!free_frames_.empty()){
+			frame = free_frames_.back();
+			free_frames_.pop_back();
+		}
+	}
+	if (!frame){
+		frame = new CapturedFrame();
+	}
+
+	frame->frame_number = ring_frames_[slot];
+	frame->width = width_;
+	frame->height = height_;
+	frame->pixels.resize(width_*height_*4);
+
+	/* Mapping only waits if the download is still running, which it is not after a lap */
+	GLint bound_buffer = 0;
+	glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &bound_buffer);
+	gl_bind_buffer_g(GL_PIXEL_PACK_BUFFER, pixel_buffers_[slot]);
+	const unsigned char *rgba = (const unsigned char *) gl_map_buffer_g(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (rgba){
+		/* A plain copy; the writer thread drops the alpha channel */
+		memcpy(&frame->pixels[0], rgba, frame->pixels.size());
+		gl_unmap_buffer_g(GL_PIXEL_PACK_BUFFER);
+	}
+	gl_bind_buffer_g(GL_PIXEL_PACK_BUFFER, bound_buffer);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (rgba){
+			pending_.push_back(frame);
+			num_captured_++;
+		}
+		else {
+			free_frames_.push_back(frame);
+			num_dropped_++;
+		}
+	}
+	frame_ready_.notify_one();
+}
+
+
+void FrameCapture::WriterMain(void){
+
+	for (;;){
+		CapturedFrame *frame;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (!quit_ && pending_.empty()){
+				frame_ready_.wait(lock);
+			}
+			/* Finish the queued frames before quitting */
+			if (pending_.empty()){
+				return;
+			}
+			frame = pending_.front();
+			pending_.pop_front();
+		}
+
+		/* RGBA to RGB in place; every write lands at or before the bytes still to be read */
+		unsigned char *pixels = &frame->pixels[0];
+		for (size_t i = 0; i < frame->width*frame->height; i++){
+			pixels[3*i] = pixels[4*i];
+			pixels[3*i + 1] = pixels[4*i + 1];
+			pixels[3*i + 2] = pixels[4*i + 2];
+		}
+		frame->pixels.resize(frame->width*frame->height*3);
+
+		if (handler_){
+			handler_(*frame);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		free_frames_.push_back(frame);
+	}
+}
+
+
+FrameCapture::FrameHandler FrameCapture::CreateFileWriter(Ogre::String directory, Ogre::String prefix){
+
+	return [directory, prefix](const CapturedFrame &frame){
+		/* Binary PPM, which needs no codec and is safe to write off the render thread */
+		std::string file_name = directory + "/" + prefix + Ogre::StringConverter::toString(frame.frame_number, 6, '0') + ".ppm";
+		std::ofstream file(file_name.c_str(), std::ios::binary);
+		if (!file){
+			return;
+		}
+		file << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+		file.write((const char *) &frame.pixels[0], frame.pixels.size());
+	};
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,126 @@
+#ifndef FRAME_CAPTURE_H_
+#define FRAME_CAPTURE_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "OGRE/OgreTexture.h"
+#include "OGRE/OgreRenderTarget.h"
+#include "OGRE/OgreRenderTargetListener.h"
+#include "OGRE/OgreRenderSystem.h"
+#include "OGRE/OgreRenderOperation.h"
+#include "OGRE/OgreSceneManager.h"
+#include "OGRE/OgreViewport.h"
+#include "OGRE/OgrePass.h"
+#include "OGRE/OgreCommon.h"
+
+namespace ogre_application {
+
+	/* A frame read back from the GPU */
+	struct CapturedFrame
+	{
+		unsigned long frame_number; // Counted from the start of the capture
+		size_t width;
+		size_t height;
+		std::vector<unsigned char> pixels; // RGB8, top row first
+	};
+
+	/* Continuous capture of a render target without stalling the pipeline */
+	/* After the source target is rendered, a quad draws the capture region into one of a
+	   ring of render textures at the capture size, and the texture is queued for download
+	   into a pixel buffer object of its own. Neither waits for the GPU. A pixel buffer is
+	   only mapped when the ring comes around to it again, by which time the copy and the
+	   download finished long ago. Frames are then handed to a background thread; if it falls
+	   behind, frames are dropped rather than slowing down rendering. Needs the OpenGL render
+	   system */
+	class FrameCapture : public Ogre::RenderTargetListener
+	{
+		public:
+			// Runs on the background thread
+			typedef std::function<void(const CapturedFrame &)> FrameHandler;
+
+			FrameCapture(void);
+			~FrameCapture(void);
+
+			// ring_size is the latency in frames between rendering and readback; call once the
+			// render system has a window
+			void Init(Ogre::RenderSystem *render_system, Ogre::SceneManager *scene_manager, Ogre::String resource_group_name, int ring_size);
+
+			// Capture the region of source (full texture if empty), one pixel every subsample pixels;
+			// with an empty handler frames are read back and discarded
+			void Start(Ogre::TexturePtr source, const Ogre::Box &region, int subsample, FrameHandler handler);
+			// Read back the frames still in flight and wait for the handler to finish them
+			void Stop(void);
+			// Stop, keeping the settings, before the source is destroyed; Resume() goes on with
+			// the same handler and frame numbers from a new source
+			void Pause(void);
+			void Resume(Ogre::TexturePtr source);
+			bool IsCapturing(void) const { return capturing_; }
+
+			// Handler that writes every frame to <directory>/<prefix><frame number>.ppm
+			static FrameHandler CreateFileWriter(Ogre::String directory, Ogre::String prefix);
+
+			virtual void postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+
+			// Statistics of the current capture
+			unsigned long GetNumCaptured(void) const { return num_captured_; }
+			unsigned long GetNumDropped(void) const { return num_dropped_; }
+
+		private:
+			Ogre::RenderSystem *render_system_;
+			Ogre::SceneManager *scene_manager_;
+			Ogre::Camera *camera_; // Only there because viewports need one
+			Ogre::String resource_group_name_;
+			int ring_size_;
+			bool capturing_;
+
+			// Source and capture region
+			Ogre::TexturePtr source_;
+			Ogre::RenderTarget *source_target_;
+			Ogre::Box requested_region_; // As passed to Start()
+			Ogre::Box region_;
+			int subsample_;
+			bool paused_;
+			size_t width_;
+			size_t height_;
+
+			// Quad that draws the region of the source over a whole ring texture
+			Ogre::RenderOperation quad_operation_;
+			Ogre::Pass *copy_pass_;
+
+			// Ring textures, each holding the copy of one frame, and the pixel buffers they
+			// are downloaded into
+			std::vector<Ogre::TexturePtr> ring_;
+			std::vector<Ogre::Viewport *> ring_viewports_;
+			std::vector<unsigned int> pixel_buffers_;
+			std::vector<bool> issued_;
+			std::vector<unsigned long> ring_frames_;
+			unsigned long frame_number_;
+			unsigned long num_captured_;
+			unsigned long num_dropped_;
+
+			// Hand-off to the background thread
+			FrameHandler handler_;
+			std::thread writer_;
+			std::mutex mutex_;
+			std::condition_variable frame_ready_;
+			std::deque<CapturedFrame *> pending_;
+			std::vector<CapturedFrame *> free_frames_; // Recycled so capture does not allocate
+			bool quit_;
+
+			void CreateRing(void);
+			void DestroyRing(void);
+			void CreateQuad(void);
+			void DestroyQuad(void);
+			void Copy(int slot);
+			void ReadBack(int slot);
+			void WriterMain(void);
+	};
+
+} // namespace ogre_application;
+
+#endif // FRAME_CAPTURE_H_
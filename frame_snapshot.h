@@ -0,0 +1,82 @@
+#ifndef FRAME_SNAPSHOT_H_
+#define FRAME_SNAPSHOT_H_
+
+#include <vector>
+#include <atomic>
+
+#include "OGRE/OgreNode.h"
+#include "OGRE/OgreVector3.h"
+#include "OGRE/OgreQuaternion.h"
+
+#include "shockwave_pool.h"
+
+namespace ogre_application {
+
+	/* Sampled animation of one node, applied to the node's initial state like Ogre does */
+	struct NodeTransform
+	{
+		Ogre::Node *node;
+		Ogre::Vector3 translate;
+		Ogre::Quaternion rotate;
+		Ogre::Vector3 scale;
+	};
+
+	/* Everything the simulation hands to rendering for one frame */
+	struct FrameSnapshot
+	{
+		unsigned int sequence; // Simulation steps so far
+		float animation_time;
+		std::vector<NodeTransform> transforms;
+		float elapsed_time; // Drives the compositor effects
+		int effect;
+		int shading_type; // Of ShinyBlueMaterial, -1 keeps the material's own
+		ShockwavePool shockwaves;
+		// Requests for rendering, as running counts so that none is lost with a skipped snapshot
+		int num_light_requests;
+		int num_render_path_toggles;
+		int num_capture_toggles;
+		int num_static_batching_toggles;
+		int num_memory_reports;
+		int num_occlusion_toggles;
+	};
+
+	/* One writer and one reader exchanging whole buffers without locks */
+	/* The writer fills its own buffer and swaps it with the middle one; the reader swaps
+	   its buffer with the middle one only if that was published since. Neither ever waits,
+	   and the reader always gets the newest complete buffer */
+	template <typename T>
+	class TripleBuffer
+	{
+		public:
+			TripleBuffer(void) : write_(0), middle_(1), read_(2) {}
+
+			// Writer side
+			T &GetWriteBuffer(void) { return buffers_[write_]; }
+			void Publish(void) { write_ = middle_.exchange(write_ | fresh_bit) & index_mask; }
+
+			// Reader side: take the newest published buffer, false if there is none since the last call
+			bool Update(void){
+				if (!(middle_.load() & fresh_bit)){
+					return false;
+				}
+				read_ = middle_.exchange(read_) & index_mask;
+				return true;
+			}
+			const T &GetReadBuffer(void) const { return buffers_[read_]; }
+
+		private:
+			static const int index_mask = 3;
+			static const int fresh_bit = 4; // Set on the middle index when it holds an unread buffer
+
+			T buffers_[3];
+			int write_;
+			std::atomic<int> middle_;
+			int read_;
+
+			TripleBuffer(const TripleBuffer &);
+			TripleBuffer &operator=(const TripleBuffer &);
+	};
+
+} // namespace ogre_application;
+
+#endif // FRAME_SNAPSHOT_H_
@@ -0,0 +1,156 @@
+#include <iomanip>
+#include <sstream>
+
+#include "OGRE/OgreException.h"
+
+#include "input_recording.h"
+
+namespace ogre_application {
+
+/* Mouse positions round-trip through the text exactly */
+const int input_mouse_precision_g = 9;
+
+
+InputRecorder::InputRecorder(void){
+
+	num_steps_ = 0;
+}
+
+
+InputRecorder::~InputRecorder(void){
+
+	Close();
+}
+
+
+void InputRecorder::Open(const Ogre::String &path){
+
+	Close();
+	file_.open(path.c_str(), std::ios::out | std::ios::trunc);
+	if (!file_){
+		OGRE_EXCEPT(Ogre::Exception::ERR_CANNOT_WRITE_TO_FILE, "Could not write " + path, "InputRecorder::Open");
+	}
+	file_ << std::setprecision(input_mouse_precision_g);
+	last_ = InputState();
+	num_steps_ = 0;
+}
+
+
+void InputRecorder::Close(void){
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_.is_open()){
+		file_ << "E " << num_steps_ << "\n";
+		file_.close();
+	}
+}
+
+
+void InputRecorder::RecordStep(unsigned int step, const InputState &input){
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!file_.is_open()){
+		return;
+	}
+	std::bitset<256> changed = input.keys ^ last_.keys;
+	if (changed.any()){
+		for (size_t key = 0; key < changed.size(); key++){
+			if (changed[key]){
+				file_ << "K " << step << " " << key << " " << input.keys[key] << "\n";
+			}
+		}
+	}
+	if (input.left_button != last_.left_button){
+		file_ << "B " << step << " " << input.left_button << " " << input.mouse.x << " " << input.mouse.y << "\n";
+	}
+	last_ = input;
+	num_steps_ = step + 1;
+}
+
+
+void InputRecorder::RecordFrame(unsigned long frame, unsigned int step, float frame_time){
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_.is_open()){
+		file_ << "F " << frame << " " << step << " " << frame_time << "\n";
+	}
+}
+
+
+InputReplay::InputReplay(void){
+
+	next_event_ = 0;
+	num_steps_ = 0;
+}
+
+
+void InputReplay::Open(const Ogre::String &path){
+
+	std::ifstream file(path.c_str());
+	if (!file){
+		OGRE_EXCEPT(Ogre::Exception::ERR_FILE_NOT_FOUND, "Could not read " + path, "InputReplay::Open");
+	}
+
+	/* Frame lines are only there for comparison and are skipped */
+	events_.clear();
+	next_event_ = 0;
+	num_steps_ = 0;
+	current_ = InputState();
+	std::string line;
+	while (std::getline(file, line)){
+		std::istringstream stream(line);
+		char type = 0;
+		stream >> type;
+		Event event;
+		event.mouse = Ogre::Vector2::ZERO;
+		if (type == 'K'){
+			stream >> event.step >> event.key >> event.down;
+			if (event.key < 0 || event.key >= 256){
+				continue;
+			}
+		}
+		else if (type == 'B'){
+			stream >> event.step >> event.down >> event.mouse.x >> event.mouse.y;
+			event.key = -1;
+		}
+		else if (type == 'E'){
+			stream >> num_steps_;
+			continue;
+		}
+		else {
+			continue;
+		}
+		if (stream.fail()){
+			OGRE_EXCEPT(Ogre::Exception::ERR_INVALIDPARAMS, "Malformed input recording line: " + line, "InputReplay::Open");
+		}
+		events_.push_back(event);
+	}
+
+	/* A recording that was cut short ends with its last event */
+	if (num_steps_ == 0 && !events_.empty()){
+		num_steps_ = events_.back().step + 1;
+	}
+}
+
+
+bool InputReplay::GetStep(unsigned int step, InputState &input){
+
+	if (step >= num_steps_){
+		return false;
+	}
+	while (next_event_ < events_.size() && events_[next_event_].step <= step){
+		const Event &event = events_[next_event_++];
+		if (event.key < 0){
+			current_.left_button = event.down;
+			current_.mouse = event.mouse;
+		}
+		else {
+			current_.keys[event.key] = event.down;
+		}
+	}
+	input = current_;
+	return true;
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,85 @@
+#ifndef INPUT_RECORDING_H_
+#define INPUT_RECORDING_H_
+
+#include <bitset>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "OGRE/OgreString.h"
+#include "OGRE/OgreVector2.h"
+
+namespace ogre_application {
+
+	/* Keyboard and mouse as seen by one simulation step */
+	struct InputState
+	{
+		std::bitset<256> keys; // Pressed keys, by OIS::KeyCode
+		bool left_button;
+		Ogre::Vector2 mouse; // Screen texture coordinates, top left is 0, 0
+
+		InputState(void) : left_button(false), mouse(Ogre::Vector2::ZERO) {}
+		bool IsKeyDown(int key) const { return keys[key]; }
+	};
+
+	/* Writes the input of every simulation step and the timing of every frame */
+	/* The file is text, one event per line, so recordings and traces can be diffed:
+	     K <step> <key> <0|1>       key released or pressed before the step
+	     B <step> <0|1> <x> <y>     left button released or pressed, with the mouse position
+	     F <frame> <step> <seconds> frame rendered with the state of the step, and its time
+	     E <steps>                  end of the recording
+	   Only changes of the input are written. A recorder that only gets frames writes the
+	   frame-time trace of a run */
+	class InputRecorder
+	{
+		public:
+			InputRecorder(void);
+			~InputRecorder(void);
+
+			void Open(const Ogre::String &path);
+			void Close(void);
+			bool IsOpen(void) const { return file_.is_open(); }
+
+			// Call for every step in order; step is the number of steps before it
+			void RecordStep(unsigned int step, const InputState &input);
+			// Call for every frame, from any thread
+			void RecordFrame(unsigned long frame, unsigned int step, float frame_time);
+
+		private:
+			std::ofstream file_;
+			std::mutex mutex_; // Steps and frames come from different threads when simulation is threaded
+			InputState last_;
+			unsigned int num_steps_;
+	};
+
+	/* Plays an input recording back step by step, in place of the devices */
+	class InputReplay
+	{
+		public:
+			InputReplay(void);
+
+			void Open(const Ogre::String &path);
+			bool IsOpen(void) const { return num_steps_ > 0; }
+			unsigned int GetNumSteps(void) const { return num_steps_; }
+
+			// Input of a step; steps have to be asked for in order. False past the end
+			bool GetStep(unsigned int step, InputState &input);
+
+		private:
+			struct Event
+			{
+				unsigned int step;
+				int key; // -1 for the left button
+				bool down;
+				Ogre::Vector2 mouse;
+			};
+
+			std::vector<Event> events_;
+			size_t next_event_;
+			unsigned int num_steps_;
+			InputState current_;
+	};
+
+} // namespace ogre_application;
+
+#endif // INPUT_RECORDING_H_
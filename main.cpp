@@ -1,30 +1,161 @@
-#include <iostream>
-#include <exception>
-#include "ogre_application.h"
-
-/* Macro for printing exceptions */
-#define PrintException(exception_object)\
-	std::cerr << exception_object.what() << std::endl
-
-/* Main function that builds and runs the application */
-int main(void){
-    ogre_application::OgreApplication application;
-
-	try {
-		application.Init();
-		application.CreateCylinder();
-		application.CreateMultipleCylinders();
-		application.CreateTorus("Torus", "ShinyTexture2Material");
-		application.CreateMultipleTorus();
-
-		application.CreateTorusGeometry("TorusMesh");
-		application.CreateEntity("TorusEnt1" ,"TorusMesh", "ShinyBlueMaterial");
-		application.SetupAnimation("TorusEnt1");
-		application.MainLoop();
-	}
-	catch (std::exception &e){
-		PrintException(e);
-	}
-
-    return 0;
-}
+#include <iostream>
+#include <exception>
+#include <string>
+#include <cstdlib>
+#include "ogre_application.h"
+
+/* Macro for printing exceptions */
+#define PrintException(exception_object)\
+	std::cerr << exception_object.what() << std::endl
+
+/* Main function that builds and runs the application */
+int main(int argc, char *argv[]){
+    ogre_application::OgreApplication application;
+
+	bool static_batching = true;
+	std::string scene_file; // Loaded in place of the built-in scene
+	std::string save_scene_file;
+	int num_generated_nodes = 0;
+	bool verify_compression = false;
+
+	try {
+		/* Options needed before initialization */
+		for (int i = 1; i < argc; i++){
+			std::string option(argv[i]);
+			if (option == "--benchmark-render-paths"){
+				int num_frames = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+				application.SetBenchmark((num_frames > 0) ? num_frames : 300);
+			}
+			else if (option == "--benchmark-capture"){
+				int num_frames = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+				application.SetCaptureBenchmark((num_frames > 0) ? num_frames : 300);
+			}
+			else if (option == "--bloom" && i + 1 < argc){
+				/* threshold,intensity,levels */
+				std::vector<Ogre::String> values = Ogre::StringUtil::split(argv[i + 1], ",");
+				if (values.size() == 3){
+					application.SetBloom(Ogre::StringConverter::parseReal(values[0]), Ogre::StringConverter::parseReal(values[1]), Ogre::StringConverter::parseInt(values[2]));
+				}
+			}
+			else if (option == "--no-state-sorting"){
+				application.SetStateSorting(false);
+			}
+			else if (option == "--no-occlusion-culling"){
+				application.SetOcclusionCulling(false);
+			}
+		}
+
+		application.Init();
+
+		/* Command line options */
+		for (int i = 1; i < argc; i++){
+			std::string option(argv[i]);
+			if (option == "--no-mesh-cache"){
+				application.SetMeshCacheMode(ogre_application::MeshCache::MODE_OFF);
+			}
+			else if (option == "--verify-mesh-cache"){
+				application.SetMeshCacheMode(ogre_application::MeshCache::MODE_VERIFY);
+			}
+			else if (option == "--vertex-layout" && i + 1 < argc){
+				ogre_application::VertexLayout layout;
+				if (ogre_application::VertexCompression::ParseLayoutName(argv[i + 1], layout)){
+					application.SetVertexLayout(layout);
+				}
+			}
+			else if (option == "--verify-compression"){
+				/* Generate every mesh, so that each one is compressed and checked */
+				application.SetMeshCacheMode(ogre_application::MeshCache::MODE_OFF);
+				verify_compression = true;
+			}
+			else if (option == "--no-static-batching"){
+				static_batching = false;
+			}
+			else if (option == "--scene" && i + 1 < argc){
+				scene_file = argv[i + 1];
+			}
+			else if (option == "--save-scene" && i + 1 < argc){
+				save_scene_file = argv[i + 1];
+			}
+			else if (option == "--generate-scene" && i + 2 < argc){
+				scene_file = argv[i + 1];
+				num_generated_nodes = atoi(argv[i + 2]);
+			}
+			else if (option == "--deferred"){
+				application.SetRenderPath(true);
+			}
+			else if (option == "--effects" && i + 1 < argc){
+				application.SetEffectChain(Ogre::StringUtil::split(argv[i + 1], ","));
+			}
+			else if (option == "--threaded"){
+				application.SetThreaded(true);
+			}
+			else if (option == "--record-input" && i + 1 < argc){
+				application.RecordInput(argv[i + 1]);
+			}
+			else if (option == "--replay-input" && i + 1 < argc){
+				application.ReplayInput(argv[i + 1]);
+			}
+			else if (option == "--frame-trace" && i + 1 < argc){
+				application.SetFrameTrace(argv[i + 1]);
+			}
+			else if (option == "--split-screen"){
+				/* Left half from the main camera, right half from the side with a blur */
+				application.SetMainViewDimensions(0.025, 0.025, 0.47, 0.95);
+				application.CreateCamera("SideCamera", Ogre::Vector3(-1.5, 0.5, 0.5), Ogre::Vector3::ZERO);
+				application.AddView("SideCamera", 0.505, 0.025, 0.47, 0.95, 2);
+			}
+			else if (option == "--picture-in-picture"){
+				/* The main camera with a tiling effect, which renders no scene of its own, and a
+				   zoom from the main camera's eye, which draws the main view's render queue */
+				application.AddView("MyCamera", 0.72, 0.05, 0.2, 0.2, 3);
+				application.CreateCamera("ZoomCamera", Ogre::Vector3(0.5, 0.5, 1.5), Ogre::Vector3::ZERO, 15.0);
+				application.AddView("ZoomCamera", 0.72, 0.3, 0.2, 0.2, 0);
+			}
+			else if (option == "--capture" && i + 1 < argc){
+				int subsample = (i + 2 < argc) ? atoi(argv[i + 2]) : 0;
+				application.StartCapture(argv[i + 1], (subsample > 0) ? subsample : 1);
+			}
+		}
+
+		application.CreateCylinder();
+		application.CreateTorus("Torus", "ShinyTexture2Material");
+		if (scene_file.empty()){
+			application.CreateMultipleCylinders();
+			application.CreateMultipleTorus();
+			/* The block across the middle of the assembly hides its far half */
+			application.AddOccluder("Cylinder7");
+			/* The cylinder assembly and its tori never move relative to each other. Regions
+			   smaller than the block keep the far discs and rods in batches of their own, which
+			   the block can hide */
+			const float assembly_region_size = 0.1;
+			if (!save_scene_file.empty()){
+				application.SaveScene(save_scene_file, "Cylinder0", true, assembly_region_size);
+			}
+			if (static_batching){
+				application.MarkStatic("Cylinder0", assembly_region_size);
+			}
+		}
+		else {
+			if (num_generated_nodes > 0){
+				application.GenerateScene(scene_file, num_generated_nodes);
+			}
+			/* The file says which entities occlude and which nodes are batched */
+			application.LoadScene(scene_file, static_batching);
+		}
+
+		application.CreateTorusGeometry("TorusMesh");
+		if (verify_compression){
+			int num_failures = application.GetNumCompressionFailures();
+			std::cout << "Vertex compression: " << num_failures << " meshes exceed the error tolerances" << std::endl;
+			return (num_failures == 0) ? 0 : 1;
+		}
+		application.CreateEntity("TorusEnt1" ,"TorusMesh", "ShinyBlueMaterial");
+		application.SetupAnimation("TorusEnt1");
+		application.MainLoop();
+	}
+	catch (std::exception &e){
+		PrintException(e);
+	}
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ogre_application {
+
+
+MappedFile::MappedFile(void){
+
+	data_ = NULL;
+	size_ = 0;
+#ifdef _WIN32
+	file_handle_ = INVALID_HANDLE_VALUE;
+	mapping_handle_ = NULL;
+#else
+	file_descriptor_ = -1;
+#endif
+}
+
+
+MappedFile::~MappedFile(void){
+
+	Close();
+}
+
+
+bool MappedFile::Open(const std::string &path){
+
+	Close();
+
+#ifdef _WIN32
+	file_handle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file_handle_ == INVALID_HANDLE_VALUE){
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle_, &file_size) || file_size.QuadPart == 0){
+		Close();
+		return false;
+	}
+
+	mapping_handle_ = CreateFileMappingA(file_handle_, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping_handle_ == NULL){
+		Close();
+		return false;
+	}
+
+	void *view = MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL){
+		Close();
+		return false;
+	}
+
+	data_ = static_cast<const unsigned char *>(view);
+	size_ = (size_t) file_size.QuadPart;
+#else
+	file_descriptor_ = open(path.c_str(), O_RDONLY);
+	if (file_descriptor_ < 0){
+		return false;
+	}
+
+	struct stat file_stat;
+	if (fstat(file_descriptor_, &file_stat) != 0 || file_stat.st_size == 0){
+		Close();
+		return false;
+	}
+
+	void *view = mmap(NULL, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+	if (view == MAP_FAILED){
+		Close();
+		return false;
+	}
+
+	data_ = static_cast<const unsigned char *>(view);
+	size_ = (size_t) file_stat.st_size;
+#endif
+
+	return true;
+}
+
+
+void MappedFile::Close(void){
+
+#ifdef _WIN32
+	if (data_){
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_handle_ != NULL){
+		CloseHandle(mapping_handle_);
+	}
+	if (file_handle_ != INVALID_HANDLE_VALUE){
+		CloseHandle(file_handle_);
+	}
+	file_handle_ = INVALID_HANDLE_VALUE;
+	mapping_handle_ = NULL;
+#else
+	if (data_){
+		munmap(const_cast<unsigned char *>(data_), size_);
+	}
+	if (file_descriptor_ >= 0){
+		close(file_descriptor_);
+	}
+	file_descriptor_ = -1;
+#endif
+
+	data_ = NULL;
+	size_ = 0;
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <string>
+
+namespace ogre_application {
+
+	/* Read-only memory mapping of a file on disk */
+	/* The contents can be handed directly to Ogre buffers without an intermediate copy */
+	class MappedFile
+	{
+		public:
+			MappedFile(void);
+			~MappedFile(void);
+
+			bool Open(const std::string &path); // Returns false if the file does not exist or is empty
+			void Close(void);
+			bool IsOpen(void) const { return data_ != NULL; }
+
+			const unsigned char *GetData(void) const { return data_; }
+			size_t GetSize(void) const { return size_; }
+
+		private:
+			const unsigned char *data_;
+			size_t size_;
+#ifdef _WIN32
+			void *file_handle_;
+			void *mapping_handle_;
+#else
+			int file_descriptor_;
+#endif
+
+			/* A mapping owns OS handles, so it cannot be copied */
+			MappedFile(const MappedFile &);
+			MappedFile &operator=(const MappedFile &);
+	};
+
+} // namespace ogre_application;
+
+#endif // MAPPED_FILE_H_
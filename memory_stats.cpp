@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "OGRE/OgreMeshManager.h"
+#include "OGRE/OgreMaterialManager.h"
+#include "OGRE/OgreTextureManager.h"
+#include "OGRE/OgreSubMesh.h"
+#include "OGRE/OgreEntity.h"
+#include "OGRE/OgreSubEntity.h"
+#include "OGRE/OgreSceneNode.h"
+#include "OGRE/OgreTechnique.h"
+#include "OGRE/OgrePass.h"
+#include "OGRE/OgreTextureUnitState.h"
+#include "OGRE/OgrePixelFormat.h"
+
+#include "memory_stats.h"
+
+namespace ogre_application {
+
+const char *memory_category_names_g[NUM_MEMORY_CATEGORIES] = {
+	"staging", "arena", "meshes", "entities", "scene nodes", "materials", "textures", "compositor targets"
+};
+
+
+static double Megabytes(size_t bytes){
+
+	return bytes/(1024.0*1024.0);
+}
+
+
+static void AddBuffer(const Ogre::HardwareBuffer *buffer, size_t &cpu_bytes, size_t &gpu_bytes){
+
+	gpu_bytes += buffer->getSizeInBytes();
+	if (buffer->hasShadowBuffer()){
+		cpu_bytes += buffer->getSizeInBytes();
+	}
+}
+
+
+static void AddVertexData(const Ogre::VertexData *vertex_data, size_t &cpu_bytes, size_t &gpu_bytes){
+
+	if (!vertex_data){
+		return;
+	}
+	cpu_bytes += sizeof(Ogre::VertexData);
+	const Ogre::VertexBufferBinding::VertexBufferBindingMap &bindings = vertex_data->vertexBufferBinding->getBindings();
+	for (Ogre::VertexBufferBinding::VertexBufferBindingMap::const_iterator it = bindings.begin(); it != bindings.end(); it++){
+		AddBuffer(it->second.getPointer(), cpu_bytes, gpu_bytes);
+	}
+}
+
+
+static void AddIndexData(const Ogre::IndexData *index_data, size_t &cpu_bytes, size_t &gpu_bytes){
+
+	if (!index_data){
+		return;
+	}
+	cpu_bytes += sizeof(Ogre::IndexData);
+	if (!index_data->indexBuffer.isNull()){
+		AddBuffer(index_data->indexBuffer.getPointer(), cpu_bytes, gpu_bytes);
+	}
+}
+
+
+static void AddParameters(const Ogre::GpuProgramParametersSharedPtr &params, size_t &cpu_bytes){
+
+	if (params.isNull()){
+		return;
+	}
+	cpu_bytes += sizeof(Ogre::GpuProgramParameters);
+	cpu_bytes += params->getFloatConstantList().size()*sizeof(float);
+	cpu_bytes += params->getIntConstantList().size()*sizeof(int);
+}
+
+
+MemoryStats::MemoryStats(void){
+
+	for (int i = 0; i < NUM_MEMORY_CATEGORIES; i++){
+		usage_[i].count = 0;
+		usage_[i].cpu_bytes = 0;
+		usage_[i].gpu_bytes = 0;
+		usage_[i].peak_cpu_bytes = 0;
+		usage_[i].peak_gpu_bytes = 0;
+	}
+}
+
+
+void MemoryStats::Add(MemoryCategory category, size_t cpu_bytes, size_t gpu_bytes){
+
+	MemoryUsage &usage = usage_[category];
+	Set(category, usage.count + 1, usage.cpu_bytes + cpu_bytes, usage.gpu_bytes + gpu_bytes);
+}
+
+
+void MemoryStats::Remove(MemoryCategory category, size_t cpu_bytes, size_t gpu_bytes){
+
+	MemoryUsage &usage = usage_[category];
+	Set(category, (usage.count > 0) ? usage.count - 1 : 0,
+		usage.cpu_bytes - std::min(cpu_bytes, usage.cpu_bytes), usage.gpu_bytes - std::min(gpu_bytes, usage.gpu_bytes));
+}
+
+
+void MemoryStats::Set(MemoryCategory category, size_t count, size_t cpu_bytes, size_t gpu_bytes){
+
+	MemoryUsage &usage = usage_[category];
+	usage.count = count;
+	usage.cpu_bytes = cpu_bytes;
+	usage.gpu_bytes = gpu_bytes;
+	usage.peak_cpu_bytes = std::max(usage.peak_cpu_bytes, cpu_bytes);
+	usage.peak_gpu_bytes = std::max(usage.peak_gpu_bytes, gpu_bytes);
+}
+
+
+void MemoryStats::Sample(Ogre::SceneManager *scene_manager){
+
+	/* Meshes: their buffers, shared or per submesh */
+	size_t count = 0, cpu_bytes = 0, gpu_bytes = 0;
+	Ogre::ResourceManager::ResourceMapIterator meshes = Ogre::MeshManager::getSingleton().getResourceIterator();
+	while (meshes.hasMoreElements()){
+		Ogre::Mesh *mesh = static_cast<Ogre::Mesh *>(meshes.getNext().getPointer());
+		if (!mesh->isLoaded()){
+			continue;
+		}
+		count++;
+		cpu_bytes += sizeof(Ogre::Mesh);
+		AddVertexData(mesh->sharedVertexData, cpu_bytes, gpu_bytes);
+		for (unsigned short i = 0; i < mesh->getNumSubMeshes(); i++){
+			const Ogre::SubMesh *submesh = mesh->getSubMesh(i);
+			cpu_bytes += sizeof(Ogre::SubMesh);
+			if (!submesh->useSharedVertices){
+				AddVertexData(submesh->vertexData, cpu_bytes, gpu_bytes);
+			}
+			AddIndexData(submesh->indexData, cpu_bytes, gpu_bytes);
+		}
+	}
+	Set(MEMORY_MESHES, count, cpu_bytes, gpu_bytes);
+
+	/* Entities share the buffers of their mesh */
+	count = 0;
+	cpu_bytes = 0;
+	Ogre::SceneManager::MovableObjectIterator entities = scene_manager->getMovableObjectIterator("Entity");
+	while (entities.hasMoreElements()){
+		Ogre::Entity *entity = static_cast<Ogre::Entity *>(entities.getNext());
+		count++;
+		cpu_bytes += sizeof(Ogre::Entity) + entity->getNumSubEntities()*sizeof(Ogre::SubEntity);
+	}
+	Set(MEMORY_ENTITIES, count, cpu_bytes, 0);
+
+	/* Scene nodes, from the root down */
+	count = 0;
+	std::vector<Ogre::Node *> stack(1, scene_manager->getRootSceneNode());
+	while (!stack.empty()){
+		Ogre::Node *node = stack.back();
+		stack.pop_back();
+		count++;
+		Ogre::Node::ChildNodeIterator children = node->getChildIterator();
+		while (children.hasMoreElements()){
+			stack.push_back(children.getNext());
+		}
+	}
+	Set(MEMORY_SCENE_NODES, count, count*sizeof(Ogre::SceneNode), 0);
+
+	/* Materials: techniques, passes, texture units and program parameters */
+	count = 0;
+	cpu_bytes = 0;
+	Ogre::ResourceManager::ResourceMapIterator materials = Ogre::MaterialManager::getSingleton().getResourceIterator();
+	while (materials.hasMoreElements()){
+		Ogre::Material *material = static_cast<Ogre::Material *>(materials.getNext().getPointer());
+		count++;
+		cpu_bytes += sizeof(Ogre::Material);
+		for (unsigned short i = 0; i < material->getNumTechniques(); i++){
+			Ogre::Technique *technique = material->getTechnique(i);
+			cpu_bytes += sizeof(Ogre::Technique);
+			for (unsigned short j = 0; j < technique->getNumPasses(); j++){
+				Ogre::Pass *pass = technique->getPass(j);
+				cpu_bytes += sizeof(Ogre::Pass) + pass->getNumTextureUnitStates()*sizeof(Ogre::TextureUnitState);
+				if (pass->hasVertexProgram()){
+					AddParameters(pass->getVertexProgramParameters(), cpu_bytes);
+				}
+				if (pass->hasFragmentProgram()){
+					AddParameters(pass->getFragmentProgramParameters(), cpu_bytes);
+				}
+			}
+		}
+	}
+	Set(MEMORY_MATERIALS, count, cpu_bytes, 0);
+
+	/* Textures: every face and mip level; render textures are the compositors' */
+	size_t target_count = 0, target_cpu_bytes = 0, target_gpu_bytes = 0;
+	count = 0;
+	cpu_bytes = 0;
+	gpu_bytes = 0;
+	Ogre::ResourceManager::ResourceMapIterator textures = Ogre::TextureManager::getSingleton().getResourceIterator();
+	while (textures.hasMoreElements()){
+		Ogre::Texture *texture = static_cast<Ogre::Texture *>(textures.getNext().getPointer());
+		if (!texture->isLoaded()){
+			continue;
+		}
+		size_t bytes = 0;
+		size_t width = texture->getWidth(), height = texture->getHeight(), depth = texture->getDepth();
+		for (size_t level = 0; level <= texture->getNumMipmaps(); level++){
+			bytes += Ogre::PixelUtil::getMemorySize(width, height, depth, texture->getFormat());
+			width = std::max<size_t>(width/2, 1);
+			height = std::max<size_t>(height/2, 1);
+			depth = std::max<size_t>(depth/2, 1);
+		}
+		bytes *= texture->getNumFaces();
+		if (texture->getUsage() & Ogre::TU_RENDERTARGET){
+			target_count++;
+			target_cpu_bytes += sizeof(Ogre::Texture);
+			target_gpu_bytes += bytes;
+		}
+		else {
+			count++;
+			cpu_bytes += sizeof(Ogre::Texture);
+			gpu_bytes += bytes;
+		}
+	}
+	Set(MEMORY_TEXTURES, count, cpu_bytes, gpu_bytes);
+	Set(MEMORY_COMPOSITOR_TARGETS, target_count, target_cpu_bytes, target_gpu_bytes);
+}
+
+
+const char *MemoryStats::GetCategoryName(MemoryCategory category){
+
+	return memory_category_names_g[category];
+}
+
+
+Ogre::String MemoryStats::Report(Ogre::SceneManager *scene_manager){
+
+	Sample(scene_manager);
+
+	std::ostringstream report;
+	report << std::fixed << std::setprecision(2) << "Memory (MB, live/peak):";
+	size_t cpu_bytes = 0, gpu_bytes = 0;
+	for (int i = 0; i < NUM_MEMORY_CATEGORIES; i++){
+		const MemoryUsage &usage = usage_[i];
+		report << "\n  " << std::left << std::setw(20) << memory_category_names_g[i] << std::right
+		       << std::setw(8) << usage.count << " objects, CPU "
+		       << Megabytes(usage.cpu_bytes) << "/" << Megabytes(usage.peak_cpu_bytes) << ", GPU "
+		       << Megabytes(usage.gpu_bytes) << "/" << Megabytes(usage.peak_gpu_bytes);
+		cpu_bytes += usage.cpu_bytes;
+		gpu_bytes += usage.gpu_bytes;
+	}
+	report << "\n  total CPU " << Megabytes(cpu_bytes) << ", GPU " << Megabytes(gpu_bytes);
+	return report.str();
+}
+
+
+void MemoryStats::EstimateStaging(const Ogre::ManualObject *object, size_t &cpu_bytes, size_t &gpu_bytes){
+
+	/* Each section has hardware buffers of its own; the temporary buffers the vertices
+	   are written into are shared by the sections and grow to the largest of them */
+	cpu_bytes = sizeof(Ogre::ManualObject);
+	gpu_bytes = 0;
+	size_t largest_section = 0;
+	for (unsigned int i = 0; i < object->getNumSections(); i++){
+		Ogre::ManualObject::ManualObjectSection *section = object->getSection(i);
+		Ogre::RenderOperation *operation = section->getRenderOperation();
+		size_t section_cpu_bytes = 0, section_gpu_bytes = 0;
+		AddVertexData(operation->vertexData, section_cpu_bytes, section_gpu_bytes);
+		if (operation->useIndexes){
+			AddIndexData(operation->indexData, section_cpu_bytes, section_gpu_bytes);
+		}
+		cpu_bytes += sizeof(Ogre::ManualObject::ManualObjectSection) + section_cpu_bytes;
+		gpu_bytes += section_gpu_bytes;
+		largest_section = std::max(largest_section, section_gpu_bytes);
+	}
+	cpu_bytes += largest_section;
+}
+
+
+} // namespace ogre_application;
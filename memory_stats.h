@@ -0,0 +1,66 @@
+#ifndef MEMORY_STATS_H_
+#define MEMORY_STATS_H_
+
+#include "OGRE/OgreString.h"
+#include "OGRE/OgreSceneManager.h"
+#include "OGRE/OgreManualObject.h"
+
+namespace ogre_application {
+
+	/* What the memory is used for */
+	enum MemoryCategory {
+		MEMORY_STAGING,            // ManualObject buffers of generated meshes, until converted
+		MEMORY_ARENA,              // Transient construction data, see Arena
+		MEMORY_MESHES,
+		MEMORY_ENTITIES,
+		MEMORY_SCENE_NODES,
+		MEMORY_MATERIALS,
+		MEMORY_TEXTURES,
+		MEMORY_COMPOSITOR_TARGETS, // Render textures
+		NUM_MEMORY_CATEGORIES
+	};
+
+	/* Live and peak bytes of a category */
+	struct MemoryUsage
+	{
+		size_t count; // Objects
+		size_t cpu_bytes;
+		size_t gpu_bytes;
+		size_t peak_cpu_bytes;
+		size_t peak_gpu_bytes;
+	};
+
+	/* Per-category estimate of the memory the scene uses, on the CPU and on the GPU */
+	/* Ogre does not expose its allocations, so the sizes are computed from what the objects
+	   hold: the object itself and its parts on the CPU, buffers and texture levels on the
+	   GPU (shadow buffers count twice). Transient categories are recorded with Add(), Remove()
+	   or Set() as they change; the others are sampled from the resource managers and the
+	   scene manager. Peaks are over everything recorded or sampled */
+	class MemoryStats
+	{
+		public:
+			MemoryStats(void);
+
+			void Add(MemoryCategory category, size_t cpu_bytes, size_t gpu_bytes);
+			void Remove(MemoryCategory category, size_t cpu_bytes, size_t gpu_bytes);
+			void Set(MemoryCategory category, size_t count, size_t cpu_bytes, size_t gpu_bytes);
+
+			// Update the meshes, entities, scene nodes, materials, textures and compositor targets
+			void Sample(Ogre::SceneManager *scene_manager);
+
+			const MemoryUsage &GetUsage(MemoryCategory category) const { return usage_[category]; }
+			static const char *GetCategoryName(MemoryCategory category);
+
+			// Table of every category, after sampling
+			Ogre::String Report(Ogre::SceneManager *scene_manager);
+
+			// Bytes a ManualObject holds between end() and its destruction
+			static void EstimateStaging(const Ogre::ManualObject *object, size_t &cpu_bytes, size_t &gpu_bytes);
+
+		private:
+			MemoryUsage usage_[NUM_MEMORY_CATEGORIES];
+	};
+
+} // namespace ogre_application;
+
+#endif // MEMORY_STATS_H_
@@ -0,0 +1,452 @@
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "OGRE/OgreMeshManager.h"
+#include "OGRE/OgreSubMesh.h"
+#include "OGRE/OgreHardwareBufferManager.h"
+#include "OGRE/OgreLogManager.h"
+#include "OGRE/OgreResourceGroupManager.h"
+#include "OGRE/OgreStringConverter.h"
+
+#include "mesh_cache.h"
+#include "mapped_file.h"
+#include "ogre_application.h"
+#include "vertex_compression.h"
+
+namespace ogre_application {
+
+/* File format constants */
+/* Bump the version whenever the layout below changes so stale caches are regenerated */
+const char mesh_cache_magic_g[4] = { 'O', 'M', 'C', 'H' };
+const Ogre::uint32 mesh_cache_version_g = 2;
+const Ogre::String mesh_cache_extension_g = ".meshcache";
+
+/* Index types as stored on disk */
+const Ogre::uint32 mesh_cache_no_indices_g = 0;
+const Ogre::uint32 mesh_cache_16bit_indices_g = 1;
+const Ogre::uint32 mesh_cache_32bit_indices_g = 2;
+
+
+/* Helpers to write the cache file; all values are stored in host byte order */
+static void WriteBytes(std::vector<unsigned char> &out, const void *data, size_t size){
+
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+	out.insert(out.end(), bytes, bytes + size);
+}
+
+
+static void WriteUint32(std::vector<unsigned char> &out, Ogre::uint32 value){
+
+	WriteBytes(out, &value, sizeof(value));
+}
+
+
+static void WriteFloat(std::vector<unsigned char> &out, float value){
+
+	WriteBytes(out, &value, sizeof(value));
+}
+
+
+static void WriteString(std::vector<unsigned char> &out, const Ogre::String &value){
+
+	WriteUint32(out, (Ogre::uint32) value.size());
+	WriteBytes(out, value.data(), value.size());
+}
+
+
+static void WritePadding(std::vector<unsigned char> &out){
+
+	/* Keep buffer payloads 4-byte aligned inside the mapping */
+	while (out.size() % 4 != 0){
+		out.push_back(0);
+	}
+}
+
+
+/* Bounds-checked reader over a memory mapped cache file */
+class MeshCacheReader
+{
+	public:
+		MeshCacheReader(const unsigned char *data, size_t size) : data_(data), size_(size), offset_(0) {};
+
+		const unsigned char *ReadBytes(size_t size){
+			if (size > size_ - offset_){
+				throw(OgreAppException(std::string("MeshCache::Exception: Truncated cache file.")));
+			}
+			const unsigned char *bytes = data_ + offset_;
+			offset_ += size;
+			return bytes;
+		}
+
+		Ogre::uint32 ReadUint32(void){
+			Ogre::uint32 value;
+			memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+			return value;
+		}
+
+		float ReadFloat(void){
+			float value;
+			memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+			return value;
+		}
+
+		Ogre::String ReadString(void){
+			Ogre::uint32 length = ReadUint32();
+			const unsigned char *bytes = ReadBytes(length);
+			return Ogre::String((const char *) bytes, length);
+		}
+
+		void SkipPadding(void){
+			while (offset_ % 4 != 0){
+				ReadBytes(1);
+			}
+		}
+
+	private:
+		const unsigned char *data_;
+		size_t size_;
+		size_t offset_;
+};
+
+
+MeshCacheKey::MeshCacheKey(const Ogre::String &generator_name, int generator_revision){
+
+	key_ = generator_name + "|r" + Ogre::StringConverter::toString(generator_revision);
+}
+
+
+MeshCacheKey &MeshCacheKey::Add(float value){
+
+	Ogre::uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	std::ostringstream stream;
+	stream << "|f" << std::hex << std::setw(8) << std::setfill('0') << bits;
+	key_ += stream.str();
+	return *this;
+}
+
+
+MeshCacheKey &MeshCacheKey::Add(int value){
+
+	key_ += "|i" + Ogre::StringConverter::toString(value);
+	return *this;
+}
+
+
+MeshCacheKey &MeshCacheKey::Add(const Ogre::String &value){
+
+	key_ += "|s" + Ogre::StringConverter::toString(value.size()) + ":" + value;
+	return *this;
+}
+
+
+Ogre::uint64 MeshCacheKey::GetHash(void) const {
+
+	Ogre::uint64 hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < key_.size(); i++){
+		hash ^= (unsigned char) key_[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+MeshCache::MeshCache(void){
+
+	mode_ = MODE_OFF;
+	num_hits_ = 0;
+	num_misses_ = 0;
+	num_mismatches_ = 0;
+}
+
+
+void MeshCache::Init(const Ogre::String &directory, Mode mode){
+
+	directory_ = directory;
+	mode_ = mode;
+	num_hits_ = 0;
+	num_misses_ = 0;
+	num_mismatches_ = 0;
+}
+
+
+Ogre::String MeshCache::GetFileName(const MeshCacheKey &key) const {
+
+	std::ostringstream stream;
+	stream << directory_ << "/" << std::hex << std::setw(16) << std::setfill('0') << key.GetHash() << mesh_cache_extension_g;
+	return stream.str();
+}
+
+
+bool MeshCache::Serialize(const MeshCacheKey &key, const Ogre::MeshPtr &mesh, std::vector<unsigned char> &out){
+
+	out.clear();
+	if (mesh->sharedVertexData){
+		/* ManualObject::convertToMesh never creates shared vertex data */
+		return false;
+	}
+
+	WriteBytes(out, mesh_cache_magic_g, sizeof(mesh_cache_magic_g));
+	WriteUint32(out, mesh_cache_version_g);
+	WriteString(out, key.GetString());
+
+	const Ogre::AxisAlignedBox &bounds = mesh->getBounds();
+	WriteFloat(out, bounds.getMinimum().x);
+	WriteFloat(out, bounds.getMinimum().y);
+	WriteFloat(out, bounds.getMinimum().z);
+	WriteFloat(out, bounds.getMaximum().x);
+	WriteFloat(out, bounds.getMaximum().y);
+	WriteFloat(out, bounds.getMaximum().z);
+	WriteFloat(out, mesh->getBoundingSphereRadius());
+
+	/* Range of quantized positions, as the encoder used it */
+	Ogre::Vector3 quantization_scale, quantization_bias;
+	bool quantized = VertexCompression::GetQuantization(mesh->getName(), quantization_scale, quantization_bias);
+	WriteUint32(out, quantized ? 1 : 0);
+	if (quantized){
+		for (int i = 0; i < 3; i++){
+			WriteFloat(out, quantization_scale[i]);
+		}
+		for (int i = 0; i < 3; i++){
+			WriteFloat(out, quantization_bias[i]);
+		}
+	}
+
+	WriteUint32(out, (Ogre::uint32) mesh->getNumSubMeshes());
+	for (unsigned short i = 0; i < mesh->getNumSubMeshes(); i++){
+		Ogre::SubMesh *sub_mesh = mesh->getSubMesh(i);
+		Ogre::VertexData *vertex_data = sub_mesh->vertexData;
+		if (sub_mesh->useSharedVertices || !vertex_data){
+			return false;
+		}
+
+		WriteString(out, sub_mesh->getMaterialName());
+		WriteUint32(out, (Ogre::uint32) sub_mesh->operationType);
+
+		/* Vertex layout */
+		const Ogre::VertexDeclaration::VertexElementList &elements = vertex_data->vertexDeclaration->getElements();
+		WriteUint32(out, (Ogre::uint32) elements.size());
+		Ogre::VertexDeclaration::VertexElementList::const_iterator element = elements.begin();
+		for (; element != elements.end(); element++){
+			WriteUint32(out, element->getSource());
+			WriteUint32(out, (Ogre::uint32) element->getOffset());
+			WriteUint32(out, (Ogre::uint32) element->getType());
+			WriteUint32(out, (Ogre::uint32) element->getSemantic());
+			WriteUint32(out, element->getIndex());
+		}
+
+		/* Vertex buffers, one per bound source */
+		WriteUint32(out, (Ogre::uint32) vertex_data->vertexCount);
+		const Ogre::VertexBufferBinding::VertexBufferBindingMap &bindings = vertex_data->vertexBufferBinding->getBindings();
+		WriteUint32(out, (Ogre::uint32) bindings.size());
+		Ogre::VertexBufferBinding::VertexBufferBindingMap::const_iterator binding = bindings.begin();
+		for (; binding != bindings.end(); binding++){
+			const Ogre::HardwareVertexBufferSharedPtr &buffer = binding->second;
+			size_t num_bytes = buffer->getVertexSize()*vertex_data->vertexCount;
+			WriteUint32(out, binding->first);
+			WriteUint32(out, (Ogre::uint32) buffer->getVertexSize());
+			size_t offset = out.size();
+			out.resize(offset + num_bytes);
+			buffer->readData(vertex_data->vertexStart*buffer->getVertexSize(), num_bytes, &out[offset]);
+			WritePadding(out);
+		}
+
+		/* Index buffer; fans and strips from ManualObject may have none */
+		Ogre::IndexData *index_data = sub_mesh->indexData;
+		if (!index_data || index_data->indexCount == 0 || index_data->indexBuffer.isNull()){
+			WriteUint32(out, mesh_cache_no_indices_g);
+			WriteUint32(out, 0);
+		}
+		else {
+			const Ogre::HardwareIndexBufferSharedPtr &buffer = index_data->indexBuffer;
+			WriteUint32(out, buffer->getType() == Ogre::HardwareIndexBuffer::IT_16BIT ? mesh_cache_16bit_indices_g : mesh_cache_32bit_indices_g);
+			WriteUint32(out, (Ogre::uint32) index_data->indexCount);
+			size_t num_bytes = buffer->getIndexSize()*index_data->indexCount;
+			size_t offset = out.size();
+			out.resize(offset + num_bytes);
+			buffer->readData(index_data->indexStart*buffer->getIndexSize(), num_bytes, &out[offset]);
+			WritePadding(out);
+		}
+	}
+
+	return true;
+}
+
+
+bool MeshCache::Load(const MeshCacheKey &key, const Ogre::String &mesh_name){
+
+	if (mode_ != MODE_USE){
+		return false;
+	}
+
+	MappedFile file;
+	if (!file.Open(GetFileName(key))){
+		num_misses_++;
+		return false;
+	}
+
+	MeshCacheReader reader(file.GetData(), file.GetSize());
+	Ogre::MeshPtr mesh;
+
+	try {
+
+		/* Reject files written by another version or for another key */
+		if (memcmp(reader.ReadBytes(sizeof(mesh_cache_magic_g)), mesh_cache_magic_g, sizeof(mesh_cache_magic_g)) != 0 ||
+			reader.ReadUint32() != mesh_cache_version_g ||
+			reader.ReadString() != key.GetString()){
+			num_misses_++;
+			return false;
+		}
+
+		Ogre::Vector3 bounds_min, bounds_max;
+		bounds_min.x = reader.ReadFloat();
+		bounds_min.y = reader.ReadFloat();
+		bounds_min.z = reader.ReadFloat();
+		bounds_max.x = reader.ReadFloat();
+		bounds_max.y = reader.ReadFloat();
+		bounds_max.z = reader.ReadFloat();
+		float radius = reader.ReadFloat();
+
+		bool quantized = reader.ReadUint32() != 0;
+		Ogre::Vector3 quantization_scale, quantization_bias;
+		if (quantized){
+			for (int i = 0; i < 3; i++){
+				quantization_scale[i] = reader.ReadFloat();
+			}
+			for (int i = 0; i < 3; i++){
+				quantization_bias[i] = reader.ReadFloat();
+			}
+		}
+
+		mesh = Ogre::MeshManager::getSingleton().createManual(mesh_name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+		Ogre::HardwareBufferManager &buffer_manager = Ogre::HardwareBufferManager::getSingleton();
+
+		Ogre::uint32 num_sub_meshes = reader.ReadUint32();
+		for (Ogre::uint32 i = 0; i < num_sub_meshes; i++){
+			Ogre::SubMesh *sub_mesh = mesh->createSubMesh();
+			sub_mesh->setMaterialName(reader.ReadString());
+			sub_mesh->operationType = static_cast<Ogre::RenderOperation::OperationType>(reader.ReadUint32());
+			sub_mesh->useSharedVertices = false;
+
+			/* Vertex layout */
+			Ogre::VertexData *vertex_data = OGRE_NEW Ogre::VertexData();
+			sub_mesh->vertexData = vertex_data;
+			Ogre::uint32 num_elements = reader.ReadUint32();
+			for (Ogre::uint32 j = 0; j < num_elements; j++){
+				unsigned short source = (unsigned short) reader.ReadUint32();
+				size_t offset = reader.ReadUint32();
+				Ogre::VertexElementType type = static_cast<Ogre::VertexElementType>(reader.ReadUint32());
+				Ogre::VertexElementSemantic semantic = static_cast<Ogre::VertexElementSemantic>(reader.ReadUint32());
+				unsigned short index = (unsigned short) reader.ReadUint32();
+				vertex_data->vertexDeclaration->addElement(source, offset, type, semantic, index);
+			}
+
+			/* Vertex buffers are filled straight from the mapping */
+			vertex_data->vertexStart = 0;
+			vertex_data->vertexCount = reader.ReadUint32();
+			Ogre::uint32 num_buffers = reader.ReadUint32();
+			for (Ogre::uint32 j = 0; j < num_buffers; j++){
+				unsigned short source = (unsigned short) reader.ReadUint32();
+				size_t vertex_size = reader.ReadUint32();
+				const unsigned char *bytes = reader.ReadBytes(vertex_size*vertex_data->vertexCount);
+				reader.SkipPadding();
+
+				Ogre::HardwareVertexBufferSharedPtr buffer = buffer_manager.createVertexBuffer(vertex_size, vertex_data->vertexCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+				buffer->writeData(0, vertex_size*vertex_data->vertexCount, bytes, true);
+				vertex_data->vertexBufferBinding->setBinding(source, buffer);
+			}
+
+			/* Index buffer */
+			Ogre::uint32 index_type = reader.ReadUint32();
+			Ogre::uint32 index_count = reader.ReadUint32();
+			sub_mesh->indexData->indexStart = 0;
+			sub_mesh->indexData->indexCount = index_count;
+			if (index_type != mesh_cache_no_indices_g){
+				Ogre::HardwareIndexBuffer::IndexType type = (index_type == mesh_cache_16bit_indices_g) ? Ogre::HardwareIndexBuffer::IT_16BIT : Ogre::HardwareIndexBuffer::IT_32BIT;
+				Ogre::HardwareIndexBufferSharedPtr buffer = buffer_manager.createIndexBuffer(type, index_count, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+				const unsigned char *bytes = reader.ReadBytes(buffer->getSizeInBytes());
+				reader.SkipPadding();
+				buffer->writeData(0, buffer->getSizeInBytes(), bytes, true);
+				sub_mesh->indexData->indexBuffer = buffer;
+			}
+		}
+
+		/* The stored bounds were padded when the generated mesh got them */
+		mesh->_setBounds(Ogre::AxisAlignedBox(bounds_min, bounds_max), false);
+		mesh->_setBoundingSphereRadius(radius);
+		mesh->load();
+		if (quantized){
+			VertexCompression::SetQuantization(mesh_name, quantization_scale, quantization_bias);
+		}
+	}
+	catch (OgreAppException &e){
+		/* A damaged cache file is not fatal, we just fall back to the generator */
+		Ogre::LogManager::getSingleton().logMessage(Ogre::String("MeshCache: ") + e.what() + " Regenerating " + mesh_name + ".");
+		if (!mesh.isNull()){
+			Ogre::MeshManager::getSingleton().remove(mesh->getHandle());
+		}
+		num_misses_++;
+		return false;
+	}
+	catch (Ogre::Exception &e){
+		/* Nor is a layout or buffer Ogre rejects; the generator must find no mesh of that name */
+		Ogre::LogManager::getSingleton().logMessage(Ogre::String("MeshCache: ") + e.what() + " Regenerating " + mesh_name + ".");
+		if (!mesh.isNull()){
+			Ogre::MeshManager::getSingleton().remove(mesh->getHandle());
+		}
+		num_misses_++;
+		return false;
+	}
+
+	num_hits_++;
+	return true;
+}
+
+
+void MeshCache::Commit(const MeshCacheKey &key, const Ogre::MeshPtr &mesh){
+
+	if (mode_ == MODE_OFF){
+		return;
+	}
+
+	if (mode_ == MODE_VERIFY){
+		MappedFile file;
+		if (file.Open(GetFileName(key))){
+			file.Close();
+			Verify(key, mesh);
+			return;
+		}
+	}
+
+	std::vector<unsigned char> bytes;
+	if (!Serialize(key, mesh, bytes)){
+		return;
+	}
+
+	std::ofstream stream(GetFileName(key).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!stream){
+		Ogre::LogManager::getSingleton().logMessage("MeshCache: Could not write " + GetFileName(key) + ".");
+		return;
+	}
+	stream.write((const char *) &bytes[0], bytes.size());
+}
+
+
+bool MeshCache::Verify(const MeshCacheKey &key, const Ogre::MeshPtr &mesh){
+
+	std::vector<unsigned char> bytes;
+	MappedFile file;
+	bool match = Serialize(key, mesh, bytes) && file.Open(GetFileName(key)) &&
+		file.GetSize() == bytes.size() && memcmp(file.GetData(), &bytes[0], bytes.size()) == 0;
+
+	if (!match){
+		num_mismatches_++;
+	}
+	Ogre::LogManager::getSingleton().logMessage("MeshCache: Verify " + mesh->getName() + " (" + key.GetString() + "): " + (match ? "match" : "MISMATCH"));
+	return match;
+}
+
+
+} // namespace ogre_application;
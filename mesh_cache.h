@@ -0,0 +1,71 @@
+#ifndef MESH_CACHE_H_
+#define MESH_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "OGRE/OgreMesh.h"
+#include "OGRE/OgreString.h"
+
+namespace ogre_application {
+
+	/* Identifies a generated mesh by the name and revision of its generator and all of its parameters */
+	class MeshCacheKey
+	{
+		public:
+			// Give the generator a new revision whenever the meshes it makes change
+			MeshCacheKey(const Ogre::String &generator_name, int generator_revision);
+			MeshCacheKey &Add(float value); // Floats are stored bit exact, not as rounded text
+			MeshCacheKey &Add(int value);
+			MeshCacheKey &Add(const Ogre::String &value);
+
+			const Ogre::String &GetString(void) const { return key_; }
+			Ogre::uint64 GetHash(void) const; // 64-bit FNV-1a of the key string
+
+		private:
+			Ogre::String key_;
+	};
+
+	/* Binary cache for meshes built with ManualObject::convertToMesh */
+	/* Cached meshes are memory mapped on later runs and their vertex and index bytes
+	   are written straight from the mapping into the hardware buffers */
+	class MeshCache
+	{
+		public:
+			enum Mode {
+				MODE_OFF,    // Always generate, never touch the cache
+				MODE_USE,    // Load from the cache when possible, otherwise generate and store
+				MODE_VERIFY  // Always generate and compare the result byte for byte with the cache
+			};
+
+			MeshCache(void);
+			void Init(const Ogre::String &directory, Mode mode);
+			Mode GetMode(void) const { return mode_; }
+
+			// Create mesh_name from the cache; returns false if the generator has to run
+			bool Load(const MeshCacheKey &key, const Ogre::String &mesh_name);
+			// Call after generating a mesh: stores it, or verifies it against the cache
+			void Commit(const MeshCacheKey &key, const Ogre::MeshPtr &mesh);
+			// Compare a freshly generated mesh with the cached copy
+			bool Verify(const MeshCacheKey &key, const Ogre::MeshPtr &mesh);
+
+			// Serialize a mesh into the cache file format
+			static bool Serialize(const MeshCacheKey &key, const Ogre::MeshPtr &mesh, std::vector<unsigned char> &out);
+
+			int GetNumHits(void) const { return num_hits_; }
+			int GetNumMisses(void) const { return num_misses_; }
+			int GetNumMismatches(void) const { return num_mismatches_; }
+
+		private:
+			Ogre::String directory_;
+			Mode mode_;
+			int num_hits_;
+			int num_misses_;
+			int num_mismatches_;
+
+			Ogre::String GetFileName(const MeshCacheKey &key) const;
+	};
+
+} // namespace ogre_application;
+
+#endif // MESH_CACHE_H_
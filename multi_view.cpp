@@ -0,0 +1,244 @@
+#include "OGRE/OgreException.h"
+#include "OGRE/OgreCompositorManager.h"
+#include "OGRE/OgreCompositionTechnique.h"
+#include "OGRE/OgreTechnique.h"
+#include "OGRE/OgrePass.h"
+#include "OGRE/OgreTextureUnitState.h"
+
+#include "bloom.h"
+#include "multi_view.h"
+
+namespace ogre_application {
+
+/* Compositors of the views, see ScreenSpace.compositor */
+const Ogre::String view_effect_compositor_g = "ScreenSpaceEffect";
+const Ogre::String view_shared_compositor_g = "ScreenSpaceView";
+const Ogre::String view_scene_texture_g = "rt0";
+/* How far, in world units, a frustum corner may lie outside the culled frustum and an eye
+   away from the culled eye for the cull to be shared; covers rounding of the planes out
+   at the far clip distance */
+const float view_containment_tolerance_g = 1.0e-2;
+
+
+MultiView::MultiView(void){
+
+	scene_manager_ = NULL;
+	window_ = NULL;
+	main_viewport_ = NULL;
+	main_screen_space_ = NULL;
+	first_z_order_ = 0;
+	main_queue_shared_ = true;
+	culled_camera_ = NULL;
+	handled_camera_ = NULL;
+	saved_mask_ = 0xFFFFFFFF;
+	mask_changed_ = false;
+	num_scene_renders_ = 0;
+	num_shared_culls_ = 0;
+}
+
+
+MultiView::~MultiView(void){
+
+	Shutdown();
+}
+
+
+void MultiView::Init(Ogre::SceneManager *scene_manager, Ogre::RenderWindow *window, Ogre::Viewport *main_viewport, Ogre::CompositorInstance *main_screen_space, unsigned short first_z_order){
+
+	Shutdown();
+
+	scene_manager_ = scene_manager;
+	window_ = window;
+	main_viewport_ = main_viewport;
+	main_screen_space_ = main_screen_space;
+	first_z_order_ = first_z_order;
+
+	/* After the main view's compositor chain, which renders the main scene from the same
+	   event, and before the chains of the views */
+	window_->addListener(this);
+}
+
+
+void MultiView::Shutdown(void){
+
+	if (!window_){
+		return;
+	}
+
+	Ogre::CompositorManager &compositor_manager = Ogre::CompositorManager::getSingleton();
+	for (size_t i = 0; i < views_.size(); i++){
+		View *view = views_[i];
+		if (view->scene_target){
+			view->scene_target->removeListener(this);
+		}
+		compositor_manager.removeCompositorChain(view->viewport);
+		window_->removeViewport(view->viewport->getZOrder());
+		delete view;
+	}
+	views_.clear();
+	window_->removeListener(this);
+
+	scene_manager_ = NULL;
+	window_ = NULL;
+	main_viewport_ = NULL;
+	main_screen_space_ = NULL;
+	num_scene_renders_ = 0;
+	num_shared_culls_ = 0;
+}
+
+
+int MultiView::AddView(Ogre::Camera *camera, float left, float top, float width, float height, Ogre::CompositorInstance::Listener *parameters, Ogre::CompositorInstance::Listener *bloom){
+
+	View *view = new View;
+	view->camera = camera;
+	view->viewport = window_->addViewport(camera, first_z_order_ + (unsigned short) views_.size(), left, top, width, height);
+	view->viewport->setAutoUpdated(true);
+	view->viewport->setBackgroundColour(main_viewport_->getBackgroundColour());
+	view->viewport->setOverlaysEnabled(false);
+	view->scene_target = NULL;
+
+	Ogre::CompositorManager &compositor_manager = Ogre::CompositorManager::getSingleton();
+	if (camera == main_viewport_->getCamera()){
+		/* Nothing to render but the post effect */
+		view->sharing = VIEW_SHARES_TARGET;
+		view->binder.Init(main_screen_space_);
+		view->instance = compositor_manager.addCompositor(view->viewport, view_shared_compositor_g);
+		view->instance->addListener(&view->binder);
+	}
+	else {
+		camera->setAspectRatio(float(view->viewport->getActualWidth()) / float(view->viewport->getActualHeight()));
+		view->sharing = VIEW_SHARES_NOTHING;
+		view->instance = compositor_manager.addCompositor(view->viewport, view_effect_compositor_g);
+	}
+	if (!view->instance){
+		window_->removeViewport(view->viewport->getZOrder());
+		delete view;
+		OGRE_EXCEPT(Ogre::Exception::ERR_ITEM_NOT_FOUND, "Cannot add the compositor of a view", "MultiView::AddView");
+	}
+	view->instance->addListener(parameters);
+	if (bloom){
+		view->instance->addListener(bloom);
+	}
+	view->instance->setEnabled(true);
+
+	/* Its own targets exist once it is enabled */
+	if (view->sharing != VIEW_SHARES_TARGET){
+		view->scene_target = view->instance->getRenderTarget(view_scene_texture_g);
+		view->scene_target->addListener(this);
+	}
+
+	views_.push_back(view);
+	return (int) views_.size() - 1;
+}
+
+
+void MultiView::preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	/* The window's update starts with the compositor chains rendering their targets, the
+	   main view's first: its forward scene pass just filled the render queue */
+	if (evt.source == window_){
+		culled_camera_ = main_queue_shared_ ? main_viewport_->getCamera() : NULL;
+		handled_camera_ = main_viewport_->getCamera();
+		num_scene_renders_ = 0;
+		num_shared_culls_ = 0;
+		for (size_t i = 0; i < views_.size(); i++){
+			if (views_[i]->sharing == VIEW_SHARES_CULL){
+				views_[i]->sharing = VIEW_SHARES_NOTHING;
+			}
+		}
+		return;
+	}
+
+	View *view = FindView(evt.source);
+	if (!view){
+		return;
+	}
+	num_scene_renders_++;
+
+	/* The compositor chain has just set whether to find visible objects for this pass */
+	if (culled_camera_ && CanShareCull(culled_camera_, view->camera)){
+		scene_manager_->setFindVisibleObjects(false);
+		view->sharing = VIEW_SHARES_CULL;
+		num_shared_culls_++;
+	}
+	else {
+		saved_mask_ = scene_manager_->getVisibilityMask();
+		scene_manager_->setVisibilityMask(0xFFFFFFFF);
+		mask_changed_ = true;
+		culled_camera_ = view->camera;
+		view->sharing = VIEW_SHARES_NOTHING;
+	}
+
+	if (view->camera != handled_camera_){
+		handled_camera_ = view->camera;
+		if (camera_handler_){
+			camera_handler_(view->camera);
+		}
+	}
+}
+
+
+void MultiView::postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	/* The chain puts back the search for visible objects itself */
+	if (mask_changed_ && evt.source != window_){
+		scene_manager_->setVisibilityMask(saved_mask_);
+		mask_changed_ = false;
+	}
+}
+
+
+MultiView::View *MultiView::FindView(Ogre::RenderTarget *scene_target){
+
+	for (size_t i = 0; i < views_.size(); i++){
+		if (views_[i]->scene_target == scene_target){
+			return views_[i];
+		}
+	}
+	return NULL;
+}
+
+
+bool MultiView::CanShareCull(const Ogre::Camera *culled, const Ogre::Camera *camera) const{
+
+	/* Seen from the same eye, whatever is in the inner frustum is in the outer one and is
+	   hidden by the same occluders; every corner of a frustum inside another is inside it */
+	if (culled->getDerivedPosition().squaredDistance(camera->getDerivedPosition()) > view_containment_tolerance_g*view_containment_tolerance_g){
+		return false;
+	}
+	const Ogre::Vector3 *corners = camera->getWorldSpaceCorners();
+	for (int plane = 0; plane < 6; plane++){
+		const Ogre::Plane &bound = culled->getFrustumPlane(plane);
+		for (int i = 0; i < 8; i++){
+			if (bound.getDistance(corners[i]) < -view_containment_tolerance_g){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+void MultiView::TargetBinder::notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat){
+
+	if (pass_id != 0){
+		return;
+	}
+
+	/* The main view's textures are created again whenever its chain changes */
+	Ogre::Pass *pass = mat->getTechnique(0)->getPass(0);
+	Ogre::String names[2] = {view_scene_texture_g, Bloom::GetLevelName(0)};
+	for (unsigned short i = 0; i < 2 && i < pass->getNumTextureUnitStates(); i++){
+		if (!main_->getTechnique()->getTextureDefinition(names[i])){
+			continue;
+		}
+		Ogre::String name = main_->getTextureInstanceName(names[i], 0);
+		Ogre::TextureUnitState *unit = pass->getTextureUnitState(i);
+		if (unit->getTextureName() != name){
+			unit->setTextureName(name);
+		}
+	}
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,112 @@
+#ifndef MULTI_VIEW_H_
+#define MULTI_VIEW_H_
+
+#include <functional>
+#include <vector>
+
+#include "OGRE/OgreSceneManager.h"
+#include "OGRE/OgreCamera.h"
+#include "OGRE/OgreViewport.h"
+#include "OGRE/OgreRenderWindow.h"
+#include "OGRE/OgreRenderTargetListener.h"
+#include "OGRE/OgreCompositorInstance.h"
+
+namespace ogre_application {
+
+	/* What a view takes from the main view instead of doing it again */
+	enum ViewSharing {
+		VIEW_SHARES_TARGET, // Same camera: only its post effect runs, on the main view's scene target
+		VIEW_SHARES_CULL, // Frustum inside the last one culled from the same eye: draws that render queue
+		VIEW_SHARES_NOTHING
+	};
+
+	/* More views of the scene in the window, each with its own ScreenSpaceEffect */
+	/* A view with the main camera renders nothing of the scene: its ScreenSpaceView pass
+	   reads the scene and bloom targets the main view just rendered. Any other view has a
+	   ScreenSpaceEffect of its own at its own size. Before its scene pass, a view whose
+	   camera sits at the eye of the last culled camera, with a frustum inside that one's,
+	   turns off the scene manager's search for visible objects; its pass then draws the
+	   render queue that is still filled, so the cull and sort are done once for both. Every
+	   other view culls for itself against all entities, since the occlusion results only
+	   hold from the main eye. Views are drawn after the main view, in the order added */
+	class MultiView : public Ogre::RenderTargetListener
+	{
+		public:
+			// Called before a view with a camera other than the last one renders its scene
+			typedef std::function<void(Ogre::Camera *)> CameraHandler;
+
+			MultiView(void);
+			~MultiView(void);
+
+			// Call after the main view's compositors were added; main_screen_space is its ScreenSpaceEffect
+			void Init(Ogre::SceneManager *scene_manager, Ogre::RenderWindow *window, Ogre::Viewport *main_viewport, Ogre::CompositorInstance *main_screen_space, unsigned short first_z_order);
+			void Shutdown(void);
+
+			// Whether the main scene pass leaves a render queue views can draw (forward shading;
+			// the G-buffer pass queues techniques of another scheme)
+			void SetMainQueueShared(bool shared) { main_queue_shared_ = shared; }
+			void SetCameraHandler(CameraHandler handler) { camera_handler_ = handler; }
+
+			// Add a view in window coordinates (0 to 1); parameters updates its post effect
+			// material, bloom its bloom passes (may be NULL). Returns the view's index
+			int AddView(Ogre::Camera *camera, float left, float top, float width, float height, Ogre::CompositorInstance::Listener *parameters, Ogre::CompositorInstance::Listener *bloom);
+
+			int GetNumViews(void) const { return (int) views_.size(); }
+			Ogre::Viewport *GetViewport(int view) const { return views_[view]->viewport; }
+			ViewSharing GetSharing(int view) const { return views_[view]->sharing; }
+			// Scene target of a view with a ScreenSpaceEffect of its own, NULL otherwise
+			Ogre::RenderTarget *GetSceneTarget(int view) const { return views_[view]->scene_target; }
+
+			// Of the last frame, over all views: scene passes, and how many drew a shared render queue
+			int GetNumSceneRenders(void) const { return num_scene_renders_; }
+			int GetNumSharedCulls(void) const { return num_shared_culls_; }
+
+			virtual void preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+			virtual void postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+
+		private:
+			/* Points the ScreenSpaceView material at the main view's current targets */
+			class TargetBinder : public Ogre::CompositorInstance::Listener
+			{
+				public:
+					TargetBinder(void) : main_(NULL) {}
+					void Init(Ogre::CompositorInstance *main) { main_ = main; }
+					virtual void notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat);
+
+				private:
+					Ogre::CompositorInstance *main_;
+			};
+
+			struct View
+			{
+				Ogre::Camera *camera;
+				Ogre::Viewport *viewport;
+				Ogre::CompositorInstance *instance;
+				Ogre::RenderTarget *scene_target;
+				ViewSharing sharing;
+				TargetBinder binder;
+			};
+
+			Ogre::SceneManager *scene_manager_;
+			Ogre::RenderWindow *window_;
+			Ogre::Viewport *main_viewport_;
+			Ogre::CompositorInstance *main_screen_space_;
+			unsigned short first_z_order_;
+			bool main_queue_shared_;
+			CameraHandler camera_handler_;
+			std::vector<View *> views_;
+
+			Ogre::Camera *culled_camera_; // Whose visible objects the render queue holds, NULL if unusable
+			Ogre::Camera *handled_camera_; // Last camera passed to the handler
+			Ogre::uint32 saved_mask_;
+			bool mask_changed_;
+			int num_scene_renders_;
+			int num_shared_culls_;
+
+			View *FindView(Ogre::RenderTarget *scene_target);
+			bool CanShareCull(const Ogre::Camera *culled, const Ogre::Camera *camera) const;
+	};
+
+} // namespace ogre_application;
+
+#endif // MULTI_VIEW_H_
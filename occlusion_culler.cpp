@@ -0,0 +1,346 @@
+#include "OGRE/OgreTextureManager.h"
+#include "OGRE/OgreMaterialManager.h"
+#include "OGRE/OgreTechnique.h"
+#include "OGRE/OgreHardwarePixelBuffer.h"
+#include "OGRE/OgreHardwareBufferManager.h"
+#include "OGRE/OgreRenderTexture.h"
+#include "OGRE/OgreViewport.h"
+
+#include "occlusion_culler.h"
+
+namespace ogre_application {
+
+/* Depth target and material of the occlusion pass, see OcclusionQuery.material */
+const Ogre::String occlusion_texture_name_g = "OcclusionDepth";
+const Ogre::String occlusion_camera_name_g = "OcclusionCamera";
+const Ogre::String occlusion_material_g = "OcclusionQueryMaterial";
+/* An entity whose box comes this close to the camera, in near clip distances, is always
+   drawn: the near plane would cut into the box and lose its fragments */
+const float occlusion_near_margin_g = 2.0;
+
+
+OcclusionCuller::OcclusionCuller(void){
+
+	render_system_ = NULL;
+	scene_manager_ = NULL;
+	main_camera_ = NULL;
+	camera_ = NULL;
+	target_ = NULL;
+	viewport_ = NULL;
+	box_pass_ = NULL;
+	box_operation_.vertexData = NULL;
+	box_operation_.indexData = NULL;
+	enabled_ = false;
+	frame_ = 0;
+	num_occluders_ = 0;
+	num_tested_ = 0;
+	num_culled_ = 0;
+}
+
+
+OcclusionCuller::~OcclusionCuller(void){
+
+	Shutdown();
+}
+
+
+void OcclusionCuller::Init(Ogre::RenderSystem *render_system, Ogre::SceneManager *scene_manager, Ogre::Camera *camera, const Ogre::String &resource_group_name, size_t width, size_t height){
+
+	Shutdown();
+
+	render_system_ = render_system;
+	scene_manager_ = scene_manager;
+	main_camera_ = camera;
+
+	/* Entities made from now on may be culled; the scene manager only draws what carries
+	   one of the two flags, and the depth target only the occluders */
+	Ogre::MovableObject::setDefaultVisibilityFlags(~occluder_flag);
+	scene_manager_->setVisibilityMask(occluder_flag | unoccluded_flag);
+
+	/* Its own camera, so that the main camera keeps the window as its viewport */
+	camera_ = scene_manager_->createCamera(occlusion_camera_name_g);
+
+	/* Colour is written by the occluders' materials but never read */
+	texture_ = Ogre::TextureManager::getSingleton().createManual(occlusion_texture_name_g, resource_group_name, Ogre::TEX_TYPE_2D,
+		(Ogre::uint) width, (Ogre::uint) height, 0, Ogre::PF_R8G8B8A8, Ogre::TU_RENDERTARGET);
+	target_ = texture_->getBuffer()->getRenderTarget();
+	target_->setAutoUpdated(true);
+	viewport_ = target_->addViewport(camera_);
+	viewport_->setVisibilityMask(occluder_flag);
+	viewport_->setOverlaysEnabled(false);
+	viewport_->setSkiesEnabled(false);
+	viewport_->setShadowsEnabled(false);
+	viewport_->setClearEveryFrame(true, Ogre::FBT_COLOUR | Ogre::FBT_DEPTH);
+	target_->addListener(this);
+
+	Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().getByName(occlusion_material_g);
+	if (material.isNull()){
+		OGRE_EXCEPT(Ogre::Exception::ERR_ITEM_NOT_FOUND, "Cannot find material " + occlusion_material_g, "OcclusionCuller::Init");
+	}
+	material->load();
+	box_pass_ = material->getBestTechnique()->getPass(0);
+	CreateBox();
+
+	enabled_ = true;
+}
+
+
+void OcclusionCuller::Shutdown(void){
+
+	if (!scene_manager_){
+		return;
+	}
+	ShowAll();
+	for (std::map<Ogre::Entity *, Occludee>::iterator it = occludees_.begin(); it != occludees_.end(); it++){
+		ReleaseQuery(it->second);
+	}
+	occludees_.clear();
+	for (size_t i = 0; i < free_queries_.size(); i++){
+		render_system_->destroyHardwareOcclusionQuery(free_queries_[i]);
+	}
+	free_queries_.clear();
+	DestroyBox();
+
+	target_->removeListener(this);
+	target_->removeAllViewports();
+	Ogre::TextureManager::getSingleton().remove(texture_->getHandle());
+	texture_.setNull();
+	scene_manager_->destroyCamera(camera_);
+	scene_manager_->setVisibilityMask(0xFFFFFFFF);
+	Ogre::MovableObject::setDefaultVisibilityFlags(0xFFFFFFFF);
+
+	render_system_ = NULL;
+	scene_manager_ = NULL;
+	camera_ = NULL;
+	target_ = NULL;
+	viewport_ = NULL;
+	box_pass_ = NULL;
+	enabled_ = false;
+	num_occluders_ = 0;
+	num_tested_ = 0;
+	num_culled_ = 0;
+}
+
+
+void OcclusionCuller::SetEnabled(bool enabled){
+
+	if (!target_ || enabled == enabled_){
+		return;
+	}
+	enabled_ = enabled;
+	target_->setActive(enabled_);
+	if (!enabled_){
+		ShowAll();
+		num_tested_ = 0;
+		num_culled_ = 0;
+	}
+}
+
+
+void OcclusionCuller::AddOccluder(Ogre::Entity *entity){
+
+	if (!(entity->getVisibilityFlags() & occluder_flag)){
+		entity->addVisibilityFlags(occluder_flag | unoccluded_flag);
+		num_occluders_++;
+	}
+}
+
+
+void OcclusionCuller::RemoveOccluder(Ogre::Entity *entity){
+
+	if (entity->getVisibilityFlags() & occluder_flag){
+		entity->removeVisibilityFlags(occluder_flag);
+		num_occluders_--;
+	}
+}
+
+
+void OcclusionCuller::preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	frame_++;
+
+	/* Follow the main camera */
+	camera_->setPosition(main_camera_->getDerivedPosition());
+	camera_->setOrientation(main_camera_->getDerivedOrientation());
+	camera_->setFOVy(main_camera_->getFOVy());
+	camera_->setAspectRatio(main_camera_->getAspectRatio());
+	camera_->setNearClipDistance(main_camera_->getNearClipDistance());
+	camera_->setFarClipDistance(main_camera_->getFarClipDistance());
+
+	/* Collect the results that are in; the others keep last frame's answer */
+	for (std::map<Ogre::Entity *, Occludee>::iterator it = occludees_.begin(); it != occludees_.end(); it++){
+		Occludee &occludee = it->second;
+		if (occludee.issued && !occludee.query->isStillOutstanding()){
+			unsigned int fragments = 0;
+			occludee.query->pullOcclusionQuery(&fragments);
+			occludee.visible = fragments > 0;
+			occludee.issued = false;
+		}
+	}
+
+	/* Hide what was tested last frame and found hidden; everything else is drawn */
+	num_culled_ = 0;
+	Ogre::SceneManager::MovableObjectIterator entities = scene_manager_->getMovableObjectIterator("Entity");
+	while (entities.hasMoreElements()){
+		Ogre::Entity *entity = static_cast<Ogre::Entity *>(entities.getNext());
+		Ogre::uint32 flags = entity->getVisibilityFlags();
+		if (flags & occluder_flag){
+			continue;
+		}
+		std::map<Ogre::Entity *, Occludee>::iterator it = occludees_.find(entity);
+		bool culled = it != occludees_.end() && it->second.last_frame + 1 == frame_ && !it->second.visible;
+		if (culled){
+			num_culled_++;
+			if (flags & unoccluded_flag){
+				entity->removeVisibilityFlags(unoccluded_flag);
+			}
+		}
+		else if (!(flags & unoccluded_flag)){
+			entity->addVisibilityFlags(unoccluded_flag);
+		}
+	}
+}
+
+
+void OcclusionCuller::postViewportUpdate(const Ogre::RenderTargetViewportEvent &evt){
+
+	if (evt.source != viewport_){
+		return;
+	}
+
+	/* The occluders are in the depth buffer now; test the box of every other entity in view.
+	   isVisible() is not used, it applies the mask of the viewport being rendered */
+	num_tested_ = 0;
+	Ogre::Vector3 eye = camera_->getDerivedPosition();
+	Ogre::Vector3 margin(occlusion_near_margin_g*camera_->getNearClipDistance());
+	const Ogre::Matrix4 &view = camera_->getViewMatrix(true);
+	const Ogre::Matrix4 &projection = camera_->getProjectionMatrixRS();
+	render_system_->_setViewport(viewport_);
+	render_system_->_beginFrame();
+	Ogre::SceneManager::MovableObjectIterator entities = scene_manager_->getMovableObjectIterator("Entity");
+	while (entities.hasMoreElements()){
+		Ogre::Entity *entity = static_cast<Ogre::Entity *>(entities.getNext());
+		if (!entity->getVisible() || !entity->isInScene() || (entity->getVisibilityFlags() & occluder_flag)){
+			continue;
+		}
+		const Ogre::AxisAlignedBox &box = entity->getWorldBoundingBox(true);
+		if (!box.isFinite() || !camera_->isVisible(box)){
+			continue; // Frustum culling takes care of it
+		}
+		std::map<Ogre::Entity *, Occludee>::iterator it = occludees_.find(entity);
+		if (it == occludees_.end()){
+			Occludee occludee;
+			occludee.query = NULL;
+			occludee.issued = false;
+			occludee.visible = true;
+			it = occludees_.insert(std::make_pair(entity, occludee)).first;
+		}
+		Occludee &occludee = it->second;
+		occludee.last_frame = frame_;
+		num_tested_++;
+
+		if (Ogre::AxisAlignedBox(box.getMinimum() - margin, box.getMaximum() + margin).intersects(eye)){
+			occludee.visible = true;
+			continue;
+		}
+		if (occludee.issued){
+			continue; // The GPU is behind; ask again once it answered
+		}
+		if (!occludee.query){
+			if (free_queries_.empty()){
+				occludee.query = render_system_->createHardwareOcclusionQuery();
+			}
+			else {
+				occludee.query = free_queries_.back();
+				free_queries_.pop_back();
+			}
+		}
+
+		Ogre::Matrix4 world;
+		world.makeTransform(box.getCenter(), box.getSize(), Ogre::Quaternion::IDENTITY);
+		occludee.query->beginOcclusionQuery();
+		scene_manager_->manualRender(&box_operation_, box_pass_, viewport_, world, view, projection, false);
+		occludee.query->endOcclusionQuery();
+		occludee.issued = true;
+	}
+	render_system_->_endFrame();
+
+	/* Forget entities that left the view or were destroyed */
+	std::map<Ogre::Entity *, Occludee>::iterator it = occludees_.begin();
+	while (it != occludees_.end()){
+		if (it->second.last_frame != frame_){
+			ReleaseQuery(it->second);
+			occludees_.erase(it++);
+		}
+		else {
+			it++;
+		}
+	}
+}
+
+
+void OcclusionCuller::CreateBox(void){
+
+	/* Corner i has x, y and z of bit 0, 1 and 2 of i */
+	float positions[8*3];
+	for (int i = 0; i < 8; i++){
+		positions[3*i] = (i & 1) ? 0.5f : -0.5f;
+		positions[3*i + 1] = (i & 2) ? 0.5f : -0.5f;
+		positions[3*i + 2] = (i & 4) ? 0.5f : -0.5f;
+	}
+	const Ogre::uint16 indices[36] = {
+		0, 2, 6, 0, 6, 4,  1, 5, 7, 1, 7, 3,  // -x, +x
+		0, 4, 5, 0, 5, 1,  2, 3, 7, 2, 7, 6,  // -y, +y
+		0, 1, 3, 0, 3, 2,  4, 6, 7, 4, 7, 5   // -z, +z
+	};
+
+	Ogre::HardwareBufferManager &buffer_manager = Ogre::HardwareBufferManager::getSingleton();
+	Ogre::VertexData *vertex_data = new Ogre::VertexData();
+	vertex_data->vertexCount = 8;
+	vertex_data->vertexDeclaration->addElement(0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION);
+	Ogre::HardwareVertexBufferSharedPtr vertex_buffer = buffer_manager.createVertexBuffer(3*sizeof(float), 8, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	vertex_buffer->writeData(0, vertex_buffer->getSizeInBytes(), positions, true);
+	vertex_data->vertexBufferBinding->setBinding(0, vertex_buffer);
+
+	Ogre::IndexData *index_data = new Ogre::IndexData();
+	index_data->indexCount = 36;
+	index_data->indexBuffer = buffer_manager.createIndexBuffer(Ogre::HardwareIndexBuffer::IT_16BIT, 36, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	index_data->indexBuffer->writeData(0, index_data->indexBuffer->getSizeInBytes(), indices, true);
+
+	box_operation_.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
+	box_operation_.useIndexes = true;
+	box_operation_.vertexData = vertex_data;
+	box_operation_.indexData = index_data;
+}
+
+
+void OcclusionCuller::DestroyBox(void){
+
+	delete box_operation_.vertexData;
+	delete box_operation_.indexData;
+	box_operation_.vertexData = NULL;
+	box_operation_.indexData = NULL;
+}
+
+
+void OcclusionCuller::ReleaseQuery(Occludee &occludee){
+
+	/* A query still in flight can be reused; beginning it again drops the old result */
+	if (occludee.query){
+		free_queries_.push_back(occludee.query);
+	}
+	occludee.query = NULL;
+	occludee.issued = false;
+}
+
+
+void OcclusionCuller::ShowAll(void){
+
+	Ogre::SceneManager::MovableObjectIterator entities = scene_manager_->getMovableObjectIterator("Entity");
+	while (entities.hasMoreElements()){
+		entities.getNext()->addVisibilityFlags(unoccluded_flag);
+	}
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,92 @@
+#ifndef OCCLUSION_CULLER_H_
+#define OCCLUSION_CULLER_H_
+
+#include <map>
+#include <vector>
+
+#include "OGRE/OgreRenderSystem.h"
+#include "OGRE/OgreSceneManager.h"
+#include "OGRE/OgreCamera.h"
+#include "OGRE/OgreEntity.h"
+#include "OGRE/OgrePass.h"
+#include "OGRE/OgreTexture.h"
+#include "OGRE/OgreRenderOperation.h"
+#include "OGRE/OgreRenderTarget.h"
+#include "OGRE/OgreRenderTargetListener.h"
+#include "OGRE/OgreHardwareOcclusionQuery.h"
+
+namespace ogre_application {
+
+	/* Skips entities hidden behind a few large occluders */
+	/* The occluders are drawn into a small depth target from the main camera; then the
+	   bounding box of every other entity in view is drawn against that depth inside an
+	   occlusion query. Results are read back a frame later, never waited for, and an entity
+	   whose box passed no fragment loses a visibility flag that the scene manager's mask
+	   requires, so the main render skips it before any of its passes run. Entities show
+	   again a frame after their box becomes visible */
+	class OcclusionCuller : public Ogre::RenderTargetListener
+	{
+		public:
+			// Visibility flags used; every other entity gets all but the occluder flag
+			static const Ogre::uint32 occluder_flag = 1u << 30;
+			static const Ogre::uint32 unoccluded_flag = 1u << 31;
+
+			OcclusionCuller(void);
+			~OcclusionCuller(void);
+
+			// Call before creating entities; the depth target is width by height and follows camera
+			void Init(Ogre::RenderSystem *render_system, Ogre::SceneManager *scene_manager, Ogre::Camera *camera, const Ogre::String &resource_group_name, size_t width, size_t height);
+			void Shutdown(void);
+			void SetEnabled(bool enabled);
+			bool IsEnabled(void) const { return enabled_; }
+
+			// Draw the entity into the depth target; occluders are never culled themselves
+			void AddOccluder(Ogre::Entity *entity);
+			void RemoveOccluder(Ogre::Entity *entity);
+			int GetNumOccluders(void) const { return num_occluders_; }
+
+			Ogre::RenderTarget *GetTarget(void) const { return target_; }
+
+			// Of the last frame: entities in view that were tested, and those skipped
+			int GetNumTested(void) const { return num_tested_; }
+			int GetNumCulled(void) const { return num_culled_; }
+
+			virtual void preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+			virtual void postViewportUpdate(const Ogre::RenderTargetViewportEvent &evt);
+
+		private:
+			struct Occludee
+			{
+				Ogre::HardwareOcclusionQuery *query;
+				bool issued; // Result not read yet
+				bool visible;
+				unsigned long last_frame; // Last frame it was tested in
+			};
+
+			Ogre::RenderSystem *render_system_;
+			Ogre::SceneManager *scene_manager_;
+			Ogre::Camera *main_camera_;
+			Ogre::Camera *camera_; // Copy of the main camera for the depth target
+			Ogre::TexturePtr texture_;
+			Ogre::RenderTarget *target_;
+			Ogre::Viewport *viewport_;
+			Ogre::Pass *box_pass_;
+			Ogre::RenderOperation box_operation_; // Unit cube around the origin
+			bool enabled_;
+
+			std::map<Ogre::Entity *, Occludee> occludees_;
+			std::vector<Ogre::HardwareOcclusionQuery *> free_queries_;
+			unsigned long frame_;
+			int num_occluders_;
+			int num_tested_;
+			int num_culled_;
+
+			void CreateBox(void);
+			void DestroyBox(void);
+			void ReleaseQuery(Occludee &occludee);
+			void ShowAll(void);
+	};
+
+} // namespace ogre_application;
+
+#endif // OCCLUSION_CULLER_H_
@@ -1,921 +1,2239 @@
-#include "ogre_application.h"
-#include "bin/path_config.h"
-
-namespace ogre_application {
-
-/* Some configuration constants */
-/* They are written here as global variables, but ideally they should be loaded from a configuration file */
-
-/* Initialization */
-const Ogre::String config_filename_g = "";
-const Ogre::String plugins_filename_g = "";
-const Ogre::String log_filename_g = "Ogre.log";
-
-/* Main window settings */
-const Ogre::String window_title_g = "Demo";
-const Ogre::String custom_window_capacities_g = "";
-const unsigned int window_width_g = 800;
-const unsigned int window_height_g = 600;
-const bool window_full_screen_g = false;
-
-/* Viewport and camera settings */
-float viewport_width_g = 0.95f;
-float viewport_height_g = 0.95f;
-float viewport_left_g = (1.0f - viewport_width_g) * 0.5f;
-float viewport_top_g = (1.0f - viewport_height_g) * 0.5f;
-unsigned short viewport_z_order_g = 100;
-float camera_near_clip_distance_g = 0.01;
-float camera_far_clip_distance_g = 100.0;
-Ogre::Vector3 camera_position_g(0.5, 0.5, 1.5);
-Ogre::Vector3 camera_look_at_g(0.0, 0.0, 0.0);
-Ogre::Vector3 camera_up_g(0.0, 1.0, 0.0);
-const Ogre::ColourValue viewport_background_color_g(0.2, 0.2, 0.2);
-
-/* Materials */
-const Ogre::String material_directory_g = MATERIAL_DIRECTORY;
-
-
-OgreApplication::OgreApplication(void){
-
-    /* Don't do work in the constructor, leave it for the Init() function */
-}
-
-
-void OgreApplication::Init(void){
-
-	/* Set default values for the variables */
-	animating_ = false;
-	space_down_ = false;
-	effect = 0;
-	/* Run all initialization steps */
-    InitRootNode();
-    InitPlugins();
-    InitRenderSystem();
-    InitWindow();
-    InitViewport();
-	InitFrameListener();
-	InitOIS();
-	LoadMaterials();
-
-	InitCompositor();
-}
-
-
-void OgreApplication::InitRootNode(void){
-
-    try {
-		
-		/* We need to have an Ogre root to be able to access all Ogre functions */
-        ogre_root_ = std::auto_ptr<Ogre::Root>(new Ogre::Root(config_filename_g, plugins_filename_g, log_filename_g));
-		//ogre_root_->showConfigDialog();
-
-    }
-    catch (Ogre::Exception &e){
-		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-		throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::InitPlugins(void){
-
-    try {
-
-        Strings plugin_names;
-        plugin_names.push_back("RenderSystem_GL");
-		
-        Strings::iterator iter = plugin_names.begin();
-        Strings::iterator iter_end = plugin_names.end();
-        for (; iter != iter_end; iter++){
-            Ogre::String& plugin_name = (*iter);
-            if (OGRE_DEBUG_MODE){
-                plugin_name.append("_d");
-            }
-            ogre_root_->loadPlugin(plugin_name);
-        }
-
-    }
-    catch (Ogre::Exception &e){
-		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::InitRenderSystem(void){
-
-    try {
-
-        const Ogre::RenderSystemList& render_system_list = ogre_root_->getAvailableRenderers();
-        if (render_system_list.size() == 0)
-        {
-			throw(OgreAppException(std::string("OgreApp::Exception: Sorry, no rendersystem was found.")));
-        }
-
-        Ogre::RenderSystem *render_system = render_system_list.at(0);
-        ogre_root_->setRenderSystem(render_system);
-
-    }
-    catch (Ogre::Exception &e){
-		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-        
-void OgreApplication::InitWindow(void){
-
-    try {
-
-        /* Create main window for the application */
-		bool create_window_automatically = false;
-        ogre_root_->initialise(create_window_automatically, window_title_g, custom_window_capacities_g);
-
-        Ogre::NameValuePairList params;
-        params["FSAA"] = "0";
-        params["vsync"] = "true";
-        ogre_window_ = ogre_root_->createRenderWindow(window_title_g, window_width_g, window_height_g, window_full_screen_g, &params);
-
-        ogre_window_->setActive(true);
-        ogre_window_->setAutoUpdated(false);
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::InitViewport(void){
-
-    try {
-
-        /* Retrieve scene manager and root scene node */
-        Ogre::SceneManager* scene_manager = ogre_root_->createSceneManager(Ogre::ST_GENERIC, "MySceneManager");
-        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-        /* Create camera object */
-        camera_ = scene_manager->createCamera("MyCamera");
-        Ogre::SceneNode* camera_scene_node = root_scene_node->createChildSceneNode("MyCameraNode");
-        camera_scene_node->attachObject(camera_);
-
-        /* Create viewport */
-        Ogre::Viewport *viewport = ogre_window_->addViewport(camera_, viewport_z_order_g, viewport_left_g, viewport_top_g, viewport_width_g, viewport_height_g);
-
-        viewport->setAutoUpdated(true);
-        viewport->setBackgroundColour(viewport_background_color_g);
-
-        float ratio = float(viewport->getActualWidth()) / float(viewport->getActualHeight());
-        camera_->setAspectRatio(ratio);
-
-        camera_->setNearClipDistance(camera_near_clip_distance_g);
-        camera_->setFarClipDistance(camera_far_clip_distance_g); 
-
-		camera_->setPosition(Ogre::Vector3(0.5, 0.5, 1.5));
-		camera_->lookAt(Ogre::Vector3(0.0, 0.0, 0.0));
-		camera_->setFixedYawAxis(true, Ogre::Vector3(0.0, 1.0, 0.0));
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::InitFrameListener(void){
-
-	try {
-
-		/* Add this object as a FrameListener (see frameRenderingQueued event) */
-		ogre_root_->addFrameListener(this);
-
-	}
-    catch (Ogre::Exception &e){
-		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-		throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::InitOIS(void){
-
-	/* Initialize the Object Oriented Input System (OIS) */
-	try {
-
-		/* Initialize input manager */
-		OIS::ParamList pl; // Parameter list passed to the input manager initialization
-		size_t windowHnd = 0;
-		std::ostringstream windowHndStr;
-		ogre_window_->getCustomAttribute("WINDOW", &windowHnd);
-		windowHndStr << windowHnd;
-		pl.insert(std::make_pair(std::string("WINDOW"), windowHndStr.str()));
-		pl.insert(std::make_pair(std::string("w32_mouse"), 
-		std::string("DISCL_FOREGROUND" )));
-		pl.insert(std::make_pair(std::string("w32_mouse"), 
-		std::string("DISCL_NONEXCLUSIVE")));
-		input_manager_ = OIS::InputManager::createInputSystem(pl);
-
-		/*size_t hWnd = 0;
-		ogre_window_->getCustomAttribute("WINDOW", &hWnd);
-		input_manager_ = OIS::InputManager::createInputSystem(hWnd);*/
-
-		/* Initialize keyboard and mouse */
-		keyboard_ = static_cast<OIS::Keyboard*>(input_manager_->createInputObject(OIS::OISKeyboard, false));
-
-		mouse_ = static_cast<OIS::Mouse*>(input_manager_->createInputObject(OIS::OISMouse, false));
-		unsigned int width, height, depth;
-		int top, left;
-		ogre_window_->getMetrics(width, height, depth, left, top);
-		const OIS::MouseState &ms = mouse_->getMouseState();
-		ms.width = width;
-		ms.height = height;
-
-	}
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::LoadMaterials(void){
-
-    try {
-		
-		/* Load materials that can then be assigned to objects in the scene */
-		Ogre::String resource_group_name = "MyGame";
-		Ogre::ResourceGroupManager& resource_group_manager = Ogre::ResourceGroupManager::getSingleton();
-		resource_group_manager.createResourceGroup(resource_group_name);
-		bool is_recursive = false;
-		resource_group_manager.addResourceLocation(material_directory_g, "FileSystem", resource_group_name, is_recursive);
-		resource_group_manager.initialiseResourceGroup(resource_group_name);
-		resource_group_manager.loadResourceGroup(resource_group_name);
-
-	}
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::InitCompositor(void){
-
-	try{
-		
-		material_listener_.Init(this);
-
-		Ogre::CompositorInstance *inst = Ogre::CompositorManager::getSingleton().addCompositor(camera_->getViewport(), "ScreenSpaceEffect");
-		inst->addListener(&material_listener_);
-		inst->setEnabled(true);
-		//Ogre::CompositorManager::getSingleton().setCompositorEnabled(camera_->getViewport(), "ScreenSpaceEffect", true);
-		
-		elapsed_time_ = 0;
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::CreateTorusGeometry(Ogre::String object_name, float loop_radius, float circle_radius, int num_loop_samples, int num_circle_samples){
-
-    try {
-		/* Create a torus and add it to the resource list
-		   The torus is built from a large loop with small circles around the loop */
-
-        /* Retrieve scene manager and root scene node */
-        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
-        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-        /* Create the 3D object */
-        Ogre::ManualObject* object = NULL;
-        object = scene_manager->createManualObject(object_name);
-        object->setDynamic(false);
-
-        /* Create triangle list for the object */
-		object->begin("", Ogre::RenderOperation::OT_TRIANGLE_LIST);
-
-		/* Add vertices to the object */
-		float theta, phi; // Angles for circles
-		Ogre::Vector3 loop_center;
-		Ogre::Vector3 vertex_position;
-		Ogre::Vector3 vertex_normal;
-		Ogre::ColourValue vertex_color;
-				
-		for (int i = 0; i < num_loop_samples; i++){ // large loop
-			
-			theta = Ogre::Math::TWO_PI*i/num_loop_samples; // loop sample (angle theta)
-			loop_center = Ogre::Vector3(loop_radius*cos(theta), loop_radius*sin(theta), 0); // centre of a small circle
-
-			for (int j = 0; j < num_circle_samples; j++){ // small circle
-				
-				phi = Ogre::Math::TWO_PI*j/num_circle_samples; // circle sample (angle phi)
-				
-				/* Define position, normal and color of vertex */
-				vertex_normal = Ogre::Vector3(cos(theta)*cos(phi), sin(theta)*cos(phi), sin(phi));
-				vertex_position = loop_center + vertex_normal*circle_radius;
-				/*Ogre::Vector3(loop_center.x + local_normal.x*circle_radius, 
-				                loop_center.y + local_normal.y*circle_radius, 
-				     			loop_center.z + local_normal.z*circle_radius);*/
-				vertex_color = Ogre::ColourValue(1.0 - ((float) i / (float) num_loop_samples), 
-				                                 (float) i / (float) num_loop_samples, 
-				                                 (float) j / (float) num_circle_samples);
-
-				/* Add them to the object */
-				object->position(vertex_position);
-				object->normal(vertex_normal);
-				object->colour(vertex_color); 
-			}
-		}
-
-		/* Add triangles to the object */
-		for (int i = 0; i < num_loop_samples; i++){
-			for (int j = 0; j < num_circle_samples; j++){
-				// Two triangles per quad
-				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j, 
-							     i*num_circle_samples + ((j + 1) % num_circle_samples),
-								 i*num_circle_samples + j);
-				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j,
-					             ((i + 1) % num_loop_samples)*num_circle_samples + ((j + 1) % num_circle_samples),
-								 i*num_circle_samples + ((j + 1) % num_circle_samples));
-			}
-		}
-		
-		/* We finished the object */
-        object->end();
-		
-        /* Convert triangle list to a mesh */
-        object->convertToMesh(object_name);
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::CreateEntity(Ogre::String entity_name, Ogre::String object_name, Ogre::String material_name){
-
-	try {
-		/* Create one instance of the torus (one entity) */
-		/* The same object can have multiple instances or entities */
-
-		/* Retrieve scene manager and root scene node */
-        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
-        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-		/* Create entity */
-        Ogre::Entity* entity = scene_manager->createEntity(object_name);
-
-		/* Apply a material to the entity to give it color */
-		/* We already did that above, so we comment it out here */
-		entity->setMaterialName(material_name);
-		/* But, this call is useful if we have multiple entities with different materials */
-
-		/* Create a scene node for the entity */
-		/* The scene node keeps track of the entity's position */
-        Ogre::SceneNode* scene_node = root_scene_node->createChildSceneNode(entity_name);
-        scene_node->attachObject(entity);
-
-        /* Position and rotate the entity with the scene node */
-		//scene_node->rotate(Ogre::Vector3(0, 1, 0), Ogre::Degree(60));
-		//scene_node->rotate(Ogre::Vector3(1, 0, 0), Ogre::Degree(30));
-        //scene_node->translate(0.0, 0.0, 0.0);
-		scene_node->scale(0.5, 0.5, 0.5);
-
-	}
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::MainLoop(void){
-
-    try {
-
-        /* Main loop to keep the application going */
-
-        ogre_root_->clearEventTimes();
-
-        while(!ogre_window_->isClosed()){
-            ogre_window_->update(false);
-
-            ogre_window_->swapBuffers();
-
-            ogre_root_->renderOneFrame();
-
-            Ogre::WindowEventUtilities::messagePump();
-        }
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
-void OgreApplication::SetupAnimation(Ogre::String object_name){
-
-	/* Retrieve scene manager and root scene node */
-    Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
-	Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-	/* Set up animation */
-	Ogre::Real duration = Ogre::Math::TWO_PI;
-	Ogre::Real num_steps = 36;
-	Ogre::Real step = duration/num_steps;
-	Ogre::Animation* animation = scene_manager->createAnimation("Animation", duration);
-	animation->setInterpolationMode(Ogre::Animation::IM_LINEAR);
-	Ogre::Node *object_scene_node = root_scene_node->getChild(object_name);
-	Ogre::NodeAnimationTrack* track = animation->createNodeTrack(0, object_scene_node);
-	
-	/* Set up frames for animation */
-	Ogre::TransformKeyFrame* key;
-	Ogre::Quaternion quat;
-	Ogre::Matrix3 rot1, rot2, rot3;
-	rot1 = Ogre::Matrix3::IDENTITY;
-	for (int i = 0; i < num_steps; i++){
-		Ogre::Real current = ((float) i) * step;
-		key = track->createNodeKeyFrame(current);
-		//rot1.FromAngleAxis(Ogre::Vector3(1, 0, 0), Ogre::Degree(-90)); // Comment for Torus
-		rot2.FromAngleAxis(Ogre::Vector3(0, 1, 0), Ogre::Radian(-current));
-		rot3 = rot2 * rot1;
-		quat.FromRotationMatrix(rot3);
-		key->setRotation(quat);
-		key->setScale(Ogre::Vector3(0.8, 0.8, 0.8)); // Uncomment for Torus
-	}
-
-	/* Create animation state */
-	animation_state_ = scene_manager->createAnimationState("Animation");
-	animation_state_->setEnabled(true);
-	animation_state_->setLoop(true);
-
-	/* Turn on animating flag */
-	animating_ = true;
-}
-
-
-bool OgreApplication::frameEnded(const Ogre::FrameEvent &fe){
-
-	/* Render scene to texture before rendering the current scene */
-
-	return true;
-}
-
-
-bool OgreApplication::frameRenderingQueued(const Ogre::FrameEvent& fe){
-  
-	/* This event is called after a frame is queued for rendering */
-	/* Do stuff in this event since the GPU is rendering and the CPU is idle */
-
-	/* Keep animating if flag is on */
-	if (animating_){
-		animation_state_->addTime(fe.timeSinceLastFrame);
-	}
-
-	/* Capture input */
-	keyboard_->capture();
-	mouse_->capture();
-
-	/* Handle specific key events */
-	if (keyboard_->isKeyDown(OIS::KC_SPACE)){
-		space_down_ = true;
-	}
-	if ((!keyboard_->isKeyDown(OIS::KC_SPACE)) && space_down_){
-		animating_ = !animating_;
-		space_down_ = false;
-	}
-	if (keyboard_->isKeyDown(OIS::KC_ESCAPE)){
-		animation_state_->setTimePosition(0);
-	}
-	if (keyboard_->isKeyDown(OIS::KC_A)){
-		Ogre::MaterialPtr mPtr = Ogre::MaterialManager::getSingleton().getByName("ShinyBlueMaterial");
-		Ogre::GpuProgramParametersSharedPtr params = mPtr->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
-		params->setNamedConstant("type", 1);
-	}
-	if (keyboard_->isKeyDown(OIS::KC_Q)){
-		Ogre::MaterialPtr mPtr = Ogre::MaterialManager::getSingleton().getByName("ShinyBlueMaterial");
-		Ogre::GpuProgramParametersSharedPtr params = mPtr->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
-		params->setNamedConstant("type", 0);
-	}
-	if (keyboard_->isKeyDown(OIS::KC_B)){
-		effect = 1;
-	}
-	if (keyboard_->isKeyDown(OIS::KC_C)){
-		effect = 2;
-	}
-	if (keyboard_->isKeyDown(OIS::KC_D)){
-		effect = 3;
-	}
-	if (keyboard_->isKeyDown(OIS::KC_E)){
-		effect = 4;
-	}
-	if (keyboard_->isKeyDown(OIS::KC_F)){
-		effect = 5;
-	}
-	if (keyboard_->isKeyDown(OIS::KC_G)){
-		effect = 6;
-	}
- 
-	// Update time for compositor
-	elapsed_time_ += fe.timeSinceLastFrame;
-		
-    return true;
-}
-
-
-void MaterialListener::Init(OgreApplication *app){
-
-	app_ = app;
-}
-
-
-void MaterialListener::notifyMaterialSetup(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat){
-
-}
-
-
-void MaterialListener::notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat){
-
-	// Update compositor material parameters
-	Ogre::GpuProgramParametersSharedPtr params = mat->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
-	params->setNamedConstant("time", (float)(((int)(app_->elapsed_time_*100.0)) % app_->ogre_window_->getHeight()));
-	params->setNamedConstant("effect",app_-> effect);
-}
-
-void OgreApplication::CreateCylinder(void){
-
-	try {
-		/* Create a Cylinder */
-
-		/* Retrieve scene manager and root scene node */
-		Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
-		Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-		   Ogre::Real cylinder_start=-0.5f;
-		   Ogre::Real cylinder_length=1.0f;
-		   Ogre::Real cylinder_raduis=1.0f;
-		   const int cylinder_circle_resolution=120;
-		   int loop_count;
-
-		   Ogre::Degree theta =(Ogre::Degree)0;
-		   Ogre::Degree alpha =(Ogre::Degree)360/cylinder_circle_resolution;
-
-		   Ogre::Vector3 cylinder_circle1[cylinder_circle_resolution];
-		   Ogre::Vector3 cylinder_circle2[cylinder_circle_resolution];
-
-		   Ogre::Vector3  cylinder_circle1_center;
-		   Ogre::Vector3  cylinder_circle2_center;
-
-		   cylinder_circle1_center.x=-0.5;
-		   cylinder_circle1_center.y=cylinder_start;
-		   cylinder_circle1_center.z=0;
-
-		   cylinder_circle2_center.x=-0.5;
-		   cylinder_circle2_center.y=cylinder_start+cylinder_length;
-		   cylinder_circle2_center.z=0;
-
-		   for(int loop_count=0;loop_count<cylinder_circle_resolution;loop_count++)
-		   {
-			  theta=theta+alpha;
-			  cylinder_circle1[loop_count].x=cylinder_start;
-			  cylinder_circle1[loop_count].y=Ogre::Math::Sin(theta)*cylinder_raduis; 
-			  cylinder_circle1[loop_count].z=Ogre::Math::Cos(theta)*cylinder_raduis; 
-
-			  cylinder_circle2[loop_count].x=cylinder_start+cylinder_length;
-			  cylinder_circle2[loop_count].y=Ogre::Math::Sin(theta)*cylinder_raduis; 
-			  cylinder_circle2[loop_count].z=Ogre::Math::Cos(theta)*cylinder_raduis; 
-
-		   }
-
-		   	/* Create the 3D object */
-			Ogre::ManualObject* object = NULL;
-			Ogre::String object_name = "Cylinder";
-			object = scene_manager->createManualObject(object_name);
-			object->setDynamic(false);
-
-		   //////////////cylinder left circular base of circle//////////////////////////
-		   
-			/* Create triangle list for the object */
-		   Ogre::String material_name = "ShinyTextureMaterial";
-		   object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_FAN);
-		   object->colour(Ogre::ColourValue(0.0,0.0,1.0));
-		   object->position(cylinder_circle1_center);
-		   object->normal(-1,0,0);
-		   object->textureCoord(0.5,0.5);
-		   for( loop_count=0;loop_count<cylinder_circle_resolution;loop_count++)
-		   {
-			  object->position(cylinder_circle1[loop_count]);
-			  object->normal(-1,0,0);
-			  object->textureCoord(0,0.5);
-		   }
-		   object->position(cylinder_circle1[0]);
-		   object->normal(-1,0,0);
-		   object->textureCoord(0.5,0.5);
-		   object->end();
-
-		   //////////////cylinder curved surface//////////////////////////
-		   object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_LIST);
-		   object->colour(Ogre::ColourValue(0.2,0.6,0.5));
-
-		   for( loop_count=0;loop_count<cylinder_circle_resolution-1;loop_count++)
-		   {  
-			  object->position(cylinder_circle1[loop_count]);
-			  object->normal(0,cylinder_circle1[loop_count].y,cylinder_circle1[loop_count].z);
-			  object->textureCoord(loop_count/(cylinder_circle_resolution-1),0);
-			  object->position(cylinder_circle2[loop_count]);
-			  object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
-			  object->textureCoord(loop_count/(cylinder_circle_resolution-1),1);
-			  object->position(cylinder_circle1[loop_count+1]);
-			  object->normal(0,cylinder_circle1[loop_count+1].y,cylinder_circle1[loop_count+1].z);
-			  object->textureCoord((loop_count+1)/(cylinder_circle_resolution-1),0);
-
-			  object->position(cylinder_circle1[loop_count+1]);
-			  object->normal(0,cylinder_circle1[loop_count+1].y,cylinder_circle1[loop_count+1].z);
-			  object->textureCoord((loop_count+1)/(cylinder_circle_resolution-1),0);
-
-			  object->position(cylinder_circle2[loop_count]);
-			  object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
-			  object->textureCoord((loop_count)/(cylinder_circle_resolution-1),1);
-
-			  object->position(cylinder_circle2[loop_count+1]);
-			  object->normal(0,cylinder_circle2[loop_count+1].y,cylinder_circle2[loop_count+1].z);
-			  object->textureCoord((loop_count+1)/(cylinder_circle_resolution-1),1);
-
-
-		   }
-		   object->position(cylinder_circle1[loop_count]);
-		   object->normal(0,cylinder_circle1[loop_count].y,cylinder_circle1[loop_count].z);
-		   object->textureCoord((loop_count)/(cylinder_circle_resolution-1),0);
-
-		   object->position(cylinder_circle2[loop_count]);
-		   object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
-		   object->textureCoord((loop_count)/(cylinder_circle_resolution-1),1);
-
-		   object->position(cylinder_circle1[0]);
-		   object->normal(0,cylinder_circle1[0].y,cylinder_circle1[0].z);
-		   object->textureCoord((0)/(cylinder_circle_resolution-1),0);
-
-
-		   object->position(cylinder_circle1[0]);
-		   object->normal(0,cylinder_circle1[0].y,cylinder_circle1[0].z);
-		   object->textureCoord((0)/(cylinder_circle_resolution-1),0);
-
-		   object->position(cylinder_circle2[loop_count]);
-		   object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
-		   object->textureCoord((loop_count)/(cylinder_circle_resolution-1),1);
-
-		   object->position(cylinder_circle2[0]);
-		   object->normal(0,cylinder_circle2[0].y,cylinder_circle2[0].z);
-		   object->textureCoord((0)/(cylinder_circle_resolution-1),1);
-
-		   object->end();
-
-		   //////////////cylinder right circular base of circle//////////////////////////
-		   object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_FAN);
-		   object->colour(Ogre::ColourValue(0.0,0.0,1.0));
-		   object->position(cylinder_circle2_center);
-		   object->normal(1,0,0);
-		   object->textureCoord(0.5,0.5);
-
-		   for( loop_count=cylinder_circle_resolution-1;loop_count>0;--loop_count)
-		   {
-			  object->position(cylinder_circle2[loop_count]);
-			  object->normal(1,0,0);
-			  object->textureCoord(0.5,0.5);
-		   }
-		   object->position(cylinder_circle2[cylinder_circle_resolution-1]);
-		   object->normal(1,0,0);
-		   object->textureCoord(0.5,0.5);
-		   object->end();
-   
-		
-        /* Convert triangle list to a mesh */
-        Ogre::String mesh_name = "Cylinder";
-        object->convertToMesh(mesh_name);
-
-	}
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-void OgreApplication::CreateTorus(Ogre::String object_name, Ogre::String material_name, float loop_radius, float circle_radius, int num_loop_samples, int num_circle_samples){
-
-    try {
-		/* Create a torus
-		   The torus is built from a large loop with small circles around the loop */
-
-        /* Retrieve scene manager and root scene node */
-        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
-        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-        /* Create the 3D object */
-        Ogre::ManualObject* object = NULL;
-        object = scene_manager->createManualObject(object_name);
-        object->setDynamic(false);
-
-        /* Create triangle list for the object */
-		object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_LIST);
-
-		/* Add vertices to the object */
-		float theta, phi; // Angles for circles
-		Ogre::Vector3 loop_center;
-		Ogre::Vector3 vertex_position;
-		Ogre::Vector3 vertex_normal;
-		Ogre::ColourValue vertex_color;
-				
-		for (int i = 0; i < num_loop_samples; i++){ // large loop
-			
-			theta = Ogre::Math::TWO_PI*i/num_loop_samples; // loop sample (angle theta)
-			loop_center = Ogre::Vector3(loop_radius*cos(theta), loop_radius*sin(theta), 0); // centre of a small circle
-
-			for (int j = 0; j < num_circle_samples; j++){ // small circle
-				
-				phi = Ogre::Math::TWO_PI*j/num_circle_samples; // circle sample (angle phi)
-				
-				/* Define position, normal and color of vertex */
-				vertex_normal = Ogre::Vector3(cos(theta)*cos(phi), sin(theta)*cos(phi), sin(phi));
-				vertex_position = loop_center + vertex_normal*circle_radius;
-				/*Ogre::Vector3(loop_center.x + local_normal.x*circle_radius, 
-				                loop_center.y + local_normal.y*circle_radius, 
-				     			loop_center.z + local_normal.z*circle_radius);*/
-				vertex_color = Ogre::ColourValue(1.0 - ((float) i / (float) num_loop_samples), 
-				                                 (float) i / (float) num_loop_samples, 
-				                                 (float) j / (float) num_circle_samples);
-				/*vertex_color = Ogre::ColourValue(0.0, 0.0, 1.0);*/
-
-				/* Add them to the object */
-				object->position(vertex_position);
-				object->normal(vertex_normal);
-				object->colour(vertex_color); 
-				object->textureCoord(cos(theta),sin(phi));
-			}
-		}
-
-		/* Add triangles to the object */
-		for (int i = 0; i < num_loop_samples; i++){
-			for (int j = 0; j < num_circle_samples; j++){
-				// Two triangles per quad
-				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j, 
-							     i*num_circle_samples + ((j + 1) % num_circle_samples),
-								 i*num_circle_samples + j);
-				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j,
-					             ((i + 1) % num_loop_samples)*num_circle_samples + ((j + 1) % num_circle_samples),
-								 i*num_circle_samples + ((j + 1) % num_circle_samples));
-			}
-		}
-		
-		/* We finished the object */
-        object->end();
-		
-        /* Convert triangle list to a mesh */
-        object->convertToMesh(object_name);
-
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-void OgreApplication::CreateMultipleCylinders(void){
-
-	try {
-		/* Create multiple entities of a Cylinder */
-
-        /* Retrieve scene manager and root scene node */
-        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
-        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-		//create first cylinder which is called A as center
-		Ogre::Entity *entity0 = scene_manager->createEntity("Cylinder0", "Cylinder");
-		cylinder_[0] = root_scene_node->createChildSceneNode("Cylinder0",Ogre::Vector3( 0, 0, 0 ));
-		cylinder_[0]->attachObject(entity0);
-		cylinder_[0]->scale(4.0,0.25,0.25);
-		cylinder_[0]->translate(-2,0,-25);
-		cylinder_[0]->yaw(Ogre::Degree(-45));
-		//A left
-		Ogre::Entity *entity1 = scene_manager->createEntity("Cylinder1", "Cylinder");
-		cylinder_[1] = cylinder_[0]->createChildSceneNode("Cylinder1",Ogre::Vector3( -0.6, 0, 0 ));
-		cylinder_[1]->attachObject(entity1);
-		cylinder_[1]->scale(0.25,2,2);
-		//A right
-		Ogre::Entity *entity2 = scene_manager->createEntity("Cylinder2", "Cylinder");
-		cylinder_[2] = cylinder_[0]->createChildSceneNode("Cylinder2",Ogre::Vector3( 0.6, 0, 0 ));
-		cylinder_[2]->attachObject(entity2);
-		cylinder_[2]->scale(0.25,2,2);
-		//B left 1
-		Ogre::Entity *entity3 = scene_manager->createEntity("Cylinder3", "Cylinder");
-		cylinder_[3] = cylinder_[0]->createChildSceneNode("Cylinder3",Ogre::Vector3( -0.7, 0, 0 ));
-		cylinder_[3]->attachObject(entity3);		
-		cylinder_[3]->scale(0.5,0.2,0.2);
-		cylinder_[3]->roll(Ogre::Degree( 90 ) );
-
-		//B left 2
-		Ogre::Entity *entity4 = scene_manager->createEntity("Cylinder4", "Cylinder");
-		cylinder_[4] = cylinder_[0]->createChildSceneNode("Cylinder4",Ogre::Vector3( -0.7, 0, 0 ));
-		cylinder_[4]->attachObject(entity4);
-		cylinder_[4]->scale(0.5,0.2,0.2);
-		cylinder_[4]->yaw( Ogre::Degree( 90 ) );
-
-		//B right 1
-		Ogre::Entity *entity5 = scene_manager->createEntity("Cylinder5", "Cylinder");
-		cylinder_[5] = cylinder_[0]->createChildSceneNode("Cylinder5",Ogre::Vector3( 0.7, 0, 0 ));
-		cylinder_[5]->attachObject(entity5);		
-		cylinder_[5]->scale(0.5,0.2,0.2);
-		cylinder_[5]->roll( Ogre::Degree( 90 ) );
-
-		//B right 2
-		Ogre::Entity *entity6 = scene_manager->createEntity("Cylinder6", "Cylinder");
-		cylinder_[6] = cylinder_[0]->createChildSceneNode("Cylinder6",Ogre::Vector3( 0.7, 0, 0 ));
-		cylinder_[6]->attachObject(entity6);
-		cylinder_[6]->scale(0.5,0.2,0.2);
-		cylinder_[6]->yaw( Ogre::Degree( 90 ) );
-		/*
-		//cube
-		Ogre::Entity *entity7 = scene_manager->createEntity("Cylinder7", "Cylinder");
-		cylinder_[7] = cylinder_[0]->createChildSceneNode("Cylinder7",Ogre::Vector3( 0.0, 0, 0 ));
-		cylinder_[7]->attachObject(entity7);
-		cylinder_[7]->scale(0.5,15,10);
-		*/
-		
-		
-		
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-void OgreApplication::CreateMultipleTorus(void){
-
-	try {
-		/* Create multiple entities of a Cylinder */
-
-        /* Retrieve scene manager and root scene node */
-        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
-        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
-
-        /* Create multiple entities of the cube mesh */
-		Ogre::String entity_name, prefix("Torus");
-		for (int i = 0; i < NUM_ELEMENTS_TORUS; i++){
-			/* Create entity */
-			entity_name = prefix + Ogre::StringConverter::toString(i);
-			Ogre::Entity *entity = scene_manager->createEntity(entity_name, "Torus");
-
-			/* Create a scene node for the entity */
-			/* The scene node keeps track of the entity's position */
-			torus_[i] = cylinder_[0]->createChildSceneNode(entity_name);
-			torus_[i]->scale(0.5,10,1);
-			torus_[i]->attachObject(entity);
-		}
-		//setup torus
-		torus_[0]->translate(0.7, 0, 0);
-		torus_[0]->yaw(Ogre::Degree( 90 ));
-		torus_[1]->translate(-0.7, 0, 0);
-		torus_[1]->yaw(Ogre::Degree( 90 ));
-    }
-    catch (Ogre::Exception &e){
-        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
-    }
-    catch(std::exception &e){
-        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
-    }
-}
-
-
+#include <cmath>
+
+#include "ogre_application.h"
+#include "bin/path_config.h"
+
+namespace ogre_application {
+
+/* Some configuration constants */
+/* They are written here as global variables, but ideally they should be loaded from a configuration file */
+
+/* Initialization */
+const Ogre::String config_filename_g = "";
+const Ogre::String plugins_filename_g = "";
+const Ogre::String log_filename_g = "Ogre.log";
+
+/* Main window settings */
+const Ogre::String window_title_g = "Demo";
+const Ogre::String custom_window_capacities_g = "";
+const unsigned int window_width_g = 800;
+const unsigned int window_height_g = 600;
+const bool window_full_screen_g = false;
+
+/* Viewport and camera settings */
+float viewport_width_g = 0.95f;
+float viewport_height_g = 0.95f;
+float viewport_left_g = (1.0f - viewport_width_g) * 0.5f;
+float viewport_top_g = (1.0f - viewport_height_g) * 0.5f;
+unsigned short viewport_z_order_g = 100;
+float camera_near_clip_distance_g = 0.01;
+float camera_far_clip_distance_g = 100.0;
+Ogre::Vector3 camera_position_g(0.5, 0.5, 1.5);
+Ogre::Vector3 camera_look_at_g(0.0, 0.0, 0.0);
+Ogre::Vector3 camera_up_g(0.0, 1.0, 0.0);
+const Ogre::ColourValue viewport_background_color_g(0.2, 0.2, 0.2);
+
+/* Materials */
+const Ogre::String material_directory_g = MATERIAL_DIRECTORY;
+
+/* Textures that are replaced by a precompressed .dds next to them when one exists */
+/* Run TextureConverter on each of them to create the .dds files */
+const char *compressed_textures_g[] = { "earth.png", "images.jpg" };
+const int num_compressed_textures_g = 2;
+
+/* Lighting */
+/* The two lights the Shiny* shaders used to hardcode; each contributes half */
+const Ogre::Vector3 light_position_g(-0.5, -0.5, 1.5);
+const Ogre::Vector3 light_position2_g(0.5, 0.5, 1.5);
+const float default_light_radius_g = 100.0;
+const float default_light_intensity_g = 0.5;
+const int num_lighting_threads_g = 0; // 0 uses every core for light binning
+const int num_lights_per_key_press_g = 32; // Lights added with the L key
+
+/* Render path statistics */
+const float render_stats_interval_g = 1.0; // Seconds between log reports
+const int benchmark_warmup_frames_g = 30; // Frames skipped after switching paths
+/* Estimated framebuffer traffic, see OverdrawCounter */
+const size_t forward_bytes_per_fragment_g = 6 + 8; // Half-float colour write, depth read and write
+const size_t gbuffer_bytes_per_fragment_g = 16 + 4 + 4 + 8; // Three G-buffer writes, depth read and write
+const size_t lighting_bytes_per_pixel_g = 16 + 4 + 4 + 4; // Three G-buffer reads, colour write
+
+/* Frame capture */
+const int capture_ring_size_g = 3; // Frames between rendering and readback
+const Ogre::String capture_directory_g = "."; // Used by the P key
+
+/* Generated meshes are cached next to the materials */
+const MeshCache::Mode mesh_cache_mode_g = MeshCache::MODE_USE;
+/* Part of the cache keys; bump a generator's revision whenever its arithmetic changes,
+   so the meshes it cached before are made again */
+const int torus_geometry_revision_g = 2;
+const int cylinder_revision_g = 1;
+const int torus_revision_g = 2;
+/* Vertex format of generated meshes */
+const VertexLayout vertex_layout_g = VERTEX_LAYOUT_QUANTIZED;
+/* Largest decode errors of a compressed mesh that cannot be seen: a position error of a
+   hundred-thousandth of the mesh's diameter is far below a pixel at any distance the mesh
+   fills the screen from, a tenth of a degree moves N.L by less than half of an 8-bit step,
+   and a quarter texel of a 1024 texture samples the same texels */
+const float compression_position_tolerance_g = 1e-5;
+const float compression_normal_tolerance_g = 0.1;
+const float compression_uv_tolerance_g = 0.25/1024.0;
+/* Static batches are split into cubes of this size, in the space of the batch root */
+const float static_batch_region_size_g = 10.0;
+/* Bloom, see Bloom */
+const float bloom_threshold_g = 0.8;
+const float bloom_intensity_g = 0.6;
+const int bloom_levels_g = 5;
+/* Shockwaves spawned with the left mouse button */
+const float shockwave_speed_g = 0.5;
+const float shockwave_strength_g = 1.0;
+/* The occlusion depth buffer is this many times smaller than the window on each side */
+const unsigned int occlusion_target_divisor_g = 4;
+/* Seconds between steps of the simulation thread */
+const float simulation_step_g = 1.0/120.0;
+
+
+OgreApplication::OgreApplication(void){
+
+    /* Don't do work in the constructor, leave it for the Init() function */
+	/* Only options that have to be known before Init() get their default here */
+	benchmark_frames_ = 0;
+	capture_benchmark_frames_ = 0;
+	state_sorting_ = true;
+	occlusion_culling_ = true;
+	bloom_levels_ = bloom_levels_g;
+	bloom_.SetThreshold(bloom_threshold_g);
+	bloom_.SetIntensity(bloom_intensity_g);
+}
+
+
+void OgreApplication::Init(void){
+
+	/* Set default values for the variables */
+	animating_ = false;
+	animation_ = NULL;
+	threaded_ = false;
+	simulation_quit_ = false;
+	step_time_ = 0;
+	simulation_state_.sequence = 0;
+	simulation_state_.animation_time = 0;
+	simulation_state_.elapsed_time = 0;
+	simulation_state_.effect = 0;
+	simulation_state_.shading_type = -1;
+	simulation_state_.shockwaves.Clear();
+	simulation_state_.num_light_requests = 0;
+	simulation_state_.num_render_path_toggles = 0;
+	simulation_state_.num_capture_toggles = 0;
+	simulation_state_.num_static_batching_toggles = 0;
+	simulation_state_.num_memory_reports = 0;
+	simulation_state_.num_occlusion_toggles = 0;
+	applied_ = simulation_state_;
+	space_down_ = false;
+	l_down_ = false;
+	mouse_down_ = false;
+	r_down_ = false;
+	p_down_ = false;
+	s_down_ = false;
+	m_down_ = false;
+	o_down_ = false;
+	quit_ = false;
+	effect = 0;
+	deferred_shading_ = false;
+	deferred_instance_ = NULL;
+	screen_space_instance_ = NULL;
+	capture_instance_ = NULL;
+	scene_target_ = NULL;
+	static_batching_ = true;
+	stats_frames_ = 0;
+	stats_time_ = 0;
+	benchmark_frame_ = 0;
+	for (int i = 0; i < 2; i++){
+		benchmark_time_[i] = 0;
+		benchmark_fragments_[i] = 0;
+		benchmark_bandwidth_[i] = 0;
+		capture_benchmark_time_[i] = 0;
+	}
+	capture_benchmark_frame_ = 0;
+	mesh_cache_.Init(material_directory_g, mesh_cache_mode_g);
+	vertex_layout_ = vertex_layout_g;
+	num_compression_failures_ = 0;
+	/* Run all initialization steps */
+    InitRootNode();
+    InitPlugins();
+    InitRenderSystem();
+    InitWindow();
+    InitViewport();
+	InitFrameListener();
+	InitOIS();
+	LoadMaterials();
+
+	/* Before any entity is made, so that all of them can be culled */
+	occlusion_culler_.Init(ogre_root_->getRenderSystem(), ogre_root_->getSceneManager("MySceneManager"), camera_, "MyGame",
+		ogre_window_->getWidth()/occlusion_target_divisor_g, ogre_window_->getHeight()/occlusion_target_divisor_g);
+	occlusion_culler_.SetEnabled(occlusion_culling_);
+
+	InitCompositor();
+	static_batcher_.Init(ogre_root_->getSceneManager("MySceneManager"), "MyGame", static_batch_region_size_g, vertex_layout_);
+	/* Occluders must stay visible to be drawn into the occlusion depth */
+	static_batcher_.SetExcludedFlags(OcclusionCuller::occluder_flag);
+}
+
+
+void OgreApplication::InitRootNode(void){
+
+    try {
+		
+		/* We need to have an Ogre root to be able to access all Ogre functions */
+        ogre_root_ = std::auto_ptr<Ogre::Root>(new Ogre::Root(config_filename_g, plugins_filename_g, log_filename_g));
+
+		/* Opaque renderables are queued in groups of equal pass, ordered by the pass hash; */
+		/* hashing programs first, then textures, makes neighbouring groups share state. */
+		/* The hash is computed when a pass is created, so this has to precede the materials */
+		if (state_sorting_){
+			Ogre::Pass::setHashFunction(Ogre::Pass::MIN_GPU_PROGRAM_CHANGE);
+		}
+		else {
+			Ogre::Pass::setHashFunction(Ogre::Pass::MIN_TEXTURE_CHANGE);
+		}
+		//ogre_root_->showConfigDialog();
+
+    }
+    catch (Ogre::Exception &e){
+		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+		throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::InitPlugins(void){
+
+    try {
+
+        Strings plugin_names;
+        plugin_names.push_back("RenderSystem_GL");
+		
+        Strings::iterator iter = plugin_names.begin();
+        Strings::iterator iter_end = plugin_names.end();
+        for (; iter != iter_end; iter++){
+            Ogre::String& plugin_name = (*iter);
+            if (OGRE_DEBUG_MODE){
+                plugin_name.append("_d");
+            }
+            ogre_root_->loadPlugin(plugin_name);
+        }
+
+    }
+    catch (Ogre::Exception &e){
+		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::InitRenderSystem(void){
+
+    try {
+
+        const Ogre::RenderSystemList& render_system_list = ogre_root_->getAvailableRenderers();
+        if (render_system_list.size() == 0)
+        {
+			throw(OgreAppException(std::string("OgreApp::Exception: Sorry, no rendersystem was found.")));
+        }
+
+        Ogre::RenderSystem *render_system = render_system_list.at(0);
+        ogre_root_->setRenderSystem(render_system);
+
+    }
+    catch (Ogre::Exception &e){
+		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+        
+void OgreApplication::InitWindow(void){
+
+    try {
+
+        /* Create main window for the application */
+		bool create_window_automatically = false;
+        ogre_root_->initialise(create_window_automatically, window_title_g, custom_window_capacities_g);
+
+        Ogre::NameValuePairList params;
+        params["FSAA"] = "0";
+        params["vsync"] = (benchmark_frames_ > 0 || capture_benchmark_frames_ > 0) ? "false" : "true"; // Benchmarks measure unthrottled frames
+        ogre_window_ = ogre_root_->createRenderWindow(window_title_g, window_width_g, window_height_g, window_full_screen_g, &params);
+
+        ogre_window_->setActive(true);
+        ogre_window_->setAutoUpdated(false);
+    }
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::InitViewport(void){
+
+    try {
+
+        /* Retrieve scene manager and root scene node */
+        Ogre::SceneManager* scene_manager = ogre_root_->createSceneManager(Ogre::ST_GENERIC, "MySceneManager");
+        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+        /* Create camera object */
+        camera_ = scene_manager->createCamera("MyCamera");
+        Ogre::SceneNode* camera_scene_node = root_scene_node->createChildSceneNode("MyCameraNode");
+        camera_scene_node->attachObject(camera_);
+
+        /* Create viewport */
+        viewport_ = ogre_window_->addViewport(camera_, viewport_z_order_g, viewport_left_g, viewport_top_g, viewport_width_g, viewport_height_g);
+
+        viewport_->setAutoUpdated(true);
+        viewport_->setBackgroundColour(viewport_background_color_g);
+
+        float ratio = float(viewport_->getActualWidth()) / float(viewport_->getActualHeight());
+        camera_->setAspectRatio(ratio);
+
+        camera_->setNearClipDistance(camera_near_clip_distance_g);
+        camera_->setFarClipDistance(camera_far_clip_distance_g); 
+
+		camera_->setPosition(Ogre::Vector3(0.5, 0.5, 1.5));
+		camera_->lookAt(Ogre::Vector3(0.0, 0.0, 0.0));
+		camera_->setFixedYawAxis(true, Ogre::Vector3(0.0, 1.0, 0.0));
+    }
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::InitFrameListener(void){
+
+	try {
+
+		/* Add this object as a FrameListener (see frameRenderingQueued event) */
+		ogre_root_->addFrameListener(this);
+
+	}
+    catch (Ogre::Exception &e){
+		throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+		throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::InitOIS(void){
+
+	/* Initialize the Object Oriented Input System (OIS) */
+	try {
+
+		/* Initialize input manager */
+		OIS::ParamList pl; // Parameter list passed to the input manager initialization
+		size_t windowHnd = 0;
+		std::ostringstream windowHndStr;
+		ogre_window_->getCustomAttribute("WINDOW", &windowHnd);
+		windowHndStr << windowHnd;
+		pl.insert(std::make_pair(std::string("WINDOW"), windowHndStr.str()));
+		pl.insert(std::make_pair(std::string("w32_mouse"), 
+		std::string("DISCL_FOREGROUND" )));
+		pl.insert(std::make_pair(std::string("w32_mouse"), 
+		std::string("DISCL_NONEXCLUSIVE")));
+		input_manager_ = OIS::InputManager::createInputSystem(pl);
+
+		/*size_t hWnd = 0;
+		ogre_window_->getCustomAttribute("WINDOW", &hWnd);
+		input_manager_ = OIS::InputManager::createInputSystem(hWnd);*/
+
+		/* Initialize keyboard and mouse */
+		keyboard_ = static_cast<OIS::Keyboard*>(input_manager_->createInputObject(OIS::OISKeyboard, false));
+
+		mouse_ = static_cast<OIS::Mouse*>(input_manager_->createInputObject(OIS::OISMouse, false));
+		unsigned int width, height, depth;
+		int top, left;
+		ogre_window_->getMetrics(width, height, depth, left, top);
+		const OIS::MouseState &ms = mouse_->getMouseState();
+		ms.width = width;
+		ms.height = height;
+
+	}
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::LoadMaterials(void){
+
+    try {
+		
+		/* Load materials that can then be assigned to objects in the scene */
+		Ogre::String resource_group_name = "MyGame";
+		Ogre::ResourceGroupManager& resource_group_manager = Ogre::ResourceGroupManager::getSingleton();
+		resource_group_manager.createResourceGroup(resource_group_name);
+		bool is_recursive = false;
+		resource_group_manager.addResourceLocation(material_directory_g, "FileSystem", resource_group_name, is_recursive);
+		LoadCompressedTextures(resource_group_name);
+		InitLighting(resource_group_name);
+		resource_group_manager.initialiseResourceGroup(resource_group_name);
+		resource_group_manager.loadResourceGroup(resource_group_name);
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::LoadCompressedTextures(Ogre::String resource_group_name){
+
+	/* Create the textures under their original names before the materials are parsed,
+	   so the materials pick up the compressed versions instead of decoding the images */
+	bool hardware_bc1 = ogre_root_->getRenderSystem()->getCapabilities()->hasCapability(Ogre::RSC_TEXTURE_COMPRESSION_DXT);
+
+	for (int i = 0; i < num_compressed_textures_g; i++){
+		Ogre::String texture_name = compressed_textures_g[i];
+		Ogre::String dds_file_name = material_directory_g + "/" + TextureCompression::GetCompressedFileName(texture_name);
+
+		/* Without a .dds file the material falls back to decoding the original image */
+		MappedFile file;
+		if (!file.Open(dds_file_name)){
+			continue;
+		}
+		DdsTexture dds;
+		if (!dds.Parse(file.GetData(), file.GetSize())){
+			Ogre::LogManager::getSingleton().logMessage("Ignoring " + dds_file_name + ": not a BC1 texture.");
+			continue;
+		}
+		Ogre::uint8 num_mipmaps = (Ogre::uint8) (dds.GetNumLevels() - 1);
+
+		/* The image wraps the mapped mip chain directly, it does not copy or free it */
+		Ogre::Image image;
+		std::vector<unsigned char> decoded_chain;
+		if (hardware_bc1){
+			image.loadDynamicImage(const_cast<Ogre::uchar *>(dds.GetLevel(0).data), dds.GetWidth(), dds.GetHeight(), 1, Ogre::PF_DXT1, false, 1, num_mipmaps);
+		}
+		else {
+			/* Software decode fallback for render systems without BC1 support */
+			RgbaImage decoded;
+			for (size_t level = 0; level < dds.GetNumLevels(); level++){
+				const CompressedLevel &compressed_level = dds.GetLevel(level);
+				TextureCompression::DecodeBc1(compressed_level.data, compressed_level.width, compressed_level.height, decoded);
+				decoded_chain.insert(decoded_chain.end(), decoded.pixels.begin(), decoded.pixels.end());
+			}
+			image.loadDynamicImage(&decoded_chain[0], dds.GetWidth(), dds.GetHeight(), 1, Ogre::PF_BYTE_RGBA, false, 1, num_mipmaps);
+		}
+
+		Ogre::TextureManager::getSingleton().loadImage(texture_name, resource_group_name, image, Ogre::TEX_TYPE_2D, num_mipmaps);
+	}
+}
+
+
+void OgreApplication::InitLighting(Ogre::String resource_group_name){
+
+	/* The light textures have to exist before the materials that sample them are loaded */
+	clustered_lighting_.Init(resource_group_name, num_lighting_threads_g);
+	clustered_lighting_.AddMaterial("ShinyBlueMaterial");
+	clustered_lighting_.AddMaterial("ShinyTextureMaterial");
+	clustered_lighting_.AddMaterial("ShinyTexture2Material");
+	clustered_lighting_.AddMaterial("DeferredLightingMaterial");
+
+	AddPointLight(light_position_g, default_light_radius_g, Ogre::ColourValue::White, default_light_intensity_g);
+	AddPointLight(light_position2_g, default_light_radius_g, Ogre::ColourValue::White, default_light_intensity_g);
+}
+
+
+int OgreApplication::AddPointLight(Ogre::Vector3 position, float radius, Ogre::ColourValue colour, float intensity){
+
+	return clustered_lighting_.AddLight(position, radius, colour, intensity);
+}
+
+
+void OgreApplication::RemovePointLight(int light_id){
+
+	clustered_lighting_.RemoveLight(light_id);
+}
+
+
+void OgreApplication::SetPointLightPosition(int light_id, Ogre::Vector3 position){
+
+	clustered_lighting_.GetLight(light_id).position = position;
+}
+
+
+void OgreApplication::InitCompositor(void){
+
+	try{
+		
+		material_listener_.Init(this);
+
+		/* Deferred shading comes first in the chain so ScreenSpaceEffect post-processes its output */
+		deferred_instance_ = Ogre::CompositorManager::getSingleton().addCompositor(viewport_, "DeferredShading");
+		deferred_instance_->setEnabled(deferred_shading_);
+
+		/* The bloom chain goes into ScreenSpaceEffect, before it is instantiated */
+		bloom_.Init("ScreenSpaceEffect", "rt0", bloom_levels_);
+
+		Ogre::CompositorInstance *inst = Ogre::CompositorManager::getSingleton().addCompositor(viewport_, "ScreenSpaceEffect");
+		inst->addListener(&material_listener_);
+		inst->addListener(&bloom_);
+		inst->setEnabled(true);
+		//Ogre::CompositorManager::getSingleton().setCompositorEnabled(camera_->getViewport(), "ScreenSpaceEffect", true);
+		screen_space_instance_ = inst;
+
+		/* Last in the chain so it sees the final image; only enabled while capturing */
+		capture_instance_ = Ogre::CompositorManager::getSingleton().addCompositor(viewport_, "FrameCapture");
+		capture_instance_->setEnabled(false);
+		frame_capture_.Init(ogre_root_->getRenderSystem(), ogre_root_->getSceneManager("MySceneManager"), "MyGame", capture_ring_size_g);
+
+		effect_graph_.Init("MyGame");
+
+		/* Estimated cost of the bloom chain at the window size and common resolutions */
+		if (bloom_.GetNumLevels() > 0){
+			size_t widths[] = {viewport_->getActualWidth(), 1280, 1920, 3840};
+			size_t heights[] = {viewport_->getActualHeight(), 720, 1080, 2160};
+			for (int i = 0; i < 4; i++){
+				BloomCost cost = bloom_.GetCost(widths[i], heights[i]);
+				std::ostringstream report;
+				report << "Bloom at " << widths[i] << "x" << heights[i] << ": " << bloom_.GetNumLevels() << " levels, "
+				       << cost.pixels_written/1.0e6 << " Mpixels written, " << cost.texture_fetches/1.0e6 << " M fetches (25-tap blur: "
+				       << cost.blur_texture_fetches/1.0e6 << " M), ~" << cost.bytes/(1024.0*1024.0) << " MB/frame";
+				Ogre::LogManager::getSingleton().logMessage(report.str());
+			}
+		}
+
+		/* After the main chain, so views find its scene rendered when they are drawn; a
+		   view with a camera of its own needs the lights binned for it */
+		multi_view_.Init(ogre_root_->getSceneManager("MySceneManager"), ogre_window_, viewport_, screen_space_instance_, viewport_z_order_g + 1);
+		multi_view_.SetMainQueueShared(!deferred_shading_);
+		multi_view_.SetCameraHandler([this](Ogre::Camera *camera){ clustered_lighting_.Update(camera); });
+
+		InitOverdrawCounters();
+		render_counters_.Init(ogre_root_->getSceneManager("MySceneManager"));
+		InitRenderCounters();
+		
+		elapsed_time_ = 0;
+    }
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::InitOverdrawCounters(void){
+
+	/* Compositor textures are recreated whenever the chain changes, so attach again each time */
+	scene_counter_.Init(ogre_root_->getRenderSystem(), screen_space_instance_->getRenderTarget("rt0"), forward_bytes_per_fragment_g, 0);
+	scene_counter_.SetEnabled(!deferred_shading_);
+	scene_target_ = deferred_shading_ ? deferred_instance_->getRenderTarget("gbuffer") : screen_space_instance_->getRenderTarget("rt0");
+
+	if (deferred_shading_){
+		gbuffer_counter_.Init(ogre_root_->getRenderSystem(), deferred_instance_->getRenderTarget("gbuffer"), gbuffer_bytes_per_fragment_g, lighting_bytes_per_pixel_g);
+	}
+}
+
+
+void OgreApplication::ShutdownOverdrawCounters(void){
+
+	/* Before the chain changes: disabling a compositor destroys the targets they listen to */
+	scene_counter_.Shutdown();
+	gbuffer_counter_.Shutdown();
+	scene_target_ = NULL;
+}
+
+
+void OgreApplication::InitRenderCounters(void){
+
+	/* Count each target of the enabled compositors on its own; like the overdraw */
+	/* counters, this has to be redone whenever the chain changes. The old targets go */
+	/* with render_counters_.ClearTargets() before the change, while they still exist */
+	Ogre::CompositorChain *chain = Ogre::CompositorManager::getSingleton().getCompositorChain(viewport_);
+	for (size_t i = 0; i < chain->getNumCompositors(); i++){
+		Ogre::CompositorInstance *inst = chain->getCompositor(i);
+		if (!inst->getEnabled()){
+			continue;
+		}
+		Ogre::CompositionTechnique::TextureDefinitionIterator it = inst->getTechnique()->getTextureDefinitionIterator();
+		while (it.hasMoreElements()){
+			Ogre::CompositionTechnique::TextureDefinition *def = it.getNext();
+			if (def->refCompName.empty()){
+				render_counters_.AddTarget(inst->getRenderTarget(def->name), inst->getCompositor()->getName() + "/" + def->name);
+			}
+		}
+	}
+	if (occlusion_culler_.GetTarget()){
+		render_counters_.AddTarget(occlusion_culler_.GetTarget(), "occlusion");
+	}
+	for (int i = 0; i < multi_view_.GetNumViews(); i++){
+		if (multi_view_.GetSceneTarget(i)){
+			render_counters_.AddTarget(multi_view_.GetSceneTarget(i), "view" + Ogre::StringConverter::toString(i) + "/rt0");
+		}
+	}
+}
+
+
+void OgreApplication::SetRenderPath(bool deferred){
+
+	try {
+
+		ShutdownOverdrawCounters();
+		render_counters_.ClearTargets();
+		deferred_shading_ = deferred;
+		deferred_instance_->setEnabled(deferred_shading_);
+		multi_view_.SetMainQueueShared(!deferred_shading_);
+		InitOverdrawCounters();
+		InitRenderCounters();
+		stats_frames_ = 0;
+		stats_time_ = 0;
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::SetBenchmark(int num_frames){
+
+	benchmark_frames_ = num_frames;
+}
+
+
+void OgreApplication::SetCaptureBenchmark(int num_frames){
+
+	capture_benchmark_frames_ = num_frames;
+}
+
+
+void OgreApplication::SetStateSorting(bool sort){
+
+	state_sorting_ = sort;
+}
+
+
+void OgreApplication::SetOcclusionCulling(bool cull){
+
+	occlusion_culling_ = cull;
+	occlusion_culler_.SetEnabled(cull);
+}
+
+
+void OgreApplication::AddOccluder(Ogre::String node_name){
+
+	try {
+		Ogre::SceneNode *node = ogre_root_->getSceneManager("MySceneManager")->getSceneNode(node_name);
+		Ogre::SceneNode::ObjectIterator it = node->getAttachedObjectIterator();
+		while (it.hasMoreElements()){
+			Ogre::MovableObject *object = it.getNext();
+			if (object->getMovableType() == "Entity"){
+				occlusion_culler_.AddOccluder(static_cast<Ogre::Entity *>(object));
+			}
+		}
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::SetBloom(float threshold, float intensity, int num_levels){
+
+	bloom_.SetThreshold(threshold);
+	bloom_.SetIntensity(intensity);
+	bloom_levels_ = num_levels;
+}
+
+
+void OgreApplication::SpawnShockwave(Ogre::Vector2 centre, float speed, float strength){
+
+	/* Picked up by the next simulation step, on whichever thread that runs */
+	Shockwave wave;
+	wave.centre = centre;
+	wave.speed = speed;
+	wave.strength = strength;
+	wave.age = 0;
+	std::lock_guard<std::mutex> lock(shockwave_mutex_);
+	shockwave_events_.push_back(wave);
+}
+
+
+void OgreApplication::SetThreaded(bool threaded){
+
+	threaded_ = threaded;
+}
+
+
+void OgreApplication::RecordInput(Ogre::String file_name){
+
+	try {
+		input_recorder_.Open(file_name);
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::ReplayInput(Ogre::String file_name){
+
+	try {
+		input_replay_.Open(file_name);
+		std::ostringstream report;
+		report << "Replaying " << input_replay_.GetNumSteps() << " steps of input from " << file_name;
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::SetFrameTrace(Ogre::String file_name){
+
+	try {
+		frame_trace_.Open(file_name);
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::StartCapture(Ogre::String directory, int subsample, const Ogre::Box &region){
+
+	try {
+
+		render_counters_.ClearTargets();
+		capture_instance_->setEnabled(true);
+		frame_capture_.Start(capture_instance_->getTextureInstance("capture", 0), region, subsample, FrameCapture::CreateFileWriter(directory, "frame"));
+		InitRenderCounters();
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::StopCapture(void){
+
+	try {
+
+		if (!frame_capture_.IsCapturing()){
+			return;
+		}
+		frame_capture_.Stop();
+		render_counters_.ClearTargets();
+		capture_instance_->setEnabled(false);
+		InitRenderCounters();
+
+		std::ostringstream report;
+		report << "Frame capture: " << frame_capture_.GetNumCaptured() << " frames written, " << frame_capture_.GetNumDropped() << " dropped";
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::SetEffectChain(const std::vector<Ogre::String> &chain){
+
+	try {
+
+		Ogre::CompositorManager &compositor_manager = Ogre::CompositorManager::getSingleton();
+		Ogre::Viewport *viewport = viewport_;
+		render_counters_.ClearTargets();
+		if (!effect_chain_name_.empty()){
+			compositor_manager.removeCompositor(viewport, effect_chain_name_);
+			effect_chain_name_ = "";
+		}
+		if (chain.empty()){
+			InitRenderCounters();
+			return;
+		}
+
+		/* Goes right before FrameCapture, the last compositor */
+		effect_chain_name_ = effect_graph_.Compile(chain);
+		int position = (int) compositor_manager.getCompositorChain(viewport)->getNumCompositors() - 1;
+		Ogre::CompositorInstance *inst = compositor_manager.addCompositor(viewport, effect_chain_name_, position);
+		inst->addListener(&material_listener_);
+		inst->setEnabled(true);
+		effect = 0; // ScreenSpaceEffect only copies
+		InitRenderCounters();
+
+		std::ostringstream report;
+		report << "Effect chain";
+		for (size_t i = 0; i < chain.size(); i++){
+			report << " " << chain[i];
+		}
+		report << ": " << chain.size() << " stages in " << effect_graph_.GetNumFusedPasses(chain) << " passes, saves ~"
+		       << effect_graph_.GetBandwidthSaved(chain, viewport->getActualWidth(), viewport->getActualHeight())/(1024.0*1024.0)
+		       << " MB/frame of full-screen reads and writes";
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::UpdateRenderStats(float frame_time){
+
+	const OverdrawCounter &counter = deferred_shading_ ? gbuffer_counter_ : scene_counter_;
+
+	/* Report averaged frame time and the latest counters once per interval */
+	stats_frames_++;
+	stats_time_ += frame_time;
+	if (stats_time_ >= render_stats_interval_g){
+		std::ostringstream report;
+		report << (deferred_shading_ ? "Deferred" : "Forward") << ": "
+		       << 1000.0*stats_time_/stats_frames_ << " ms/frame, "
+		       << counter.GetFragments() << " fragments shaded, "
+		       << counter.GetOverdraw() << "x overdraw, ~"
+		       << counter.GetBandwidth()/(1024.0*1024.0) << " MB/frame framebuffer traffic, "
+		       << scene_target_->getBatchCount() << " scene draw calls";
+		if (static_batching_ && !static_nodes_.empty()){
+			report << " (" << static_batcher_.GetNumSourceDrawCalls() << " static draw calls batched into " << static_batcher_.GetNumBatchedDrawCalls() << ")";
+		}
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+
+		/* State changes of the last frame; what no compositor target took went to the window */
+		const RenderCounts &frame = render_counters_.GetFrameCounts();
+		RenderCounts output = frame;
+		std::ostringstream counts;
+		counts << "Render state (" << (state_sorting_ ? "sorted by program" : "sorted by texture") << "): "
+		       << frame.program_binds << " program binds, " << frame.texture_binds << " texture binds, "
+		       << frame.uniform_uploads << " uniform uploads, " << frame.draw_calls << " draw calls per frame";
+		for (int i = 0; i < render_counters_.GetNumTargets(); i++){
+			const RenderCounts &target = render_counters_.GetTargetCounts(i);
+			counts << "; " << render_counters_.GetTargetName(i) << ": " << target.program_binds << "/" << target.texture_binds
+			       << "/" << target.uniform_uploads << "/" << target.draw_calls;
+			output.program_binds -= target.program_binds;
+			output.texture_binds -= target.texture_binds;
+			output.uniform_uploads -= target.uniform_uploads;
+			output.draw_calls -= target.draw_calls;
+		}
+		counts << "; output: " << output.program_binds << "/" << output.texture_binds << "/" << output.uniform_uploads << "/" << output.draw_calls;
+		Ogre::LogManager::getSingleton().logMessage(counts.str());
+
+		if (occlusion_culling_){
+			std::ostringstream culling;
+			culling << "Occlusion culling: " << occlusion_culler_.GetNumCulled() << " of " << occlusion_culler_.GetNumTested()
+			        << " entities in view culled behind " << occlusion_culler_.GetNumOccluders() << " occluders";
+			Ogre::LogManager::getSingleton().logMessage(culling.str());
+		}
+
+		if (multi_view_.GetNumViews() > 0){
+			int num_shared_targets = 0;
+			for (int i = 0; i < multi_view_.GetNumViews(); i++){
+				num_shared_targets += (multi_view_.GetSharing(i) == VIEW_SHARES_TARGET) ? 1 : 0;
+			}
+			std::ostringstream views;
+			views << "Views: " << multi_view_.GetNumViews() + 1 << " views, " << num_shared_targets << " reusing the main scene target, "
+			      << multi_view_.GetNumSceneRenders() << " more scene passes, " << multi_view_.GetNumSharedCulls() << " of them without a cull of their own";
+			Ogre::LogManager::getSingleton().logMessage(views.str());
+		}
+
+		/* Keep the peaks of the sampled memory categories up to date */
+		memory_stats_.Sample(ogre_root_->getSceneManager("MySceneManager"));
+		stats_frames_ = 0;
+		stats_time_ = 0;
+	}
+
+	if (benchmark_frames_ > 0){
+		UpdateBenchmark(frame_time);
+	}
+	if (capture_benchmark_frames_ > 0){
+		UpdateCaptureBenchmark(frame_time);
+	}
+}
+
+
+void OgreApplication::UpdateBenchmark(float frame_time){
+
+	/* Forward first, then deferred, each after a few warm-up frames */
+	int path = benchmark_frame_/(benchmark_warmup_frames_g + benchmark_frames_);
+	int frame = benchmark_frame_ % (benchmark_warmup_frames_g + benchmark_frames_);
+	benchmark_frame_++;
+
+	if (frame >= benchmark_warmup_frames_g){
+		const OverdrawCounter &counter = (path == 1) ? gbuffer_counter_ : scene_counter_;
+		benchmark_time_[path] += frame_time;
+		benchmark_fragments_[path] += counter.GetFragments();
+		benchmark_bandwidth_[path] += counter.GetBandwidth();
+	}
+
+	if (frame == benchmark_warmup_frames_g + benchmark_frames_ - 1){
+		if (path == 0){
+			SetRenderPath(true);
+			return;
+		}
+
+		std::ostringstream report;
+		report << "Render path benchmark (" << benchmark_frames_ << " frames each)" << std::endl;
+		for (int i = 0; i < 2; i++){
+			report << "  " << (i == 0 ? "forward:  " : "deferred: ")
+			       << 1000.0*benchmark_time_[i]/benchmark_frames_ << " ms/frame, "
+			       << benchmark_fragments_[i]/benchmark_frames_ << " fragments shaded, ~"
+			       << benchmark_bandwidth_[i]/benchmark_frames_/(1024.0*1024.0) << " MB/frame framebuffer traffic" << std::endl;
+		}
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+		std::cout << report.str();
+		quit_ = true;
+	}
+}
+
+
+void OgreApplication::UpdateCaptureBenchmark(float frame_time){
+
+	/* Without capture first, then with it, each after a few warm-up frames */
+	int phase = capture_benchmark_frame_/(benchmark_warmup_frames_g + capture_benchmark_frames_);
+	int frame = capture_benchmark_frame_ % (benchmark_warmup_frames_g + capture_benchmark_frames_);
+	capture_benchmark_frame_++;
+
+	if (frame >= benchmark_warmup_frames_g){
+		capture_benchmark_time_[phase] += frame_time;
+	}
+
+	if (frame == benchmark_warmup_frames_g + capture_benchmark_frames_ - 1){
+		if (phase == 0){
+			/* Read every frame back but write nothing, so the disk does not count */
+			render_counters_.ClearTargets();
+			capture_instance_->setEnabled(true);
+			frame_capture_.Start(capture_instance_->getTextureInstance("capture", 0), Ogre::Box(), 1, FrameCapture::FrameHandler());
+			InitRenderCounters();
+			return;
+		}
+
+		double off = 1000.0*capture_benchmark_time_[0]/capture_benchmark_frames_;
+		double on = 1000.0*capture_benchmark_time_[1]/capture_benchmark_frames_;
+		std::ostringstream report;
+		report << "Frame capture benchmark (" << capture_benchmark_frames_ << " frames each)" << std::endl
+		       << "  capture off: " << off << " ms/frame" << std::endl
+		       << "  capture on:  " << on << " ms/frame, "
+		       << frame_capture_.GetNumCaptured() << " frames read back, " << frame_capture_.GetNumDropped() << " dropped" << std::endl
+		       << "  overhead:    " << on - off << " ms/frame (" << ((off > 0.0) ? 100.0*(on - off)/off : 0.0) << "%)" << std::endl;
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+		std::cout << report.str();
+		StopCapture();
+		quit_ = true;
+	}
+}
+
+
+void OgreApplication::SetMeshCacheMode(MeshCache::Mode mode){
+
+	mesh_cache_.Init(material_directory_g, mode);
+}
+
+
+void OgreApplication::SetVertexLayout(VertexLayout layout){
+
+	vertex_layout_ = layout;
+	static_batcher_.SetVertexLayout(layout);
+}
+
+
+void OgreApplication::LoadScene(Ogre::String file_name, bool mark_static){
+
+	try {
+
+		Ogre::SceneManager *scene_manager = ogre_root_->getSceneManager("MySceneManager");
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		scene_file_.Load(file_name, scene_manager, scene_manager->getRootSceneNode());
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::ostringstream report;
+		report << "Scene " << file_name << ": " << scene_file_.GetNumNodes() << " nodes and " << scene_file_.GetNumEntities() << " entities loaded in "
+		       << 1000.0*seconds << " ms";
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+
+		/* Occluders first, so that they stay out of the batches */
+		const std::vector<int> &occluders = scene_file_.GetOccluders();
+		for (size_t i = 0; i < occluders.size(); i++){
+			occlusion_culler_.AddOccluder(scene_file_.GetEntity(occluders[i]));
+		}
+		const std::vector<std::pair<int, float> > &static_roots = scene_file_.GetStaticRoots();
+		for (size_t i = 0; mark_static && i < static_roots.size(); i++){
+			/* Ogre names the unnamed nodes itself */
+			MarkStatic(scene_file_.GetNode(static_roots[i].first)->getName(), static_roots[i].second);
+		}
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::SaveScene(Ogre::String file_name, Ogre::String node_name, bool node_static, float region_size){
+
+	try {
+
+		SceneFile::Save(file_name, ogre_root_->getSceneManager("MySceneManager")->getSceneNode(node_name), node_static, region_size);
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::GenerateScene(Ogre::String file_name, int num_nodes){
+
+	try {
+
+		Strings mesh_names;
+		mesh_names.push_back("Cylinder");
+		mesh_names.push_back("Torus");
+		SceneFile::SaveGrid(file_name, mesh_names, num_nodes);
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::MarkStatic(Ogre::String node_name, float region_size){
+
+	try {
+
+		Ogre::SceneNode *node = ogre_root_->getSceneManager("MySceneManager")->getSceneNode(node_name);
+		if (std::find(static_nodes_.begin(), static_nodes_.end(), node_name) == static_nodes_.end()){
+			static_nodes_.push_back(node_name);
+		}
+		if (region_size > 0.0){
+			/* Also used when batching is turned on later */
+			static_batcher_.SetRegionSize(node, region_size);
+		}
+		if (!static_batching_){
+			return;
+		}
+		static_batcher_.MarkStatic(node);
+
+		std::ostringstream report;
+		report << "Static batching of " << node_name << ": " << static_batcher_.GetNumSourceDrawCalls() << " draw calls merged into " << static_batcher_.GetNumBatchedDrawCalls();
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::RebuildStatic(Ogre::String node_name){
+
+	try {
+
+		static_batcher_.Rebuild(ogre_root_->getSceneManager("MySceneManager")->getSceneNode(node_name));
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::UnmarkStatic(Ogre::String node_name){
+
+	try {
+
+		static_batcher_.Unmark(ogre_root_->getSceneManager("MySceneManager")->getSceneNode(node_name));
+		static_nodes_.erase(std::remove(static_nodes_.begin(), static_nodes_.end(), node_name), static_nodes_.end());
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::CompressMesh(const Ogre::MeshPtr &mesh){
+
+	VertexCompressionStats stats;
+	VertexCompression::Compress(mesh, vertex_layout_, &stats);
+	if (stats.num_vertices == 0){
+		return;
+	}
+
+	/* Parity check of what the shaders will decode */
+	std::ostringstream report;
+	report << "Vertex layout " << VertexCompression::GetLayoutName(vertex_layout_) << " for " << mesh->getName() << ": "
+	       << stats.bytes_before/stats.num_vertices << " -> " << stats.bytes_after/stats.num_vertices << " bytes per vertex, "
+	       << "max position error " << stats.max_position_error << ", max normal error " << stats.max_normal_error
+	       << " degrees, max uv error " << stats.max_uv_error;
+	Ogre::LogManager::getSingleton().logMessage(report.str());
+
+	/* The full precision vertices are the reference */
+	float diameter = 2.0f*mesh->getBoundingSphereRadius();
+	if (stats.max_position_error > compression_position_tolerance_g*diameter ||
+		stats.max_normal_error > compression_normal_tolerance_g ||
+		stats.max_uv_error > compression_uv_tolerance_g){
+		num_compression_failures_++;
+		Ogre::LogManager::getSingleton().logMessage("Vertex layout " + VertexCompression::GetLayoutName(vertex_layout_) + " for " + mesh->getName() + " exceeds the error tolerances");
+	}
+}
+
+
+Ogre::Entity *OgreApplication::CreateMeshEntity(Ogre::String entity_name, Ogre::String mesh_name){
+
+	/* Every entity of a generated mesh needs the decode parameters of its vertex layout */
+	Ogre::Entity *entity = ogre_root_->getSceneManager("MySceneManager")->createEntity(entity_name, mesh_name);
+	VertexCompression::ApplyDecode(entity);
+	return entity;
+}
+
+
+void OgreApplication::AddStaging(Ogre::ManualObject *object){
+
+	/* From end() on, the ManualObject holds its buffers next to the construction data */
+	size_t cpu_bytes, gpu_bytes;
+	MemoryStats::EstimateStaging(object, cpu_bytes, gpu_bytes);
+	memory_stats_.Add(MEMORY_STAGING, cpu_bytes, gpu_bytes);
+	memory_stats_.Set(MEMORY_ARENA, 1, construction_arena_.GetCapacity(), 0);
+}
+
+
+void OgreApplication::ReleaseStaging(Ogre::ManualObject *object){
+
+	/* The mesh has buffers of its own: the ManualObject's copy and the construction data
+	   are not needed any more. Only their peak remains in the statistics. The object has
+	   not changed since AddStaging(), so the estimate is the same */
+	size_t cpu_bytes, gpu_bytes;
+	MemoryStats::EstimateStaging(object, cpu_bytes, gpu_bytes);
+
+	ogre_root_->getSceneManager("MySceneManager")->destroyManualObject(object);
+	construction_arena_.Reset();
+
+	memory_stats_.Remove(MEMORY_STAGING, cpu_bytes, gpu_bytes);
+	memory_stats_.Set(MEMORY_ARENA, 1, construction_arena_.GetCapacity(), 0);
+}
+
+
+void OgreApplication::DumpMemoryStats(void){
+
+	Ogre::LogManager::getSingleton().logMessage(memory_stats_.Report(ogre_root_->getSceneManager("MySceneManager")));
+}
+
+
+int OgreApplication::AddView(Ogre::String camera_name, float left, float top, float width, float height, int effect){
+
+	try {
+
+		Ogre::Camera *camera = ogre_root_->getSceneManager("MySceneManager")->getCamera(camera_name);
+
+		/* Each view has a listener of its own, so that it can tell its effect apart */
+		view_effects_.push_back(effect);
+		view_listeners_.push_back(MaterialListener());
+		view_listeners_.back().Init(this, (int) view_effects_.size() - 1);
+		render_counters_.ClearTargets();
+		int view = multi_view_.AddView(camera, left, top, width, height, &view_listeners_.back(), &bloom_);
+		InitRenderCounters();
+		return view;
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::SetViewEffect(int view, int effect){
+
+	view_effects_[view] = effect;
+}
+
+
+void OgreApplication::CreateCamera(Ogre::String camera_name, Ogre::Vector3 position, Ogre::Vector3 look_at, float fov_y){
+
+	try {
+
+		Ogre::Camera *camera = ogre_root_->getSceneManager("MySceneManager")->createCamera(camera_name);
+		camera->setNearClipDistance(camera_near_clip_distance_g);
+		camera->setFarClipDistance(camera_far_clip_distance_g);
+		camera->setFOVy(Ogre::Degree(fov_y));
+		camera->setFixedYawAxis(true, Ogre::Vector3(0.0, 1.0, 0.0));
+		camera->setPosition(position);
+		camera->lookAt(look_at);
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::SetMainViewDimensions(float left, float top, float width, float height){
+
+	try {
+
+		viewport_->setDimensions(left, top, width, height);
+		camera_->setAspectRatio(float(viewport_->getActualWidth()) / float(viewport_->getActualHeight()));
+
+		/* Compositor targets are sized after the viewport, so make them again; let go of
+		   the old ones first */
+		frame_capture_.Pause();
+		ShutdownOverdrawCounters();
+		render_counters_.ClearTargets();
+		Ogre::CompositorChain *chain = Ogre::CompositorManager::getSingleton().getCompositorChain(viewport_);
+		for (size_t i = 0; i < chain->getNumCompositors(); i++){
+			Ogre::CompositorInstance *inst = chain->getCompositor(i);
+			if (inst->getEnabled()){
+				inst->setEnabled(false);
+				inst->setEnabled(true);
+			}
+		}
+		frame_capture_.Resume(capture_instance_->getTextureInstance("capture", 0));
+		InitOverdrawCounters();
+		InitRenderCounters();
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::CreateTorusGeometry(Ogre::String object_name, float loop_radius, float circle_radius, int num_loop_samples, int num_circle_samples){
+
+    try {
+		/* Create a torus and add it to the resource list
+		   The torus is built from a large loop with small circles around the loop */
+
+		/* Skip generation if the same torus is already in the mesh cache */
+		MeshCacheKey cache_key = MeshCacheKey("TorusGeometry", torus_geometry_revision_g).Add(loop_radius).Add(circle_radius).Add(num_loop_samples).Add(num_circle_samples).Add(VertexCompression::GetLayoutName(vertex_layout_));
+		if (mesh_cache_.Load(cache_key, object_name)){
+			return;
+		}
+
+        /* Retrieve scene manager and root scene node */
+        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
+        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+        /* Create the 3D object */
+        Ogre::ManualObject* object = NULL;
+        object = scene_manager->createManualObject(object_name);
+        object->setDynamic(false);
+
+        /* Create triangle list for the object */
+		object->begin("", Ogre::RenderOperation::OT_TRIANGLE_LIST);
+
+		/* Add vertices to the object */
+		float theta, phi; // Angles for circles
+		Ogre::Vector3 loop_center;
+		Ogre::Vector3 vertex_position;
+		Ogre::Vector3 vertex_normal;
+		Ogre::ColourValue vertex_color;
+
+		/* Sines and cosines of the loop and circle samples, computed once for all vertices;
+		   in float like the per-vertex calls they replace, so the vertices stay the same */
+		float *cos_theta = construction_arena_.Allocate<float>(num_loop_samples);
+		float *sin_theta = construction_arena_.Allocate<float>(num_loop_samples);
+		float *cos_phi = construction_arena_.Allocate<float>(num_circle_samples);
+		float *sin_phi = construction_arena_.Allocate<float>(num_circle_samples);
+		for (int i = 0; i < num_loop_samples; i++){
+			theta = Ogre::Math::TWO_PI*i/num_loop_samples; // loop sample (angle theta)
+			cos_theta[i] = std::cos(theta);
+			sin_theta[i] = std::sin(theta);
+		}
+		for (int j = 0; j < num_circle_samples; j++){
+			phi = Ogre::Math::TWO_PI*j/num_circle_samples; // circle sample (angle phi)
+			cos_phi[j] = std::cos(phi);
+			sin_phi[j] = std::sin(phi);
+		}
+				
+		for (int i = 0; i < num_loop_samples; i++){ // large loop
+			
+			loop_center = Ogre::Vector3(loop_radius*cos_theta[i], loop_radius*sin_theta[i], 0); // centre of a small circle
+
+			for (int j = 0; j < num_circle_samples; j++){ // small circle
+				
+				/* Define position, normal and color of vertex */
+				vertex_normal = Ogre::Vector3(cos_theta[i]*cos_phi[j], sin_theta[i]*cos_phi[j], sin_phi[j]);
+				vertex_position = loop_center + vertex_normal*circle_radius;
+				/*Ogre::Vector3(loop_center.x + local_normal.x*circle_radius, 
+				                loop_center.y + local_normal.y*circle_radius, 
+				     			loop_center.z + local_normal.z*circle_radius);*/
+				vertex_color = Ogre::ColourValue(1.0 - ((float) i / (float) num_loop_samples), 
+				                                 (float) i / (float) num_loop_samples, 
+				                                 (float) j / (float) num_circle_samples);
+
+				/* Add them to the object */
+				object->position(vertex_position);
+				object->normal(vertex_normal);
+				object->colour(vertex_color); 
+			}
+		}
+
+		/* Add triangles to the object */
+		for (int i = 0; i < num_loop_samples; i++){
+			for (int j = 0; j < num_circle_samples; j++){
+				// Two triangles per quad
+				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j, 
+							     i*num_circle_samples + ((j + 1) % num_circle_samples),
+								 i*num_circle_samples + j);
+				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j,
+					             ((i + 1) % num_loop_samples)*num_circle_samples + ((j + 1) % num_circle_samples),
+								 i*num_circle_samples + ((j + 1) % num_circle_samples));
+			}
+		}
+		
+		/* We finished the object */
+        object->end();
+		AddStaging(object);
+		
+        /* Convert triangle list to a mesh */
+        Ogre::MeshPtr mesh = object->convertToMesh(object_name);
+		CompressMesh(mesh);
+		mesh_cache_.Commit(cache_key, mesh);
+		ReleaseStaging(object);
+    }
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::CreateEntity(Ogre::String entity_name, Ogre::String object_name, Ogre::String material_name){
+
+	try {
+		/* Create one instance of the torus (one entity) */
+		/* The same object can have multiple instances or entities */
+
+		/* Retrieve scene manager and root scene node */
+        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
+        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+		/* Create entity */
+        Ogre::Entity* entity = CreateMeshEntity(entity_name, object_name);
+
+		/* Apply a material to the entity to give it color */
+		/* We already did that above, so we comment it out here */
+		entity->setMaterialName(material_name);
+		/* But, this call is useful if we have multiple entities with different materials */
+
+		/* Create a scene node for the entity */
+		/* The scene node keeps track of the entity's position */
+        Ogre::SceneNode* scene_node = root_scene_node->createChildSceneNode(entity_name);
+        scene_node->attachObject(entity);
+
+        /* Position and rotate the entity with the scene node */
+		//scene_node->rotate(Ogre::Vector3(0, 1, 0), Ogre::Degree(60));
+		//scene_node->rotate(Ogre::Vector3(1, 0, 0), Ogre::Degree(30));
+        //scene_node->translate(0.0, 0.0, 0.0);
+		scene_node->scale(0.5, 0.5, 0.5);
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::MainLoop(void){
+
+    try {
+
+        /* Main loop to keep the application going */
+
+        ogre_root_->clearEventTimes();
+
+		/* A replay has to step exactly once per frame */
+		if (threaded_ && input_replay_.IsOpen()){
+			Ogre::LogManager::getSingleton().logMessage("Input replay: simulating without a thread");
+			threaded_ = false;
+		}
+
+		/* Simulation and rendering overlap; they only share the snapshots */
+		if (threaded_){
+			simulation_quit_ = false;
+			simulation_thread_ = std::thread(&OgreApplication::SimulationMain, this);
+		}
+
+        while(!ogre_window_->isClosed() && !quit_){
+            ogre_window_->update(false);
+
+            ogre_window_->swapBuffers();
+
+            ogre_root_->renderOneFrame();
+
+            Ogre::WindowEventUtilities::messagePump();
+        }
+
+		StopSimulation();
+		input_recorder_.Close();
+		frame_trace_.Close();
+
+		/* Write out the frames still in flight */
+		StopCapture();
+    }
+    catch (Ogre::Exception &e){
+		StopSimulation();
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+		StopSimulation();
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
+void OgreApplication::StopSimulation(void){
+
+	if (simulation_thread_.joinable()){
+		simulation_quit_ = true;
+		simulation_thread_.join();
+	}
+}
+
+
+void OgreApplication::SetupAnimation(Ogre::String object_name){
+
+	/* Retrieve scene manager and root scene node */
+    Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
+	Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+	/* Set up animation */
+	Ogre::Real duration = Ogre::Math::TWO_PI;
+	Ogre::Real num_steps = 36;
+	Ogre::Real step = duration/num_steps;
+	Ogre::Animation* animation = scene_manager->createAnimation("Animation", duration);
+	animation->setInterpolationMode(Ogre::Animation::IM_LINEAR);
+	Ogre::Node *object_scene_node = root_scene_node->getChild(object_name);
+	Ogre::NodeAnimationTrack* track = animation->createNodeTrack(0, object_scene_node);
+	
+	/* Set up frames for animation */
+	Ogre::TransformKeyFrame* key;
+	Ogre::Quaternion quat;
+	Ogre::Matrix3 rot1, rot2, rot3;
+	rot1 = Ogre::Matrix3::IDENTITY;
+	for (int i = 0; i < num_steps; i++){
+		Ogre::Real current = ((float) i) * step;
+		key = track->createNodeKeyFrame(current);
+		//rot1.FromAngleAxis(Ogre::Vector3(1, 0, 0), Ogre::Degree(-90)); // Comment for Torus
+		rot2.FromAngleAxis(Ogre::Vector3(0, 1, 0), Ogre::Radian(-current));
+		rot3 = rot2 * rot1;
+		quat.FromRotationMatrix(rot3);
+		key->setRotation(quat);
+		key->setScale(Ogre::Vector3(0.8, 0.8, 0.8)); // Uncomment for Torus
+	}
+
+	/* The animation is sampled by Simulate() instead of an animation state, so that it */
+	/* can run on the simulation thread; build the keyframe time list before that */
+	animation->_getTimeIndex(0);
+	animation_ = animation;
+
+	/* Turn on animating flag */
+	animating_ = true;
+}
+
+
+bool OgreApplication::frameStarted(const Ogre::FrameEvent &fe){
+
+	/* Take the newest state the simulation thread finished */
+	if (threaded_ && snapshots_.Update()){
+		ApplySnapshot(snapshots_.GetReadBuffer());
+	}
+
+	/* Bin the lights for this frame before anything is rendered */
+	clustered_lighting_.Update(camera_);
+	render_counters_.BeginFrame();
+
+	return true;
+}
+
+
+bool OgreApplication::frameEnded(const Ogre::FrameEvent &fe){
+
+	/* Render scene to texture before rendering the current scene */
+
+	return true;
+}
+
+
+bool OgreApplication::frameRenderingQueued(const Ogre::FrameEvent& fe){
+  
+	/* This event is called after a frame is queued for rendering */
+	/* Do stuff in this event since the GPU is rendering and the CPU is idle */
+
+	/* Without a simulation thread, simulate and use the result right away */
+	/* A replay takes one fixed step per frame, so every run renders the same states in
+	   the same frames; a recording takes fixed steps for the time that passed */
+	if (!threaded_){
+		if (input_replay_.IsOpen()){
+			Simulate(simulation_step_g, simulation_state_);
+		}
+		else if (input_recorder_.IsOpen()){
+			step_time_ += fe.timeSinceLastFrame;
+			while (step_time_ >= simulation_step_g){
+				Simulate(simulation_step_g, simulation_state_);
+				step_time_ -= simulation_step_g;
+			}
+		}
+		else {
+			Simulate(fe.timeSinceLastFrame, simulation_state_);
+		}
+		ApplySnapshot(simulation_state_);
+	}
+
+	/* Frame times against the step they show, to line up runs */
+	unsigned long frame = ogre_root_->getNextFrameNumber();
+	input_recorder_.RecordFrame(frame, applied_.sequence, fe.timeSinceLastFrame);
+	frame_trace_.RecordFrame(frame, applied_.sequence, fe.timeSinceLastFrame);
+	if (input_replay_.IsOpen() && applied_.sequence >= input_replay_.GetNumSteps()){
+		std::ostringstream report;
+		report << "Input replay finished after " << applied_.sequence << " steps";
+		Ogre::LogManager::getSingleton().logMessage(report.str());
+		quit_ = true;
+	}
+
+	UpdateRenderStats(fe.timeSinceLastFrame);
+		
+    return true;
+}
+
+
+void OgreApplication::Simulate(float time_step, FrameSnapshot &state){
+
+	/* Keep animating if flag is on */
+	if (animating_ && animation_){
+		state.animation_time = fmod(state.animation_time + time_step, animation_->getLength());
+	}
+
+	// Update time for compositor
+	state.elapsed_time += time_step;
+
+	/* Input of this step, from the devices or from the recording being replayed */
+	InputState input;
+	if (input_replay_.IsOpen()){
+		input_replay_.GetStep(state.sequence, input);
+	}
+	else {
+		keyboard_->capture();
+		mouse_->capture();
+		for (int key = 0; key < (int) input.keys.size(); key++){
+			input.keys[key] = keyboard_->isKeyDown((OIS::KeyCode) key);
+		}
+		const OIS::MouseState &mouse_state = mouse_->getMouseState();
+		input.left_button = mouse_state.buttonDown(OIS::MB_Left);
+		input.mouse = Ogre::Vector2(((float) mouse_state.X.abs)/mouse_state.width, ((float) mouse_state.Y.abs)/mouse_state.height);
+	}
+	input_recorder_.RecordStep(state.sequence, input);
+
+	/* Handle specific key events */
+	/* Anything that changes the scene or the compositors is only requested here */
+	if (input.IsKeyDown(OIS::KC_SPACE)){
+		space_down_ = true;
+	}
+	if ((!input.IsKeyDown(OIS::KC_SPACE)) && space_down_){
+		animating_ = !animating_;
+		space_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_L)){
+		l_down_ = true;
+	}
+	if ((!input.IsKeyDown(OIS::KC_L)) && l_down_){
+		state.num_light_requests++;
+		l_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_ESCAPE)){
+		state.animation_time = 0;
+	}
+	if (input.left_button){
+		mouse_down_ = true;
+	}
+	if ((!input.left_button) && mouse_down_){
+		/* A shockwave where the button was released */
+		state.shockwaves.Spawn(input.mouse, shockwave_speed_g, shockwave_strength_g);
+		mouse_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_A)){
+		state.shading_type = 1;
+	}
+	if (input.IsKeyDown(OIS::KC_Q)){
+		state.shading_type = 0;
+	}
+	if (input.IsKeyDown(OIS::KC_R)){
+		r_down_ = true;
+	}
+	if ((!input.IsKeyDown(OIS::KC_R)) && r_down_){
+		state.num_render_path_toggles++;
+		r_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_P)){
+		p_down_ = true;
+	}
+	if ((!input.IsKeyDown(OIS::KC_P)) && p_down_){
+		state.num_capture_toggles++;
+		p_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_S)){
+		s_down_ = true;
+	}
+	if ((!input.IsKeyDown(OIS::KC_S)) && s_down_){
+		state.num_static_batching_toggles++;
+		s_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_M)){
+		m_down_ = true;
+	}
+	if ((!input.IsKeyDown(OIS::KC_M)) && m_down_){
+		state.num_memory_reports++;
+		m_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_O)){
+		o_down_ = true;
+	}
+	if ((!input.IsKeyDown(OIS::KC_O)) && o_down_){
+		state.num_occlusion_toggles++;
+		o_down_ = false;
+	}
+	if (input.IsKeyDown(OIS::KC_B)){
+		state.effect = 1;
+	}
+	if (input.IsKeyDown(OIS::KC_C)){
+		state.effect = 2;
+	}
+	if (input.IsKeyDown(OIS::KC_D)){
+		state.effect = 3;
+	}
+	if (input.IsKeyDown(OIS::KC_E)){
+		state.effect = 4;
+	}
+	if (input.IsKeyDown(OIS::KC_F)){
+		state.effect = 5;
+	}
+	if (input.IsKeyDown(OIS::KC_G)){
+		state.effect = 6;
+	}
+
+	/* Spawn the queued shockwaves, then age all of them */
+	{
+		std::lock_guard<std::mutex> lock(shockwave_mutex_);
+		for (size_t i = 0; i < shockwave_events_.size(); i++){
+			const Shockwave &wave = shockwave_events_[i];
+			state.shockwaves.Spawn(wave.centre, wave.speed, wave.strength);
+		}
+		shockwave_events_.clear();
+	}
+	state.shockwaves.Update(time_step);
+
+	/* Sample the animation tracks; the keyframes are not changed while the application runs */
+	if (animation_){
+		state.transforms.resize(animation_->getNumNodeTracks());
+		Ogre::TimeIndex time_index = animation_->_getTimeIndex(state.animation_time);
+		Ogre::Animation::NodeTrackIterator it = animation_->getNodeTrackIterator();
+		for (size_t i = 0; it.hasMoreElements(); i++){
+			Ogre::NodeAnimationTrack *track = it.getNext();
+			Ogre::TransformKeyFrame key(NULL, 0);
+			track->getInterpolatedKeyFrame(time_index, &key);
+			state.transforms[i].node = track->getAssociatedNode();
+			state.transforms[i].translate = key.getTranslate();
+			state.transforms[i].rotate = key.getRotation();
+			state.transforms[i].scale = key.getScale();
+		}
+	}
+
+	state.sequence++;
+}
+
+
+void OgreApplication::ApplySnapshot(const FrameSnapshot &snapshot){
+
+	/* Same as the animation state would do, see NodeAnimationTrack::applyToNode */
+	for (size_t i = 0; i < snapshot.transforms.size(); i++){
+		const NodeTransform &transform = snapshot.transforms[i];
+		transform.node->resetToInitialState();
+		transform.node->translate(transform.translate);
+		transform.node->rotate(transform.rotate);
+		transform.node->scale(transform.scale);
+	}
+
+	elapsed_time_ = snapshot.elapsed_time;
+	shockwaves_ = snapshot.shockwaves;
+	if (snapshot.effect != applied_.effect){
+		effect = snapshot.effect;
+	}
+	if (snapshot.shading_type != applied_.shading_type){
+		/* Both the forward and the G-buffer technique need the shading type */
+		Ogre::MaterialPtr mPtr = Ogre::MaterialManager::getSingleton().getByName("ShinyBlueMaterial");
+		for (unsigned short i = 0; i < mPtr->getNumTechniques(); i++){
+			Ogre::GpuProgramParametersSharedPtr params = mPtr->getTechnique(i)->getPass(0)->getFragmentProgramParameters();
+			params->setNamedConstant("type", snapshot.shading_type);
+		}
+	}
+
+	/* Act on the requests made since the last snapshot used */
+	for (int i = applied_.num_light_requests; i < snapshot.num_light_requests; i++){
+		/* Scatter small coloured lights around the cylinder assembly */
+		for (int j = 0; j < num_lights_per_key_press_g; j++){
+			Ogre::Vector3 position(Ogre::Math::RangeRandom(-6.0, 2.0), Ogre::Math::RangeRandom(-2.0, 2.0), Ogre::Math::RangeRandom(-28.0, -22.0));
+			Ogre::ColourValue colour(Ogre::Math::UnitRandom(), Ogre::Math::UnitRandom(), Ogre::Math::UnitRandom());
+			AddPointLight(position, Ogre::Math::RangeRandom(0.5, 2.0), colour, 1.0);
+		}
+	}
+	if ((snapshot.num_render_path_toggles - applied_.num_render_path_toggles) % 2){
+		SetRenderPath(!deferred_shading_);
+	}
+	if ((snapshot.num_capture_toggles - applied_.num_capture_toggles) % 2){
+		if (frame_capture_.IsCapturing()){
+			StopCapture();
+		}
+		else {
+			StartCapture(capture_directory_g);
+		}
+	}
+	if ((snapshot.num_static_batching_toggles - applied_.num_static_batching_toggles) % 2){
+		/* Compare batched and individual draw calls */
+		static_batching_ = !static_batching_;
+		Ogre::SceneManager *scene_manager = ogre_root_->getSceneManager("MySceneManager");
+		for (size_t i = 0; i < static_nodes_.size(); i++){
+			Ogre::SceneNode *node = scene_manager->getSceneNode(static_nodes_[i]);
+			if (static_batching_){
+				static_batcher_.MarkStatic(node);
+			}
+			else {
+				static_batcher_.Unmark(node);
+			}
+		}
+	}
+
+	if ((snapshot.num_occlusion_toggles - applied_.num_occlusion_toggles) % 2){
+		SetOcclusionCulling(!occlusion_culling_);
+	}
+	if (snapshot.num_memory_reports != applied_.num_memory_reports){
+		DumpMemoryStats();
+	}
+
+	/* Remember what was applied; the transforms are not needed */
+	applied_.sequence = snapshot.sequence;
+	applied_.effect = snapshot.effect;
+	applied_.shading_type = snapshot.shading_type;
+	applied_.num_light_requests = snapshot.num_light_requests;
+	applied_.num_render_path_toggles = snapshot.num_render_path_toggles;
+	applied_.num_capture_toggles = snapshot.num_capture_toggles;
+	applied_.num_static_batching_toggles = snapshot.num_static_batching_toggles;
+	applied_.num_memory_reports = snapshot.num_memory_reports;
+	applied_.num_occlusion_toggles = snapshot.num_occlusion_toggles;
+}
+
+
+void OgreApplication::SimulationMain(void){
+
+	/* Step at a fixed rate, independent of rendering */
+	std::chrono::steady_clock::time_point last_step = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::duration step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(simulation_step_g));
+	while (!simulation_quit_){
+		std::this_thread::sleep_until(last_step + step);
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		float time_step = std::chrono::duration<float>(now - last_step).count();
+		last_step = now;
+		if (input_recorder_.IsOpen()){
+			/* Steps of a recording have to replay the same */
+			time_step = simulation_step_g;
+		}
+
+		Simulate(time_step, simulation_state_);
+		snapshots_.GetWriteBuffer() = simulation_state_;
+		snapshots_.Publish();
+	}
+}
+
+
+void MaterialListener::Init(OgreApplication *app, int view){
+
+	app_ = app;
+	view_ = view;
+}
+
+
+void MaterialListener::notifyMaterialSetup(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat){
+
+}
+
+
+void MaterialListener::notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat){
+
+	// The bloom passes are updated by Bloom
+	if (pass_id != 0){
+		return;
+	}
+
+	// Update compositor material parameters
+	Ogre::GpuProgramParametersSharedPtr params = mat->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
+	params->setNamedConstant("time", (float)(((int)(app_->elapsed_time_*100.0)) % app_->ogre_window_->getHeight()));
+	params->setNamedConstant("effect", (view_ < 0) ? app_->effect : app_->view_effects_[view_]);
+
+	// All active shockwaves in one array
+	int num_shockwaves = app_->shockwaves_.GetNumActive();
+	params->setNamedConstant("num_shockwaves", num_shockwaves);
+	if (num_shockwaves > 0){
+		float data[4*ShockwavePool::capacity];
+		app_->shockwaves_.GetUniforms(data);
+		params->setNamedConstant("shockwaves", data, num_shockwaves, 4);
+	}
+}
+
+void OgreApplication::CreateCylinder(void){
+
+	try {
+		/* Create a Cylinder */
+
+		/* Retrieve scene manager and root scene node */
+		Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
+		Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+		   Ogre::Real cylinder_start=-0.5f;
+		   Ogre::Real cylinder_length=1.0f;
+		   Ogre::Real cylinder_raduis=1.0f;
+		   const int cylinder_circle_resolution=120;
+		   Ogre::String material_name = "ShinyTextureMaterial";
+		   int loop_count;
+
+		   /* Skip generation if the same cylinder is already in the mesh cache */
+		   MeshCacheKey cache_key = MeshCacheKey("Cylinder", cylinder_revision_g).Add(material_name).Add(cylinder_start).Add(cylinder_length).Add(cylinder_raduis).Add(cylinder_circle_resolution).Add(VertexCompression::GetLayoutName(vertex_layout_));
+		   if (mesh_cache_.Load(cache_key, "Cylinder")){
+			   return;
+		   }
+
+		   Ogre::Degree theta =(Ogre::Degree)0;
+		   Ogre::Degree alpha =(Ogre::Degree)360/cylinder_circle_resolution;
+
+		   Ogre::Vector3 *cylinder_circle1 = construction_arena_.Allocate<Ogre::Vector3>(cylinder_circle_resolution);
+		   Ogre::Vector3 *cylinder_circle2 = construction_arena_.Allocate<Ogre::Vector3>(cylinder_circle_resolution);
+
+		   Ogre::Vector3  cylinder_circle1_center;
+		   Ogre::Vector3  cylinder_circle2_center;
+
+		   cylinder_circle1_center.x=-0.5;
+		   cylinder_circle1_center.y=cylinder_start;
+		   cylinder_circle1_center.z=0;
+
+		   cylinder_circle2_center.x=-0.5;
+		   cylinder_circle2_center.y=cylinder_start+cylinder_length;
+		   cylinder_circle2_center.z=0;
+
+		   for(int loop_count=0;loop_count<cylinder_circle_resolution;loop_count++)
+		   {
+			  theta=theta+alpha;
+			  cylinder_circle1[loop_count].x=cylinder_start;
+			  cylinder_circle1[loop_count].y=Ogre::Math::Sin(theta)*cylinder_raduis; 
+			  cylinder_circle1[loop_count].z=Ogre::Math::Cos(theta)*cylinder_raduis; 
+
+			  cylinder_circle2[loop_count].x=cylinder_start+cylinder_length;
+			  cylinder_circle2[loop_count].y=Ogre::Math::Sin(theta)*cylinder_raduis; 
+			  cylinder_circle2[loop_count].z=Ogre::Math::Cos(theta)*cylinder_raduis; 
+
+		   }
+
+		   	/* Create the 3D object */
+			Ogre::ManualObject* object = NULL;
+			Ogre::String object_name = "Cylinder";
+			object = scene_manager->createManualObject(object_name);
+			object->setDynamic(false);
+
+		   //////////////cylinder left circular base of circle//////////////////////////
+		   
+			/* Create triangle list for the object */
+		   object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_FAN);
+		   object->colour(Ogre::ColourValue(0.0,0.0,1.0));
+		   object->position(cylinder_circle1_center);
+		   object->normal(-1,0,0);
+		   object->textureCoord(0.5,0.5);
+		   for( loop_count=0;loop_count<cylinder_circle_resolution;loop_count++)
+		   {
+			  object->position(cylinder_circle1[loop_count]);
+			  object->normal(-1,0,0);
+			  object->textureCoord(0,0.5);
+		   }
+		   object->position(cylinder_circle1[0]);
+		   object->normal(-1,0,0);
+		   object->textureCoord(0.5,0.5);
+		   object->end();
+
+		   //////////////cylinder curved surface//////////////////////////
+		   object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_LIST);
+		   object->colour(Ogre::ColourValue(0.2,0.6,0.5));
+
+		   for( loop_count=0;loop_count<cylinder_circle_resolution-1;loop_count++)
+		   {  
+			  object->position(cylinder_circle1[loop_count]);
+			  object->normal(0,cylinder_circle1[loop_count].y,cylinder_circle1[loop_count].z);
+			  object->textureCoord(loop_count/(cylinder_circle_resolution-1),0);
+			  object->position(cylinder_circle2[loop_count]);
+			  object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
+			  object->textureCoord(loop_count/(cylinder_circle_resolution-1),1);
+			  object->position(cylinder_circle1[loop_count+1]);
+			  object->normal(0,cylinder_circle1[loop_count+1].y,cylinder_circle1[loop_count+1].z);
+			  object->textureCoord((loop_count+1)/(cylinder_circle_resolution-1),0);
+
+			  object->position(cylinder_circle1[loop_count+1]);
+			  object->normal(0,cylinder_circle1[loop_count+1].y,cylinder_circle1[loop_count+1].z);
+			  object->textureCoord((loop_count+1)/(cylinder_circle_resolution-1),0);
+
+			  object->position(cylinder_circle2[loop_count]);
+			  object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
+			  object->textureCoord((loop_count)/(cylinder_circle_resolution-1),1);
+
+			  object->position(cylinder_circle2[loop_count+1]);
+			  object->normal(0,cylinder_circle2[loop_count+1].y,cylinder_circle2[loop_count+1].z);
+			  object->textureCoord((loop_count+1)/(cylinder_circle_resolution-1),1);
+
+
+		   }
+		   object->position(cylinder_circle1[loop_count]);
+		   object->normal(0,cylinder_circle1[loop_count].y,cylinder_circle1[loop_count].z);
+		   object->textureCoord((loop_count)/(cylinder_circle_resolution-1),0);
+
+		   object->position(cylinder_circle2[loop_count]);
+		   object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
+		   object->textureCoord((loop_count)/(cylinder_circle_resolution-1),1);
+
+		   object->position(cylinder_circle1[0]);
+		   object->normal(0,cylinder_circle1[0].y,cylinder_circle1[0].z);
+		   object->textureCoord((0)/(cylinder_circle_resolution-1),0);
+
+
+		   object->position(cylinder_circle1[0]);
+		   object->normal(0,cylinder_circle1[0].y,cylinder_circle1[0].z);
+		   object->textureCoord((0)/(cylinder_circle_resolution-1),0);
+
+		   object->position(cylinder_circle2[loop_count]);
+		   object->normal(0,cylinder_circle2[loop_count].y,cylinder_circle2[loop_count].z);
+		   object->textureCoord((loop_count)/(cylinder_circle_resolution-1),1);
+
+		   object->position(cylinder_circle2[0]);
+		   object->normal(0,cylinder_circle2[0].y,cylinder_circle2[0].z);
+		   object->textureCoord((0)/(cylinder_circle_resolution-1),1);
+
+		   object->end();
+
+		   //////////////cylinder right circular base of circle//////////////////////////
+		   object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_FAN);
+		   object->colour(Ogre::ColourValue(0.0,0.0,1.0));
+		   object->position(cylinder_circle2_center);
+		   object->normal(1,0,0);
+		   object->textureCoord(0.5,0.5);
+
+		   for( loop_count=cylinder_circle_resolution-1;loop_count>0;--loop_count)
+		   {
+			  object->position(cylinder_circle2[loop_count]);
+			  object->normal(1,0,0);
+			  object->textureCoord(0.5,0.5);
+		   }
+		   object->position(cylinder_circle2[cylinder_circle_resolution-1]);
+		   object->normal(1,0,0);
+		   object->textureCoord(0.5,0.5);
+		   object->end();
+		   AddStaging(object);
+   
+		
+        /* Convert triangle list to a mesh */
+        Ogre::String mesh_name = "Cylinder";
+        Ogre::MeshPtr mesh = object->convertToMesh(mesh_name);
+		CompressMesh(mesh);
+		mesh_cache_.Commit(cache_key, mesh);
+		ReleaseStaging(object);
+
+	}
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+void OgreApplication::CreateTorus(Ogre::String object_name, Ogre::String material_name, float loop_radius, float circle_radius, int num_loop_samples, int num_circle_samples){
+
+    try {
+		/* Create a torus
+		   The torus is built from a large loop with small circles around the loop */
+
+		/* Skip generation if the same torus is already in the mesh cache */
+		MeshCacheKey cache_key = MeshCacheKey("Torus", torus_revision_g).Add(material_name).Add(loop_radius).Add(circle_radius).Add(num_loop_samples).Add(num_circle_samples).Add(VertexCompression::GetLayoutName(vertex_layout_));
+		if (mesh_cache_.Load(cache_key, object_name)){
+			return;
+		}
+
+        /* Retrieve scene manager and root scene node */
+        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
+        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+        /* Create the 3D object */
+        Ogre::ManualObject* object = NULL;
+        object = scene_manager->createManualObject(object_name);
+        object->setDynamic(false);
+
+        /* Create triangle list for the object */
+		object->begin(material_name, Ogre::RenderOperation::OT_TRIANGLE_LIST);
+
+		/* Add vertices to the object */
+		float theta, phi; // Angles for circles
+		Ogre::Vector3 loop_center;
+		Ogre::Vector3 vertex_position;
+		Ogre::Vector3 vertex_normal;
+		Ogre::ColourValue vertex_color;
+
+		/* Sines and cosines of the loop and circle samples, computed once for all vertices;
+		   in float like the per-vertex calls they replace, so the vertices stay the same */
+		float *cos_theta = construction_arena_.Allocate<float>(num_loop_samples);
+		float *sin_theta = construction_arena_.Allocate<float>(num_loop_samples);
+		float *cos_phi = construction_arena_.Allocate<float>(num_circle_samples);
+		float *sin_phi = construction_arena_.Allocate<float>(num_circle_samples);
+		for (int i = 0; i < num_loop_samples; i++){
+			theta = Ogre::Math::TWO_PI*i/num_loop_samples; // loop sample (angle theta)
+			cos_theta[i] = std::cos(theta);
+			sin_theta[i] = std::sin(theta);
+		}
+		for (int j = 0; j < num_circle_samples; j++){
+			phi = Ogre::Math::TWO_PI*j/num_circle_samples; // circle sample (angle phi)
+			cos_phi[j] = std::cos(phi);
+			sin_phi[j] = std::sin(phi);
+		}
+				
+		for (int i = 0; i < num_loop_samples; i++){ // large loop
+			
+			loop_center = Ogre::Vector3(loop_radius*cos_theta[i], loop_radius*sin_theta[i], 0); // centre of a small circle
+
+			for (int j = 0; j < num_circle_samples; j++){ // small circle
+				
+				/* Define position, normal and color of vertex */
+				vertex_normal = Ogre::Vector3(cos_theta[i]*cos_phi[j], sin_theta[i]*cos_phi[j], sin_phi[j]);
+				vertex_position = loop_center + vertex_normal*circle_radius;
+				/*Ogre::Vector3(loop_center.x + local_normal.x*circle_radius, 
+				                loop_center.y + local_normal.y*circle_radius, 
+				     			loop_center.z + local_normal.z*circle_radius);*/
+				vertex_color = Ogre::ColourValue(1.0 - ((float) i / (float) num_loop_samples), 
+				                                 (float) i / (float) num_loop_samples, 
+				                                 (float) j / (float) num_circle_samples);
+				/*vertex_color = Ogre::ColourValue(0.0, 0.0, 1.0);*/
+
+				/* Add them to the object */
+				object->position(vertex_position);
+				object->normal(vertex_normal);
+				object->colour(vertex_color); 
+				object->textureCoord(cos_theta[i],sin_phi[j]);
+			}
+		}
+
+		/* Add triangles to the object */
+		for (int i = 0; i < num_loop_samples; i++){
+			for (int j = 0; j < num_circle_samples; j++){
+				// Two triangles per quad
+				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j, 
+							     i*num_circle_samples + ((j + 1) % num_circle_samples),
+								 i*num_circle_samples + j);
+				object->triangle(((i + 1) % num_loop_samples)*num_circle_samples + j,
+					             ((i + 1) % num_loop_samples)*num_circle_samples + ((j + 1) % num_circle_samples),
+								 i*num_circle_samples + ((j + 1) % num_circle_samples));
+			}
+		}
+		
+		/* We finished the object */
+        object->end();
+		AddStaging(object);
+		
+        /* Convert triangle list to a mesh */
+        Ogre::MeshPtr mesh = object->convertToMesh(object_name);
+		CompressMesh(mesh);
+		mesh_cache_.Commit(cache_key, mesh);
+		ReleaseStaging(object);
+
+    }
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+void OgreApplication::CreateMultipleCylinders(void){
+
+	try {
+		/* Create multiple entities of a Cylinder */
+
+        /* Retrieve scene manager and root scene node */
+        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
+        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+		//create first cylinder which is called A as center
+		Ogre::Entity *entity0 = CreateMeshEntity("Cylinder0", "Cylinder");
+		cylinder_[0] = root_scene_node->createChildSceneNode("Cylinder0",Ogre::Vector3( 0, 0, 0 ));
+		cylinder_[0]->attachObject(entity0);
+		cylinder_[0]->scale(4.0,0.25,0.25);
+		cylinder_[0]->translate(-2,0,-25);
+		cylinder_[0]->yaw(Ogre::Degree(-45));
+		//A left
+		Ogre::Entity *entity1 = CreateMeshEntity("Cylinder1", "Cylinder");
+		cylinder_[1] = cylinder_[0]->createChildSceneNode("Cylinder1",Ogre::Vector3( -0.6, 0, 0 ));
+		cylinder_[1]->attachObject(entity1);
+		cylinder_[1]->scale(0.25,2,2);
+		//A right
+		Ogre::Entity *entity2 = CreateMeshEntity("Cylinder2", "Cylinder");
+		cylinder_[2] = cylinder_[0]->createChildSceneNode("Cylinder2",Ogre::Vector3( 0.6, 0, 0 ));
+		cylinder_[2]->attachObject(entity2);
+		cylinder_[2]->scale(0.25,2,2);
+		//B left 1
+		Ogre::Entity *entity3 = CreateMeshEntity("Cylinder3", "Cylinder");
+		cylinder_[3] = cylinder_[0]->createChildSceneNode("Cylinder3",Ogre::Vector3( -0.7, 0, 0 ));
+		cylinder_[3]->attachObject(entity3);		
+		cylinder_[3]->scale(0.5,0.2,0.2);
+		cylinder_[3]->roll(Ogre::Degree( 90 ) );
+
+		//B left 2
+		Ogre::Entity *entity4 = CreateMeshEntity("Cylinder4", "Cylinder");
+		cylinder_[4] = cylinder_[0]->createChildSceneNode("Cylinder4",Ogre::Vector3( -0.7, 0, 0 ));
+		cylinder_[4]->attachObject(entity4);
+		cylinder_[4]->scale(0.5,0.2,0.2);
+		cylinder_[4]->yaw( Ogre::Degree( 90 ) );
+
+		//B right 1
+		Ogre::Entity *entity5 = CreateMeshEntity("Cylinder5", "Cylinder");
+		cylinder_[5] = cylinder_[0]->createChildSceneNode("Cylinder5",Ogre::Vector3( 0.7, 0, 0 ));
+		cylinder_[5]->attachObject(entity5);		
+		cylinder_[5]->scale(0.5,0.2,0.2);
+		cylinder_[5]->roll( Ogre::Degree( 90 ) );
+
+		//B right 2
+		Ogre::Entity *entity6 = CreateMeshEntity("Cylinder6", "Cylinder");
+		cylinder_[6] = cylinder_[0]->createChildSceneNode("Cylinder6",Ogre::Vector3( 0.7, 0, 0 ));
+		cylinder_[6]->attachObject(entity6);
+		cylinder_[6]->scale(0.5,0.2,0.2);
+		cylinder_[6]->yaw( Ogre::Degree( 90 ) );
+
+		//cube
+		Ogre::Entity *entity7 = CreateMeshEntity("Cylinder7", "Cylinder");
+		cylinder_[7] = cylinder_[0]->createChildSceneNode("Cylinder7",Ogre::Vector3( 0.0, 0, 0 ));
+		cylinder_[7]->attachObject(entity7);
+		cylinder_[7]->scale(0.5,15,10);
+		
+		
+		
+    }
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+void OgreApplication::CreateMultipleTorus(void){
+
+	try {
+		/* Create multiple entities of a Cylinder */
+
+        /* Retrieve scene manager and root scene node */
+        Ogre::SceneManager* scene_manager = ogre_root_->getSceneManager("MySceneManager");
+        Ogre::SceneNode* root_scene_node = scene_manager->getRootSceneNode();
+
+        /* Create multiple entities of the cube mesh */
+		Ogre::String entity_name, prefix("Torus");
+		for (int i = 0; i < NUM_ELEMENTS_TORUS; i++){
+			/* Create entity */
+			entity_name = prefix + Ogre::StringConverter::toString(i);
+			Ogre::Entity *entity = CreateMeshEntity(entity_name, "Torus");
+
+			/* Create a scene node for the entity */
+			/* The scene node keeps track of the entity's position */
+			torus_[i] = cylinder_[0]->createChildSceneNode(entity_name);
+			torus_[i]->scale(0.5,10,1);
+			torus_[i]->attachObject(entity);
+		}
+		//setup torus
+		torus_[0]->translate(0.7, 0, 0);
+		torus_[0]->yaw(Ogre::Degree( 90 ));
+		torus_[1]->translate(-0.7, 0, 0);
+		torus_[1]->yaw(Ogre::Degree( 90 ));
+    }
+    catch (Ogre::Exception &e){
+        throw(OgreAppException(std::string("Ogre::Exception: ") + std::string(e.what())));
+    }
+    catch(std::exception &e){
+        throw(OgreAppException(std::string("std::Exception: ") + std::string(e.what())));
+    }
+}
+
+
 } // namespace ogre_application;
\ No newline at end of file
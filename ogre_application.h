@@ -1,115 +1,311 @@
-#ifndef OGRE_APPLICATION_H_
-#define OGRE_APPLICATION_H_
-
-#include <exception>
-#include <string>
-
-#include "OGRE/OgreRoot.h"
-#include "OGRE/OgreViewport.h"
-#include "OGRE/OgreCamera.h"
-#include "OGRE/OgreHardwarePixelBuffer.h"
-#include "OGRE/OgreRenderSystem.h"
-#include "OGRE/OgreRenderWindow.h"
-#include "OGRE/OgreWindowEventUtilities.h"
-#include "OGRE/OgreManualObject.h"
-#include "OGRE/OgreEntity.h"
-#include "OGRE/OgreCompositorManager.h"
-#include "OGRE/OgreCompositorInstance.h"
-#include "OIS/OIS.h"
-
-namespace ogre_application {
-
-
-	/* A useful type to define */
-	typedef std::vector<Ogre::String> Strings;
-
-	/* Our exception type */
-	class OgreAppException: public std::exception
-    {
-		private:
-		    std::string message_;
-	    public:
-			OgreAppException(std::string message) : message_(message) {};
-			virtual const char* what() const throw() { return message_.c_str(); };
-	};
-
-	/* Material listener for updating the compositor materials */
-	class OgreApplication;
-	class MaterialListener : public Ogre::CompositorInstance::Listener
-	{
-		public:
-			void Init(OgreApplication *app);
-			virtual void notifyMaterialSetup(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat);
-			virtual void notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat);
-
-		private:
-			OgreApplication *app_;
-	};
-
-	/* Our Ogre application */
-	class OgreApplication :
-	    public Ogre::FrameListener, // Derive from FrameListener to be able to have event callbacks
-        public Ogre::WindowEventListener {
-
-		friend class MaterialListener;
-
-        public:
-            OgreApplication(void);
-            void Init(void); // Call Init() before running the main loop
-			// Create geometry of a torus and add it to the available resources
-			void CreateTorusGeometry(Ogre::String object_name, float loop_radius = 0.6, float circle_radius = 0.2, int num_loop_samples = 90, int num_circle_samples = 30); 
-			// Create an entity of an object that we can show on the screen
-            void CreateEntity(Ogre::String entity_name, Ogre::String object_name, Ogre::String material_name);
-			void SetupAnimation(Ogre::String entity_name); // Setup animation for an object
-            void MainLoop(void); // Keep application active
-
-			void CreateCylinder(void); // Create the geometry for a single Cylinder
-			void CreateMultipleCylinders(void);
-			void CreateTorus(Ogre::String object_name, Ogre::String material_name, float loop_radius = 0.6, float circle_radius = 0.2, int num_loop_samples = 90, int num_circle_samples = 30); // Create an object to show on the screen
-			void CreateMultipleTorus(void);
-
-        private:
-			// Create root that allows us to access Ogre commands
-            std::auto_ptr<Ogre::Root> ogre_root_;
-            // Application main Ogre window
-            Ogre::RenderWindow* ogre_window_;
-
-			// For animating the sphere
-			Ogre::AnimationState *animation_state_; // Keep state of the animation
-			bool animating_; // Whether animation is on or off
-			bool space_down_; // Whether space key was pressed
-
-			// Input managers
-			OIS::InputManager *input_manager_;
-			OIS::Mouse *mouse_;
-			OIS::Keyboard *keyboard_;
-
-			// Objects used for compositor
-			Ogre::Camera* camera_;
-			float elapsed_time_;
-			MaterialListener material_listener_;
-			int effect;
-			#define NUM_ELEMENTS 6 // Number of elements in the chain
-			#define NUM_ELEMENTS_TORUS 2
-			Ogre::SceneNode* torus_[NUM_ELEMENTS_TORUS]; 
-			Ogre::SceneNode* cylinder_[NUM_ELEMENTS*2];
-
-			/* Methods to initialize the application */
-			void InitRootNode(void);
-			void InitPlugins(void);
-			void InitRenderSystem(void);
-			void InitWindow(void);
-			void InitViewport(void);
-			void InitFrameListener(void);
-			void InitOIS(void);
-			void LoadMaterials(void);
-			void InitCompositor(void);
-			/* Methods to handle events */
-			bool frameEnded(const Ogre::FrameEvent &fe); 	
-			bool frameRenderingQueued(const Ogre::FrameEvent& fe);
-
-    }; // class OgreApplication
-
-} // namespace ogre_application;
-
-#endif // OGRE_APPLICATION_H_
+#ifndef OGRE_APPLICATION_H_
+#define OGRE_APPLICATION_H_
+
+#include <exception>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <list>
+
+#include "OGRE/OgreRoot.h"
+#include "OGRE/OgreViewport.h"
+#include "OGRE/OgreCamera.h"
+#include "OGRE/OgreHardwarePixelBuffer.h"
+#include "OGRE/OgreRenderSystem.h"
+#include "OGRE/OgreRenderWindow.h"
+#include "OGRE/OgreWindowEventUtilities.h"
+#include "OGRE/OgreManualObject.h"
+#include "OGRE/OgreEntity.h"
+#include "OGRE/OgrePass.h"
+#include "OGRE/OgreAnimation.h"
+#include "OGRE/OgreCompositorManager.h"
+#include "OGRE/OgreCompositorInstance.h"
+#include "OGRE/OgreCompositorChain.h"
+#include "OGRE/OgreCompositionTechnique.h"
+#include "OGRE/OgreTextureManager.h"
+#include "OGRE/OgreImage.h"
+#include "OGRE/OgreLogManager.h"
+#include "OGRE/OgreStringConverter.h"
+#include "OIS/OIS.h"
+
+#include "mesh_cache.h"
+#include "mapped_file.h"
+#include "texture_compression.h"
+#include "clustered_lighting.h"
+#include "overdraw_counter.h"
+#include "frame_capture.h"
+#include "effect_graph.h"
+#include "vertex_compression.h"
+#include "static_batcher.h"
+#include "render_counters.h"
+#include "frame_snapshot.h"
+#include "bloom.h"
+#include "scene_file.h"
+#include "arena.h"
+#include "memory_stats.h"
+#include "input_recording.h"
+#include "occlusion_culler.h"
+#include "multi_view.h"
+
+namespace ogre_application {
+
+
+	/* A useful type to define */
+	typedef std::vector<Ogre::String> Strings;
+
+	/* Our exception type */
+	class OgreAppException: public std::exception
+    {
+		private:
+		    std::string message_;
+	    public:
+			OgreAppException(std::string message) : message_(message) {};
+			virtual const char* what() const throw() { return message_.c_str(); };
+	};
+
+	/* Material listener for updating the compositor materials */
+	class OgreApplication;
+	class MaterialListener : public Ogre::CompositorInstance::Listener
+	{
+		public:
+			void Init(OgreApplication *app, int view = -1); // Effect of a view, or of the main view
+			virtual void notifyMaterialSetup(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat);
+			virtual void notifyMaterialRender(Ogre::uint32 pass_id, Ogre::MaterialPtr &mat);
+
+		private:
+			OgreApplication *app_;
+			int view_;
+	};
+
+	/* Our Ogre application */
+	class OgreApplication :
+	    public Ogre::FrameListener, // Derive from FrameListener to be able to have event callbacks
+        public Ogre::WindowEventListener {
+
+		friend class MaterialListener;
+
+        public:
+            OgreApplication(void);
+            void Init(void); // Call Init() before running the main loop
+			// Create geometry of a torus and add it to the available resources
+			void CreateTorusGeometry(Ogre::String object_name, float loop_radius = 0.6, float circle_radius = 0.2, int num_loop_samples = 90, int num_circle_samples = 30); 
+			// Create an entity of an object that we can show on the screen
+            void CreateEntity(Ogre::String entity_name, Ogre::String object_name, Ogre::String material_name);
+			void SetupAnimation(Ogre::String entity_name); // Setup animation for an object
+            void MainLoop(void); // Keep application active
+
+			void CreateCylinder(void); // Create the geometry for a single Cylinder
+			void CreateMultipleCylinders(void);
+			void CreateTorus(Ogre::String object_name, Ogre::String material_name, float loop_radius = 0.6, float circle_radius = 0.2, int num_loop_samples = 90, int num_circle_samples = 30); // Create an object to show on the screen
+			void CreateMultipleTorus(void);
+			void SetMeshCacheMode(MeshCache::Mode mode); // Call after Init()
+			void SetVertexLayout(VertexLayout layout); // Call after Init(), applies to meshes created afterwards
+			int GetNumCompressionFailures(void) const { return num_compression_failures_; } // Meshes whose decode errors exceed the tolerances
+
+			// Binary scene files (see SceneFile); the meshes they use have to be created first
+			void LoadScene(Ogre::String file_name, bool mark_static = true); // Under the root node, with the file's occluders and static nodes
+			void SaveScene(Ogre::String file_name, Ogre::String node_name, bool node_static = false, float region_size = 0.0); // The subtree under a node, before MarkStatic()
+			void GenerateScene(Ogre::String file_name, int num_nodes); // Grid of cylinders and tori, for load tests
+
+			// Merge the entities under a scene node that does not change into few draw calls
+			void MarkStatic(Ogre::String node_name, float region_size = 0.0); // 0 for the default region size
+			void RebuildStatic(Ogre::String node_name); // Call after changing anything under the node
+			void UnmarkStatic(Ogre::String node_name);
+
+			// Dynamic point lights of the clustered lighting path
+			int AddPointLight(Ogre::Vector3 position, float radius, Ogre::ColourValue colour = Ogre::ColourValue::White, float intensity = 1.0);
+			void RemovePointLight(int light_id);
+			void SetPointLightPosition(int light_id, Ogre::Vector3 position);
+
+			// Forward rendering or deferred shading through the DeferredShading compositor
+			void SetRenderPath(bool deferred);
+			// Render num_frames with each path, report the averages and quit; call before Init()
+			void SetBenchmark(int num_frames);
+			// Render num_frames without and with frame capture (nothing written), report the averages and quit; call before Init()
+			void SetCaptureBenchmark(int num_frames);
+			// Order opaque passes by program, then texture, to save state changes; call before Init()
+			void SetStateSorting(bool sort);
+			// Skip entities hidden behind the occluders, found with occlusion queries a frame late
+			void SetOcclusionCulling(bool cull);
+			// Draw the entities of a node into the occlusion depth buffer; call before MarkStatic()
+			void AddOccluder(Ogre::String node_name);
+			// Glow around what is brighter than threshold; num_levels halvings, 0 turns it off, only apply before Init()
+			void SetBloom(float threshold, float intensity, int num_levels);
+			// Distort the screen with a ring growing from centre (screen texture coordinates, top left is 0, 0)
+			// at speed screen widths per second; it is removed once it left the screen
+			void SpawnShockwave(Ogre::Vector2 centre, float speed = 0.5, float strength = 1.0);
+			// Simulate on a thread of its own, overlapping with rendering; call before MainLoop()
+			void SetThreaded(bool threaded);
+			// Write the input of every simulation step and the frame times to a file; call before MainLoop()
+			void RecordInput(Ogre::String file_name);
+			// Take the input from a recording instead of the devices, one fixed step per frame,
+			// and quit at its end; call before MainLoop(), the simulation is not threaded then
+			void ReplayInput(Ogre::String file_name);
+			// Write the time of every frame and the simulation step it showed, to compare runs
+			void SetFrameTrace(Ogre::String file_name);
+
+			// Write the composited frames to directory as they are rendered; an empty region captures the whole viewport
+			void StartCapture(Ogre::String directory, int subsample = 1, const Ogre::Box &region = Ogre::Box());
+			void StopCapture(void);
+
+			// Apply a chain of screen-space effects ("waver", "blur", "tile", "wipe", "heartbeat",
+			// "shockwave") with the fewest full-screen passes; an empty chain removes it
+			void SetEffectChain(const std::vector<Ogre::String> &chain);
+
+			// Log live and peak memory per category (also the M key)
+			void DumpMemoryStats(void);
+
+			// More views of the scene, drawn over the main view in the order added, in window
+			// coordinates (0 to 1) and with their own ScreenSpaceEffect; a view with the main
+			// camera ("MyCamera") reuses its scene. Returns the view's index
+			int AddView(Ogre::String camera_name, float left, float top, float width, float height, int effect = 0);
+			void SetViewEffect(int view, int effect);
+			// Camera for views, with the clip distances of the main camera; fov_y in degrees
+			void CreateCamera(Ogre::String camera_name, Ogre::Vector3 position, Ogre::Vector3 look_at, float fov_y = 45.0);
+			// Move the main view, e.g. to one half of the window for split screen
+			void SetMainViewDimensions(float left, float top, float width, float height);
+
+        private:
+			// Create root that allows us to access Ogre commands
+            std::auto_ptr<Ogre::Root> ogre_root_;
+            // Application main Ogre window
+            Ogre::RenderWindow* ogre_window_;
+
+			// For animating the sphere
+			Ogre::Animation *animation_; // Sampled by Simulate()
+			bool animating_; // Whether animation is on or off
+			bool space_down_; // Whether space key was pressed
+			bool l_down_; // Whether L key was pressed
+			bool mouse_down_; // Whether the left mouse button was pressed
+			bool r_down_; // Whether R key was pressed
+			bool p_down_; // Whether P key was pressed
+			bool s_down_; // Whether S key was pressed
+			bool m_down_; // Whether M key was pressed
+			bool o_down_; // Whether O key was pressed
+			bool quit_; // Leave the main loop
+
+			// Simulation of animation, input and effects; on its own thread when threaded_
+			bool threaded_;
+			FrameSnapshot simulation_state_; // Only touched by the simulation
+			TripleBuffer<FrameSnapshot> snapshots_; // From the simulation thread to rendering
+			FrameSnapshot applied_; // Last snapshot applied, without transforms
+			std::thread simulation_thread_;
+			std::atomic<bool> simulation_quit_;
+			std::vector<Shockwave> shockwave_events_; // Spawned since the last simulation step
+			std::mutex shockwave_mutex_;
+			ShockwavePool shockwaves_; // Of the snapshot last applied, uploaded by MaterialListener
+			InputRecorder input_recorder_;
+			InputReplay input_replay_;
+			InputRecorder frame_trace_; // Only gets frames
+			float step_time_; // Not yet simulated, when recording without a simulation thread
+
+			// Input managers
+			OIS::InputManager *input_manager_;
+			OIS::Mouse *mouse_;
+			OIS::Keyboard *keyboard_;
+
+			// Objects used for compositor
+			Ogre::Camera* camera_;
+			Ogre::Viewport *viewport_; // Main view; the camera's last viewport may be another view
+			float elapsed_time_;
+			MaterialListener material_listener_;
+			int effect;
+			#define NUM_ELEMENTS 6 // Number of elements in the chain
+			#define NUM_ELEMENTS_TORUS 2
+			Ogre::SceneNode* torus_[NUM_ELEMENTS_TORUS]; 
+			Ogre::SceneNode* cylinder_[NUM_ELEMENTS*2];
+
+			// Cache for generated meshes
+			MeshCache mesh_cache_;
+			VertexLayout vertex_layout_; // Layout of generated meshes
+			int num_compression_failures_;
+			StaticBatcher static_batcher_;
+			std::vector<Ogre::String> static_nodes_; // Nodes marked static, unmarked with the S key
+			SceneFile scene_file_; // Nodes and entities of the loaded scene
+			bool static_batching_;
+			Arena construction_arena_; // Transient data of the mesh generators, reset after each mesh
+			MemoryStats memory_stats_;
+
+			// Lights of the Shiny* materials
+			ClusteredLighting clustered_lighting_;
+
+			// Render path and its statistics
+			bool deferred_shading_;
+			Ogre::CompositorInstance *deferred_instance_;
+			Ogre::CompositorInstance *screen_space_instance_;
+			OverdrawCounter scene_counter_; // Forward scene pass
+			OverdrawCounter gbuffer_counter_; // Deferred geometry pass
+			Ogre::RenderTarget *scene_target_; // Target the scene is rendered into, for draw call counts
+			RenderCounters render_counters_; // State changes per frame and per compositor target
+			OcclusionCuller occlusion_culler_;
+			bool occlusion_culling_;
+			bool state_sorting_;
+			int stats_frames_;
+			float stats_time_;
+			int benchmark_frames_; // Frames measured per render path, 0 when not benchmarking
+			int benchmark_frame_;
+			double benchmark_time_[2];
+			double benchmark_fragments_[2];
+			double benchmark_bandwidth_[2];
+			int capture_benchmark_frames_; // Frames measured without and with capture, 0 when not benchmarking
+			int capture_benchmark_frame_;
+			double capture_benchmark_time_[2];
+
+			// Glow added by ScreenSpaceEffect
+			Bloom bloom_;
+			int bloom_levels_;
+
+			// Readback of the composited frames
+			FrameCapture frame_capture_;
+			Ogre::CompositorInstance *capture_instance_;
+
+			// Fused chain of screen-space effects
+			EffectGraph effect_graph_;
+			Ogre::String effect_chain_name_; // Compositor of the current chain, empty if none
+
+			// Further views and their ScreenSpaceEffect parameters
+			MultiView multi_view_;
+			std::list<MaterialListener> view_listeners_; // Registered by address
+			std::vector<int> view_effects_;
+
+			/* Methods to initialize the application */
+			void InitRootNode(void);
+			void InitPlugins(void);
+			void InitRenderSystem(void);
+			void InitWindow(void);
+			void InitViewport(void);
+			void InitFrameListener(void);
+			void InitOIS(void);
+			void LoadMaterials(void);
+			void LoadCompressedTextures(Ogre::String resource_group_name);
+			void InitCompositor(void);
+			void InitLighting(Ogre::String resource_group_name);
+			void InitOverdrawCounters(void);
+			void ShutdownOverdrawCounters(void);
+			void InitRenderCounters(void);
+			void UpdateRenderStats(float frame_time);
+			void UpdateBenchmark(float frame_time);
+			void UpdateCaptureBenchmark(float frame_time);
+			void CompressMesh(const Ogre::MeshPtr &mesh);
+			Ogre::Entity *CreateMeshEntity(Ogre::String entity_name, Ogre::String mesh_name);
+			void AddStaging(Ogre::ManualObject *object); // Right after end()
+			void ReleaseStaging(Ogre::ManualObject *object); // After convertToMesh()
+			void Simulate(float time_step, FrameSnapshot &state);
+			void ApplySnapshot(const FrameSnapshot &snapshot);
+			void SimulationMain(void);
+			void StopSimulation(void);
+			/* Methods to handle events */
+			bool frameStarted(const Ogre::FrameEvent &fe);
+			bool frameEnded(const Ogre::FrameEvent &fe); 	
+			bool frameRenderingQueued(const Ogre::FrameEvent& fe);
+
+    }; // class OgreApplication
+
+} // namespace ogre_application;
+
+#endif // OGRE_APPLICATION_H_
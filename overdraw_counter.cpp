@@ -0,0 +1,119 @@
+#include "overdraw_counter.h"
+
+namespace ogre_application {
+
+
+OverdrawCounter::OverdrawCounter(void){
+
+	render_system_ = NULL;
+	target_ = NULL;
+	for (int i = 0; i < num_queries_; i++){
+		queries_[i] = NULL;
+		issued_[i] = false;
+	}
+	current_query_ = 0;
+	query_active_ = false;
+	enabled_ = true;
+	fragments_ = 0;
+	bytes_per_fragment_ = 0;
+	bytes_per_pixel_ = 0;
+}
+
+
+OverdrawCounter::~OverdrawCounter(void){
+
+	Shutdown();
+}
+
+
+void OverdrawCounter::Init(Ogre::RenderSystem *render_system, Ogre::RenderTarget *target, size_t bytes_per_fragment, size_t bytes_per_pixel){
+
+	Shutdown();
+
+	render_system_ = render_system;
+	target_ = target;
+	bytes_per_fragment_ = bytes_per_fragment;
+	bytes_per_pixel_ = bytes_per_pixel;
+
+	for (int i = 0; i < num_queries_; i++){
+		queries_[i] = render_system_->createHardwareOcclusionQuery();
+		issued_[i] = false;
+	}
+	target_->addListener(this);
+}
+
+
+void OverdrawCounter::Shutdown(void){
+
+	if (target_){
+		target_->removeListener(this);
+	}
+	for (int i = 0; i < num_queries_; i++){
+		if (queries_[i]){
+			render_system_->destroyHardwareOcclusionQuery(queries_[i]);
+		}
+		queries_[i] = NULL;
+		issued_[i] = false;
+	}
+	target_ = NULL;
+	query_active_ = false;
+}
+
+
+void OverdrawCounter::preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	if (!enabled_){
+		return;
+	}
+
+	/* Collect the result of the query issued a frame ago, if it is ready */
+	for (int i = 0; i < num_queries_; i++){
+		if (issued_[i] && !queries_[i]->isStillOutstanding()){
+			unsigned int fragments;
+			if (queries_[i]->pullOcclusionQuery(&fragments)){
+				fragments_ = fragments;
+			}
+			issued_[i] = false;
+		}
+	}
+
+	/* Reuse a query only once its result has been read, never wait for it */
+	current_query_ = (current_query_ + 1) % num_queries_;
+	if (issued_[current_query_]){
+		return;
+	}
+	queries_[current_query_]->beginOcclusionQuery();
+	query_active_ = true;
+}
+
+
+void OverdrawCounter::postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	if (!query_active_){
+		return;
+	}
+	queries_[current_query_]->endOcclusionQuery();
+	issued_[current_query_] = true;
+	query_active_ = false;
+}
+
+
+float OverdrawCounter::GetOverdraw(void) const {
+
+	if (!target_ || target_->getWidth() == 0 || target_->getHeight() == 0){
+		return 0.0f;
+	}
+	return (float) fragments_/(target_->getWidth()*target_->getHeight());
+}
+
+
+double OverdrawCounter::GetBandwidth(void) const {
+
+	if (!target_){
+		return 0.0;
+	}
+	return (double) fragments_*bytes_per_fragment_ + (double) target_->getWidth()*target_->getHeight()*bytes_per_pixel_;
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,53 @@
+#ifndef OVERDRAW_COUNTER_H_
+#define OVERDRAW_COUNTER_H_
+
+#include "OGRE/OgreRenderTarget.h"
+#include "OGRE/OgreRenderTargetListener.h"
+#include "OGRE/OgreRenderSystem.h"
+#include "OGRE/OgreHardwareOcclusionQuery.h"
+
+namespace ogre_application {
+
+	/* Counts the fragments written to a render target with occlusion queries */
+	/* Results are read back a frame late so the pipeline never stalls. Bandwidth is an
+	   estimate from the fragment count and the bytes the target's passes touch per fragment
+	   and per pixel; texture reads by the shaders are not included */
+	class OverdrawCounter : public Ogre::RenderTargetListener
+	{
+		public:
+			OverdrawCounter(void);
+			~OverdrawCounter(void);
+
+			// bytes_per_fragment: colour and depth traffic of every fragment that passes the depth test
+			// bytes_per_pixel: traffic paid once per pixel, e.g. a full-screen pass that reads the target
+			void Init(Ogre::RenderSystem *render_system, Ogre::RenderTarget *target, size_t bytes_per_fragment, size_t bytes_per_pixel);
+			void Shutdown(void);
+			void SetEnabled(bool enabled) { enabled_ = enabled; }
+
+			virtual void preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+			virtual void postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+
+			// Results of the most recent frame whose query has completed
+			unsigned int GetFragments(void) const { return fragments_; }
+			float GetOverdraw(void) const; // Fragments per pixel of the target
+			double GetBandwidth(void) const; // Estimated bytes per frame
+
+		private:
+			static const int num_queries_ = 2;
+
+			Ogre::RenderSystem *render_system_;
+			Ogre::RenderTarget *target_;
+			Ogre::HardwareOcclusionQuery *queries_[num_queries_];
+			bool issued_[num_queries_];
+			int current_query_;
+			bool query_active_;
+			bool enabled_;
+
+			unsigned int fragments_;
+			size_t bytes_per_fragment_;
+			size_t bytes_per_pixel_;
+	};
+
+} // namespace ogre_application;
+
+#endif // OVERDRAW_COUNTER_H_
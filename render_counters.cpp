@@ -0,0 +1,196 @@
+#include "OGRE/OgrePass.h"
+#include "OGRE/OgreTextureUnitState.h"
+#include "OGRE/OgreGpuProgramParams.h"
+
+#include "render_counters.h"
+
+namespace ogre_application {
+
+
+static void ResetCounts(RenderCounts &counts){
+
+	counts.program_binds = 0;
+	counts.texture_binds = 0;
+	counts.uniform_uploads = 0;
+	counts.draw_calls = 0;
+}
+
+
+/* Named constants of a program's parameters that a bind with this variability mask sets */
+static int CountUploads(const Ogre::GpuProgramParametersSharedPtr &params, Ogre::uint16 mask){
+
+	if (params.isNull() || !params->hasNamedParameters()){
+		return 0;
+	}
+	int count = 0;
+	const Ogre::GpuConstantDefinitionMap &constants = params->getConstantDefinitions().map;
+	for (Ogre::GpuConstantDefinitionMap::const_iterator it = constants.begin(); it != constants.end(); it++){
+		if (it->second.variability & mask){
+			count++;
+		}
+	}
+	return count;
+}
+
+
+RenderCounters::RenderCounters(void){
+
+	scene_manager_ = NULL;
+	last_pass_ = NULL;
+	last_lights_hash_ = 0;
+	lights_known_ = false;
+	ResetCounts(counts_);
+	ResetCounts(frame_counts_);
+}
+
+
+RenderCounters::~RenderCounters(void){
+
+	Shutdown();
+}
+
+
+void RenderCounters::Init(Ogre::SceneManager *scene_manager){
+
+	Shutdown();
+	scene_manager_ = scene_manager;
+	scene_manager_->addRenderObjectListener(this);
+}
+
+
+void RenderCounters::Shutdown(void){
+
+	ClearTargets();
+	if (scene_manager_){
+		scene_manager_->removeRenderObjectListener(this);
+	}
+	scene_manager_ = NULL;
+}
+
+
+void RenderCounters::AddTarget(Ogre::RenderTarget *target, Ogre::String name){
+
+	Target entry;
+	entry.target = target;
+	entry.name = name;
+	ResetCounts(entry.start);
+	ResetCounts(entry.counts);
+	ResetCounts(entry.frame_counts);
+	targets_.push_back(entry);
+	target->addListener(this);
+}
+
+
+void RenderCounters::ClearTargets(void){
+
+	for (size_t i = 0; i < targets_.size(); i++){
+		targets_[i].target->removeListener(this);
+	}
+	targets_.clear();
+}
+
+
+void RenderCounters::BeginFrame(void){
+
+	frame_counts_ = counts_;
+	ResetCounts(counts_);
+	for (size_t i = 0; i < targets_.size(); i++){
+		targets_[i].frame_counts = targets_[i].counts;
+		ResetCounts(targets_[i].counts);
+	}
+
+	/* The render system keeps its state between frames, but not reliably across targets */
+	last_pass_ = NULL;
+	last_programs_.clear();
+	last_textures_.clear();
+	lights_known_ = false;
+}
+
+
+void RenderCounters::notifyRenderSingleObject(Ogre::Renderable *rend, const Ogre::Pass *pass, const Ogre::AutoParamDataSource *source,
+	const Ogre::LightList *light_list, bool suppress_render_state_changes){
+
+	counts_.draw_calls++;
+
+	/* The scene manager binds the parameters of every draw with the variabilities that
+	   changed since the last one: per object always, global after a pass change, lights
+	   after the light list changed. The render system then sets only the constants with
+	   one of them */
+	Ogre::uint16 mask = Ogre::GPV_PER_OBJECT;
+	Ogre::uint32 lights_hash = light_list ? light_list->getHash() : 0;
+	if (!lights_known_ || lights_hash != last_lights_hash_){
+		mask |= Ogre::GPV_LIGHTS;
+		last_lights_hash_ = lights_hash;
+		lights_known_ = true;
+	}
+
+	if (pass != last_pass_ && !suppress_render_state_changes){
+		last_pass_ = pass;
+
+		/* GLSL links the two stages into one program object */
+		Ogre::String programs = (pass->hasVertexProgram() ? pass->getVertexProgramName() : "") + "|" +
+		                        (pass->hasFragmentProgram() ? pass->getFragmentProgramName() : "");
+		if (programs != last_programs_){
+			counts_.program_binds++;
+			last_programs_ = programs;
+		}
+
+		unsigned short num_units = pass->getNumTextureUnitStates();
+		if (last_textures_.size() < num_units){
+			last_textures_.resize(num_units);
+		}
+		for (unsigned short i = 0; i < num_units; i++){
+			const Ogre::TexturePtr &texture = pass->getTextureUnitState(i)->_getTexturePtr();
+			Ogre::String texture_name = texture.isNull() ? "" : texture->getName();
+			if (texture_name != last_textures_[i]){
+				counts_.texture_binds++;
+				last_textures_[i] = texture_name;
+			}
+		}
+
+		mask |= Ogre::GPV_GLOBAL;
+	}
+
+	if (pass->hasVertexProgram()){
+		counts_.uniform_uploads += CountUploads(pass->getVertexProgramParameters(), mask);
+	}
+	if (pass->hasFragmentProgram()){
+		counts_.uniform_uploads += CountUploads(pass->getFragmentProgramParameters(), mask);
+	}
+}
+
+
+RenderCounters::Target *RenderCounters::FindTarget(Ogre::RenderTarget *target){
+
+	for (size_t i = 0; i < targets_.size(); i++){
+		if (targets_[i].target == target){
+			return &targets_[i];
+		}
+	}
+	return NULL;
+}
+
+
+void RenderCounters::preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	Target *target = FindTarget(evt.source);
+	if (target){
+		target->start = counts_;
+	}
+}
+
+
+void RenderCounters::postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt){
+
+	Target *target = FindTarget(evt.source);
+	if (!target){
+		return;
+	}
+	target->counts.program_binds += counts_.program_binds - target->start.program_binds;
+	target->counts.texture_binds += counts_.texture_binds - target->start.texture_binds;
+	target->counts.uniform_uploads += counts_.uniform_uploads - target->start.uniform_uploads;
+	target->counts.draw_calls += counts_.draw_calls - target->start.draw_calls;
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,80 @@
+#ifndef RENDER_COUNTERS_H_
+#define RENDER_COUNTERS_H_
+
+#include <vector>
+
+#include "OGRE/OgreSceneManager.h"
+#include "OGRE/OgreRenderObjectListener.h"
+#include "OGRE/OgreRenderTarget.h"
+#include "OGRE/OgreRenderTargetListener.h"
+
+namespace ogre_application {
+
+	/* State changes and draws of a frame or of one render target */
+	struct RenderCounts
+	{
+		int program_binds; // Changes of the linked vertex and fragment program pair
+		int texture_binds; // Texture units whose texture changed
+		int uniform_uploads; // Named constants set, picked by their variability as Ogre does
+		int draw_calls;
+	};
+
+	/* Counts the state changes the scene manager issues */
+	/* Every renderable is seen just before it is drawn, together with its pass, so the
+	   counts follow the order the render queue produced. Counts of registered targets
+	   (the compositor passes) are kept separately; everything else is only in the total */
+	class RenderCounters : public Ogre::RenderObjectListener, public Ogre::RenderTargetListener
+	{
+		public:
+			RenderCounters(void);
+			~RenderCounters(void);
+
+			void Init(Ogre::SceneManager *scene_manager);
+			void Shutdown(void);
+
+			// Keep separate counts for a target, under the given name
+			void AddTarget(Ogre::RenderTarget *target, Ogre::String name);
+			void ClearTargets(void);
+
+			// Call once per frame before rendering; the counts of the previous frame become available
+			void BeginFrame(void);
+
+			// Counts of the last complete frame
+			const RenderCounts &GetFrameCounts(void) const { return frame_counts_; }
+			int GetNumTargets(void) const { return (int) targets_.size(); }
+			const Ogre::String &GetTargetName(int index) const { return targets_[index].name; }
+			const RenderCounts &GetTargetCounts(int index) const { return targets_[index].frame_counts; }
+
+			virtual void notifyRenderSingleObject(Ogre::Renderable *rend, const Ogre::Pass *pass, const Ogre::AutoParamDataSource *source,
+				const Ogre::LightList *light_list, bool suppress_render_state_changes);
+			virtual void preRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+			virtual void postRenderTargetUpdate(const Ogre::RenderTargetEvent &evt);
+
+		private:
+			struct Target
+			{
+				Ogre::RenderTarget *target;
+				Ogre::String name;
+				RenderCounts start; // Totals when its update began
+				RenderCounts counts; // Of the frame being rendered
+				RenderCounts frame_counts; // Of the last complete frame
+			};
+
+			Ogre::SceneManager *scene_manager_;
+			std::vector<Target> targets_;
+			RenderCounts counts_; // Of the frame being rendered
+			RenderCounts frame_counts_;
+
+			// State of the last pass, to see what changed
+			const Ogre::Pass *last_pass_;
+			Ogre::String last_programs_;
+			std::vector<Ogre::String> last_textures_;
+			Ogre::uint32 last_lights_hash_;
+			bool lights_known_;
+
+			Target *FindTarget(Ogre::RenderTarget *target);
+	};
+
+} // namespace ogre_application;
+
+#endif // RENDER_COUNTERS_H_
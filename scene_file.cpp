@@ -0,0 +1,453 @@
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+#include "OGRE/OgreMeshManager.h"
+#include "OGRE/OgreMaterialManager.h"
+#include "OGRE/OgreSubEntity.h"
+#include "OGRE/OgreSubMesh.h"
+#include "OGRE/OgreMath.h"
+#include "OGRE/OgreStringConverter.h"
+
+#include "scene_file.h"
+#include "vertex_compression.h"
+#include "occlusion_culler.h"
+#include "ogre_application.h"
+
+namespace ogre_application {
+
+/* File format constants */
+/* Bump the version whenever the layout changes */
+const char scene_file_magic_g[4] = { 'O', 'S', 'C', 'N' };
+const Ogre::uint32 scene_file_version_g = 3;
+/* Parent of the top nodes, mesh or material set of nodes without one, and material of
+   submeshes that keep their own */
+const Ogre::uint32 scene_file_none_g = 0xFFFFFFFF;
+/* Node flags */
+const Ogre::uint32 scene_file_occluder_g = 1; // The node's entity draws into the occlusion depth buffer
+const Ogre::uint32 scene_file_static_g = 2; // The subtree under the node is batched
+/* Node records per chunk */
+const Ogre::uint32 scene_file_chunk_size_g = 4096;
+/* Children of a group node in SaveGrid() */
+const int scene_grid_group_size_g = 64;
+const float scene_grid_spacing_g = 3.0;
+
+/* Node record as stored on disk, in host byte order */
+struct SceneFileNode
+{
+	Ogre::uint32 parent; // Index of an earlier node
+	float position[3]; // Relative to the parent
+	float orientation[4]; // w, x, y, z
+	float scale[3];
+	Ogre::uint32 mesh; // Index into the mesh table
+	Ogre::uint32 material; // Index into the material set table, none keeps the mesh's
+	Ogre::uint32 flags;
+	float region_size; // Of the static batch, 0 for the batcher's default
+};
+
+
+/* Helpers to write the file */
+static void WriteBytes(std::vector<unsigned char> &out, const void *data, size_t size){
+
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+	out.insert(out.end(), bytes, bytes + size);
+}
+
+
+static void WriteUint32(std::vector<unsigned char> &out, Ogre::uint32 value){
+
+	WriteBytes(out, &value, sizeof(value));
+}
+
+
+static void WriteString(std::vector<unsigned char> &out, const Ogre::String &value){
+
+	WriteUint32(out, (Ogre::uint32) value.size());
+	WriteBytes(out, value.data(), value.size());
+	while (out.size() % 4 != 0){
+		out.push_back(0);
+	}
+}
+
+
+static void WriteFile(const Ogre::String &path, const std::vector<Ogre::String> &meshes, const std::vector<Ogre::String> &materials,
+	const std::vector<std::vector<Ogre::uint32> > &material_sets, const std::vector<SceneFileNode> &nodes){
+
+	std::vector<unsigned char> out;
+	out.reserve(64 + nodes.size()*sizeof(SceneFileNode) + (nodes.size()/scene_file_chunk_size_g + 1)*sizeof(Ogre::uint32));
+	WriteBytes(out, scene_file_magic_g, sizeof(scene_file_magic_g));
+	WriteUint32(out, scene_file_version_g);
+	WriteUint32(out, (Ogre::uint32) nodes.size());
+	WriteUint32(out, (Ogre::uint32) meshes.size());
+	for (size_t i = 0; i < meshes.size(); i++){
+		WriteString(out, meshes[i]);
+	}
+	WriteUint32(out, (Ogre::uint32) materials.size());
+	for (size_t i = 0; i < materials.size(); i++){
+		WriteString(out, materials[i]);
+	}
+	WriteUint32(out, (Ogre::uint32) material_sets.size());
+	for (size_t i = 0; i < material_sets.size(); i++){
+		WriteUint32(out, (Ogre::uint32) material_sets[i].size());
+		for (size_t j = 0; j < material_sets[i].size(); j++){
+			WriteUint32(out, material_sets[i][j]);
+		}
+	}
+
+	for (size_t first = 0; first < nodes.size(); first += scene_file_chunk_size_g){
+		Ogre::uint32 count = (Ogre::uint32) std::min<size_t>(scene_file_chunk_size_g, nodes.size() - first);
+		WriteUint32(out, count);
+		WriteBytes(out, &nodes[first], count*sizeof(SceneFileNode));
+	}
+
+	std::ofstream stream(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!stream){
+		throw(OgreAppException(std::string("SceneFile::Exception: Could not write ") + path));
+	}
+	stream.write((const char *) &out[0], out.size());
+}
+
+
+static Ogre::uint32 FindOrAdd(std::vector<Ogre::String> &table, std::map<Ogre::String, Ogre::uint32> &indices, const Ogre::String &name){
+
+	std::map<Ogre::String, Ogre::uint32>::iterator it = indices.find(name);
+	if (it != indices.end()){
+		return it->second;
+	}
+	Ogre::uint32 index = (Ogre::uint32) table.size();
+	table.push_back(name);
+	indices[name] = index;
+	return index;
+}
+
+
+static SceneFileNode MakeNode(Ogre::uint32 parent, const Ogre::Vector3 &position, const Ogre::Quaternion &orientation, const Ogre::Vector3 &scale){
+
+	SceneFileNode node;
+	node.parent = parent;
+	node.position[0] = position.x;
+	node.position[1] = position.y;
+	node.position[2] = position.z;
+	node.orientation[0] = orientation.w;
+	node.orientation[1] = orientation.x;
+	node.orientation[2] = orientation.y;
+	node.orientation[3] = orientation.z;
+	node.scale[0] = scale.x;
+	node.scale[1] = scale.y;
+	node.scale[2] = scale.z;
+	node.mesh = scene_file_none_g;
+	node.material = scene_file_none_g;
+	node.flags = 0;
+	node.region_size = 0.0f;
+	return node;
+}
+
+
+void SceneFile::Save(const Ogre::String &path, Ogre::SceneNode *root, bool root_static, float region_size){
+
+	std::vector<Ogre::String> meshes, materials, material_set_keys;
+	std::map<Ogre::String, Ogre::uint32> mesh_indices, material_indices, material_set_indices;
+	std::vector<std::vector<Ogre::uint32> > material_sets;
+	std::vector<SceneFileNode> nodes;
+
+	/* Depth first, so that parents are written before their children */
+	std::vector<std::pair<Ogre::SceneNode *, Ogre::uint32> > stack;
+	stack.push_back(std::make_pair(root, scene_file_none_g));
+	while (!stack.empty()){
+		Ogre::SceneNode *scene_node = stack.back().first;
+		Ogre::uint32 parent = stack.back().second;
+		stack.pop_back();
+
+		Ogre::uint32 index = (Ogre::uint32) nodes.size();
+		nodes.push_back(MakeNode(parent, scene_node->getPosition(), scene_node->getOrientation(), scene_node->getScale()));
+
+		/* The first entity goes on the node itself, any others on untransformed children */
+		bool first = true;
+		Ogre::SceneNode::ObjectIterator objects = scene_node->getAttachedObjectIterator();
+		while (objects.hasMoreElements()){
+			Ogre::MovableObject *object = objects.getNext();
+			if (object->getMovableType() != "Entity"){
+				continue;
+			}
+			Ogre::Entity *entity = static_cast<Ogre::Entity *>(object);
+			Ogre::uint32 record = index;
+			if (!first){
+				record = (Ogre::uint32) nodes.size();
+				nodes.push_back(MakeNode(index, Ogre::Vector3::ZERO, Ogre::Quaternion::IDENTITY, Ogre::Vector3::UNIT_SCALE));
+			}
+			first = false;
+
+			nodes[record].mesh = FindOrAdd(meshes, mesh_indices, entity->getMesh()->getName());
+			if (entity->getVisibilityFlags() & OcclusionCuller::occluder_flag){
+				nodes[record].flags |= scene_file_occluder_g;
+			}
+
+			/* A material per submesh, written only where it differs from the mesh's */
+			std::vector<Ogre::uint32> material_set(entity->getNumSubEntities(), scene_file_none_g);
+			Ogre::String key;
+			bool changed = false;
+			for (unsigned int s = 0; s < entity->getNumSubEntities(); s++){
+				const Ogre::String &material_name = entity->getSubEntity(s)->getMaterialName();
+				if (material_name != entity->getMesh()->getSubMesh(s)->getMaterialName()){
+					material_set[s] = FindOrAdd(materials, material_indices, material_name);
+					changed = true;
+				}
+				key += Ogre::StringConverter::toString((unsigned long) material_set[s]) + ",";
+			}
+			if (changed){
+				nodes[record].material = FindOrAdd(material_set_keys, material_set_indices, key);
+				if (nodes[record].material == material_sets.size()){
+					material_sets.push_back(material_set);
+				}
+			}
+		}
+
+		Ogre::Node::ChildNodeIterator children = scene_node->getChildIterator();
+		while (children.hasMoreElements()){
+			stack.push_back(std::make_pair(static_cast<Ogre::SceneNode *>(children.getNext()), index));
+		}
+	}
+
+	if (root_static){
+		nodes[0].flags |= scene_file_static_g;
+		nodes[0].region_size = region_size;
+	}
+
+	WriteFile(path, meshes, materials, material_sets, nodes);
+}
+
+
+void SceneFile::SaveGrid(const Ogre::String &path, const std::vector<Ogre::String> &mesh_names, int num_nodes){
+
+	std::vector<SceneFileNode> nodes;
+	nodes.reserve(num_nodes);
+	std::vector<Ogre::String> materials;
+	std::vector<std::vector<Ogre::uint32> > material_sets;
+
+	/* A root, group nodes on a square grid and their children on a smaller grid */
+	int num_groups = (num_nodes - 1 + scene_grid_group_size_g)/(scene_grid_group_size_g + 1);
+	int groups_per_row = std::max((int) Ogre::Math::Ceil(Ogre::Math::Sqrt((float) num_groups)), 1);
+	int children_per_row = (int) Ogre::Math::Ceil(Ogre::Math::Sqrt((float) scene_grid_group_size_g));
+	float group_extent = children_per_row*scene_grid_spacing_g;
+	if (num_nodes > 0){
+		nodes.push_back(MakeNode(scene_file_none_g, Ogre::Vector3::ZERO, Ogre::Quaternion::IDENTITY, Ogre::Vector3::UNIT_SCALE));
+		nodes[0].flags = scene_file_static_g;
+	}
+	int group = 0;
+	while ((int) nodes.size() < num_nodes){
+		Ogre::Vector3 group_position((group % groups_per_row)*group_extent, 0, -(group / groups_per_row)*group_extent);
+		Ogre::uint32 group_index = (Ogre::uint32) nodes.size();
+		nodes.push_back(MakeNode(0, group_position, Ogre::Quaternion::IDENTITY, Ogre::Vector3::UNIT_SCALE));
+		for (int i = 0; i < scene_grid_group_size_g && (int) nodes.size() < num_nodes; i++){
+			Ogre::Vector3 position((i % children_per_row)*scene_grid_spacing_g, 0, -(i / children_per_row)*scene_grid_spacing_g);
+			Ogre::Quaternion orientation(Ogre::Degree(i*37.0), Ogre::Vector3::UNIT_Y);
+			SceneFileNode node = MakeNode(group_index, position, orientation, Ogre::Vector3::UNIT_SCALE);
+			if (!mesh_names.empty()){
+				node.mesh = (Ogre::uint32) ((group + i) % mesh_names.size());
+			}
+			nodes.push_back(node);
+		}
+		group++;
+	}
+
+	WriteFile(path, mesh_names, materials, material_sets, nodes);
+}
+
+
+/* Bounds-checked reads from the mapping */
+static const unsigned char *ReadBytes(const MappedFile &file, size_t &offset, size_t size){
+
+	if (size > file.GetSize() - offset){
+		throw(OgreAppException(std::string("SceneFile::Exception: Truncated scene file.")));
+	}
+	const unsigned char *bytes = file.GetData() + offset;
+	offset += size;
+	return bytes;
+}
+
+
+static Ogre::uint32 ReadUint32(const MappedFile &file, size_t &offset){
+
+	Ogre::uint32 value;
+	memcpy(&value, ReadBytes(file, offset, sizeof(value)), sizeof(value));
+	return value;
+}
+
+
+static Ogre::String ReadString(const MappedFile &file, size_t &offset){
+
+	Ogre::uint32 length = ReadUint32(file, offset);
+	Ogre::String value((const char *) ReadBytes(file, offset, length), length);
+	while (offset % 4 != 0){
+		ReadBytes(file, offset, 1);
+	}
+	return value;
+}
+
+
+SceneFile::SceneFile(void){
+
+	offset_ = 0;
+	num_file_nodes_ = 0;
+	scene_manager_ = NULL;
+	parent_ = NULL;
+	num_entities_ = 0;
+}
+
+
+SceneFile::~SceneFile(void){
+
+}
+
+
+void SceneFile::Begin(const Ogre::String &path, Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent){
+
+	file_.Close();
+	if (!file_.Open(path)){
+		throw(OgreAppException(std::string("SceneFile::Exception: Cannot open ") + path));
+	}
+	scene_manager_ = scene_manager;
+	parent_ = parent;
+	offset_ = 0;
+
+	if (memcmp(ReadBytes(file_, offset_, sizeof(scene_file_magic_g)), scene_file_magic_g, sizeof(scene_file_magic_g)) != 0 ||
+		ReadUint32(file_, offset_) != scene_file_version_g){
+		file_.Close();
+		throw(OgreAppException(std::string("SceneFile::Exception: Not a scene file of this version: ") + path));
+	}
+	num_file_nodes_ = ReadUint32(file_, offset_);
+
+	/* Look up every mesh and material once, instead of once per entity */
+	Ogre::uint32 num_meshes = ReadUint32(file_, offset_);
+	meshes_.clear();
+	decode_scales_.clear();
+	decode_biases_.clear();
+	for (Ogre::uint32 i = 0; i < num_meshes; i++){
+		Ogre::String name = ReadString(file_, offset_);
+		Ogre::MeshPtr mesh = Ogre::MeshManager::getSingleton().getByName(name);
+		if (mesh.isNull()){
+			file_.Close();
+			throw(OgreAppException(std::string("SceneFile::Exception: Unknown mesh ") + name));
+		}
+		Ogre::Vector4 scale, bias;
+		VertexCompression::GetDecode(mesh, scale, bias);
+		meshes_.push_back(mesh);
+		decode_scales_.push_back(scale);
+		decode_biases_.push_back(bias);
+	}
+	Ogre::uint32 num_materials = ReadUint32(file_, offset_);
+	materials_.clear();
+	for (Ogre::uint32 i = 0; i < num_materials; i++){
+		Ogre::String name = ReadString(file_, offset_);
+		Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().getByName(name);
+		if (material.isNull()){
+			file_.Close();
+			throw(OgreAppException(std::string("SceneFile::Exception: Unknown material ") + name));
+		}
+		materials_.push_back(material);
+	}
+	Ogre::uint32 num_material_sets = ReadUint32(file_, offset_);
+	material_sets_.clear();
+	material_sets_.resize(num_material_sets);
+	for (Ogre::uint32 i = 0; i < num_material_sets; i++){
+		Ogre::uint32 num_submeshes = ReadUint32(file_, offset_);
+		for (Ogre::uint32 j = 0; j < num_submeshes; j++){
+			Ogre::uint32 material = ReadUint32(file_, offset_);
+			if (material != scene_file_none_g && material >= materials_.size()){
+				file_.Close();
+				throw(OgreAppException(std::string("SceneFile::Exception: Material set refers to a missing material.")));
+			}
+			material_sets_[i].push_back((material != scene_file_none_g) ? materials_[material] : Ogre::MaterialPtr());
+		}
+	}
+
+	nodes_.clear();
+	entities_.clear();
+	occluders_.clear();
+	static_roots_.clear();
+	nodes_.reserve(num_file_nodes_);
+	entities_.reserve(num_file_nodes_);
+	num_entities_ = 0;
+}
+
+
+bool SceneFile::LoadChunk(void){
+
+	if (!file_.IsOpen()){
+		return false;
+	}
+	if (nodes_.size() >= num_file_nodes_){
+		file_.Close();
+		return false;
+	}
+
+	Ogre::uint32 count = ReadUint32(file_, offset_);
+	/* Checked by division, since count*sizeof(SceneFileNode) wraps around with 32-bit sizes */
+	if (count > (file_.GetSize() - offset_)/sizeof(SceneFileNode)){
+		file_.Close();
+		throw(OgreAppException(std::string("SceneFile::Exception: Truncated scene file.")));
+	}
+	const unsigned char *records = ReadBytes(file_, offset_, count*sizeof(SceneFileNode));
+	for (Ogre::uint32 i = 0; i < count; i++){
+		SceneFileNode record;
+		memcpy(&record, records + i*sizeof(SceneFileNode), sizeof(record));
+
+		Ogre::SceneNode *parent = parent_;
+		if (record.parent != scene_file_none_g){
+			if (record.parent >= nodes_.size()){
+				file_.Close();
+				throw(OgreAppException(std::string("SceneFile::Exception: Node refers to a later parent.")));
+			}
+			parent = nodes_[record.parent];
+		}
+		Ogre::SceneNode *node = parent->createChildSceneNode(Ogre::Vector3(record.position[0], record.position[1], record.position[2]),
+			Ogre::Quaternion(record.orientation[0], record.orientation[1], record.orientation[2], record.orientation[3]));
+		node->setScale(record.scale[0], record.scale[1], record.scale[2]);
+		nodes_.push_back(node);
+		int handle = (int) nodes_.size() - 1;
+		if (record.flags & scene_file_static_g){
+			static_roots_.push_back(std::make_pair(handle, record.region_size));
+		}
+
+		Ogre::Entity *entity = NULL;
+		if (record.mesh != scene_file_none_g){
+			if (record.mesh >= meshes_.size() || (record.material != scene_file_none_g && record.material >= material_sets_.size())){
+				file_.Close();
+				throw(OgreAppException(std::string("SceneFile::Exception: Node refers to a missing mesh or material.")));
+			}
+			entity = scene_manager_->createEntity(meshes_[record.mesh]);
+			if (record.material != scene_file_none_g){
+				const std::vector<Ogre::MaterialPtr> &material_set = material_sets_[record.material];
+				for (unsigned int s = 0; s < entity->getNumSubEntities() && s < material_set.size(); s++){
+					if (!material_set[s].isNull()){
+						entity->getSubEntity(s)->setMaterial(material_set[s]);
+					}
+				}
+			}
+			VertexCompression::ApplyDecode(entity, decode_scales_[record.mesh], decode_biases_[record.mesh]);
+			node->attachObject(entity);
+			num_entities_++;
+			if (record.flags & scene_file_occluder_g){
+				occluders_.push_back(handle);
+			}
+		}
+		entities_.push_back(entity);
+	}
+
+	if (nodes_.size() >= num_file_nodes_){
+		file_.Close();
+		return false;
+	}
+	return true;
+}
+
+
+void SceneFile::Load(const Ogre::String &path, Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent){
+
+	Begin(path, scene_manager, parent);
+	while (LoadChunk());
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,80 @@
+#ifndef SCENE_FILE_H_
+#define SCENE_FILE_H_
+
+#include <vector>
+#include <utility>
+
+#include "OGRE/OgreSceneManager.h"
+#include "OGRE/OgreSceneNode.h"
+#include "OGRE/OgreEntity.h"
+#include "OGRE/OgreMesh.h"
+#include "OGRE/OgreMaterial.h"
+
+#include "mapped_file.h"
+
+namespace ogre_application {
+
+	/* Compact binary scene: a node hierarchy with transforms and mesh and material references */
+	/* The file holds a table of mesh names, one of material names and one of material sets
+	   (a material per submesh), followed by chunks of fixed-size node records that refer to
+	   meshes and material sets by index, and carry the setup the scene had: which entities
+	   occlude and which subtrees are batched. A parent always comes before its
+	   children, so a single pass over the records builds the tree. Loading goes chunk by
+	   chunk through a memory mapping and creates nodes and entities without names; they are
+	   reached through their index in the file instead */
+	class SceneFile
+	{
+		public:
+			SceneFile(void);
+			~SceneFile(void);
+
+			// Write the subtree under root, root included; call before the subtree is batched, and
+			// pass root_static if it is to be, with its region size (0 for the default)
+			static void Save(const Ogre::String &path, Ogre::SceneNode *root, bool root_static = false, float region_size = 0.0f);
+			// Write a test scene of num_nodes nodes: a grid of groups with entities of the meshes, batched
+			static void SaveGrid(const Ogre::String &path, const std::vector<Ogre::String> &mesh_names, int num_nodes);
+
+			// Start loading a scene under parent; the meshes it refers to must exist
+			void Begin(const Ogre::String &path, Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent);
+			// Create the nodes and entities of the next chunk; false once everything is loaded
+			bool LoadChunk(void);
+			// Begin() and every chunk at once
+			void Load(const Ogre::String &path, Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent);
+			bool IsLoading(void) const { return file_.IsOpen(); }
+
+			// Handles are the node indices of the file
+			int GetNumNodes(void) const { return (int) nodes_.size(); }
+			Ogre::SceneNode *GetNode(int handle) const { return nodes_[handle]; }
+			Ogre::Entity *GetEntity(int handle) const { return entities_[handle]; } // NULL if the node has none
+			int GetNumEntities(void) const { return num_entities_; }
+			// Handles of the occluders, and of the static roots with their region sizes
+			const std::vector<int> &GetOccluders(void) const { return occluders_; }
+			const std::vector<std::pair<int, float> > &GetStaticRoots(void) const { return static_roots_; }
+
+		private:
+			MappedFile file_;
+			size_t offset_; // Of the next chunk
+			Ogre::uint32 num_file_nodes_;
+			Ogre::SceneManager *scene_manager_;
+			Ogre::SceneNode *parent_;
+
+			// Tables of the file, resolved once
+			std::vector<Ogre::MeshPtr> meshes_;
+			std::vector<Ogre::Vector4> decode_scales_; // Per mesh, see VertexCompression::GetDecode
+			std::vector<Ogre::Vector4> decode_biases_;
+			std::vector<Ogre::MaterialPtr> materials_;
+			std::vector<std::vector<Ogre::MaterialPtr> > material_sets_; // Null keeps the submesh's material
+
+			std::vector<Ogre::SceneNode *> nodes_;
+			std::vector<Ogre::Entity *> entities_;
+			int num_entities_;
+			std::vector<int> occluders_;
+			std::vector<std::pair<int, float> > static_roots_;
+
+			SceneFile(const SceneFile &);
+			SceneFile &operator=(const SceneFile &);
+	};
+
+} // namespace ogre_application;
+
+#endif // SCENE_FILE_H_
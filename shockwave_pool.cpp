@@ -0,0 +1,56 @@
+#include "shockwave_pool.h"
+
+namespace ogre_application {
+
+/* Radius at which a ring centred anywhere on the screen has left it, past the corners */
+const float max_shockwave_radius_g = 1.5;
+/* Half-width of the distorted ring, as in the shader */
+const float shockwave_band_g = 0.1;
+
+
+bool ShockwavePool::Spawn(Ogre::Vector2 centre, float speed, float strength){
+
+	if (num_active_ == capacity){
+		return false;
+	}
+	Shockwave &wave = waves_[num_active_++];
+	wave.centre = centre;
+	wave.speed = speed;
+	wave.strength = strength;
+	wave.age = 0;
+	return true;
+}
+
+
+void ShockwavePool::Update(float time_step){
+
+	/* Expired waves are replaced by the last one to keep the active ones packed */
+	int i = 0;
+	while (i < num_active_){
+		Shockwave &wave = waves_[i];
+		wave.age += time_step;
+		if (wave.age*wave.speed - shockwave_band_g > max_shockwave_radius_g || wave.speed <= 0){
+			waves_[i] = waves_[--num_active_];
+		}
+		else {
+			i++;
+		}
+	}
+}
+
+
+void ShockwavePool::GetUniforms(float *data) const{
+
+	for (int i = 0; i < num_active_; i++){
+		const Shockwave &wave = waves_[i];
+		float radius = wave.age*wave.speed;
+		data[4*i + 0] = wave.centre.x;
+		data[4*i + 1] = wave.centre.y;
+		data[4*i + 2] = radius;
+		/* Fade out over the way to the edge so that the reclaimed waves do not pop */
+		data[4*i + 3] = wave.strength*(1.0 - radius/(max_shockwave_radius_g + shockwave_band_g));
+	}
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,47 @@
+#ifndef SHOCKWAVE_POOL_H_
+#define SHOCKWAVE_POOL_H_
+
+#include "OGRE/OgreVector2.h"
+
+namespace ogre_application {
+
+	/* One expanding ring of screen distortion */
+	struct Shockwave
+	{
+		Ogre::Vector2 centre; // Texture coordinates of the screen, (0, 0) at the top left
+		float speed; // Growth of the radius per second, in screen widths
+		float strength; // 1 distorts like effect 6
+		float age; // Seconds since it was spawned
+	};
+
+	/* Fixed-capacity set of the active shockwaves */
+	/* Waves are kept packed, so the shader loops over the active ones only, and a wave is
+	   reclaimed once its ring has left the screen. The pool is plain data and is copied
+	   along with the simulation snapshots */
+	class ShockwavePool
+	{
+		public:
+			static const int capacity = 16; // Size of the shockwaves array of PostEffectStages.glsl
+
+			ShockwavePool(void) : num_active_(0) {}
+
+			// False if the pool is full
+			bool Spawn(Ogre::Vector2 centre, float speed, float strength);
+			// Age the waves and reclaim the expired ones
+			void Update(float time_step);
+			void Clear(void) { num_active_ = 0; }
+
+			int GetNumActive(void) const { return num_active_; }
+			const Shockwave &GetWave(int index) const { return waves_[index]; }
+
+			// Centre, radius and strength of every active wave, four floats each
+			void GetUniforms(float *data) const;
+
+		private:
+			Shockwave waves_[capacity];
+			int num_active_;
+	};
+
+} // namespace ogre_application;
+
+#endif // SHOCKWAVE_POOL_H_
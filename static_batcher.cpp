@@ -0,0 +1,344 @@
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+#include "OGRE/OgreMeshManager.h"
+#include "OGRE/OgreSubMesh.h"
+#include "OGRE/OgreSubEntity.h"
+#include "OGRE/OgreHardwareBufferManager.h"
+#include "OGRE/OgreStringConverter.h"
+
+#include "static_batcher.h"
+
+namespace ogre_application {
+
+
+StaticBatcher::StaticBatcher(void){
+
+	scene_manager_ = NULL;
+	region_size_ = 0.0f;
+	layout_ = VERTEX_LAYOUT_FULL;
+	excluded_flags_ = 0;
+	num_batches_created_ = 0;
+}
+
+
+StaticBatcher::~StaticBatcher(void){
+
+	/* The scene manager cleans up the batch entities and nodes on its own */
+}
+
+
+void StaticBatcher::Init(Ogre::SceneManager *scene_manager, Ogre::String resource_group_name, float region_size, VertexLayout layout){
+
+	scene_manager_ = scene_manager;
+	resource_group_name_ = resource_group_name;
+	region_size_ = region_size;
+	layout_ = layout;
+}
+
+
+void StaticBatcher::MarkStatic(Ogre::SceneNode *root){
+
+	if (IsStatic(root)){
+		Rebuild(root);
+		return;
+	}
+	Build(root, batches_[root]);
+}
+
+
+void StaticBatcher::Rebuild(Ogre::SceneNode *root){
+
+	std::map<Ogre::SceneNode *, Batch>::iterator it = batches_.find(root);
+	if (it == batches_.end()){
+		return;
+	}
+	Destroy(it->second);
+	Build(root, it->second);
+}
+
+
+void StaticBatcher::Unmark(Ogre::SceneNode *root){
+
+	std::map<Ogre::SceneNode *, Batch>::iterator it = batches_.find(root);
+	if (it == batches_.end()){
+		return;
+	}
+	Destroy(it->second);
+	batches_.erase(it);
+}
+
+
+int StaticBatcher::GetNumSourceDrawCalls(void) const {
+
+	int num_draw_calls = 0;
+	for (std::map<Ogre::SceneNode *, Batch>::const_iterator it = batches_.begin(); it != batches_.end(); ++it){
+		num_draw_calls += it->second.num_source_draw_calls;
+	}
+	return num_draw_calls;
+}
+
+
+int StaticBatcher::GetNumBatchedDrawCalls(void) const {
+
+	int num_draw_calls = 0;
+	for (std::map<Ogre::SceneNode *, Batch>::const_iterator it = batches_.begin(); it != batches_.end(); ++it){
+		for (size_t i = 0; i < it->second.entities.size(); i++){
+			num_draw_calls += (int) it->second.entities[i]->getNumSubEntities();
+		}
+	}
+	return num_draw_calls;
+}
+
+
+void StaticBatcher::CollectEntities(Ogre::SceneNode *node, std::vector<Ogre::Entity *> &entities){
+
+	Ogre::SceneNode::ObjectIterator objects = node->getAttachedObjectIterator();
+	while (objects.hasMoreElements()){
+		Ogre::Entity *entity = dynamic_cast<Ogre::Entity *>(objects.getNext());
+		if (entity && entity->getVisible() && !(entity->getVisibilityFlags() & excluded_flags_)){
+			entities.push_back(entity);
+		}
+	}
+
+	Ogre::Node::ChildNodeIterator children = node->getChildIterator();
+	while (children.hasMoreElements()){
+		CollectEntities(static_cast<Ogre::SceneNode *>(children.getNext()), entities);
+	}
+}
+
+
+const std::vector<StaticBatcher::SourceGeometry> &StaticBatcher::GetSourceGeometry(const Ogre::MeshPtr &mesh){
+
+	std::map<Ogre::String, std::vector<SourceGeometry> >::iterator it = source_geometry_.find(mesh->getName());
+	if (it != source_geometry_.end()){
+		return it->second;
+	}
+
+	/* Read the mesh back once; every submesh becomes a decoded triangle list */
+	std::vector<SourceGeometry> &geometry = source_geometry_[mesh->getName()];
+	geometry.resize(mesh->getNumSubMeshes());
+	for (unsigned short i = 0; i < mesh->getNumSubMeshes(); i++){
+		Ogre::SubMesh *sub_mesh = mesh->getSubMesh(i);
+		Ogre::VertexData *vertex_data = sub_mesh->useSharedVertices ? mesh->sharedVertexData : sub_mesh->vertexData;
+		VertexCompression::Decode(mesh, vertex_data, geometry[i].vertices);
+
+		std::vector<Ogre::uint32> indices;
+		Ogre::IndexData *index_data = sub_mesh->indexData;
+		if (index_data && index_data->indexCount > 0){
+			Ogre::HardwareIndexBufferSharedPtr buffer = index_data->indexBuffer;
+			indices.resize(index_data->indexCount);
+			if (buffer->getType() == Ogre::HardwareIndexBuffer::IT_16BIT){
+				std::vector<Ogre::uint16> short_indices(index_data->indexCount);
+				buffer->readData(index_data->indexStart*sizeof(Ogre::uint16), short_indices.size()*sizeof(Ogre::uint16), &short_indices[0]);
+				std::copy(short_indices.begin(), short_indices.end(), indices.begin());
+			}
+			else {
+				buffer->readData(index_data->indexStart*sizeof(Ogre::uint32), indices.size()*sizeof(Ogre::uint32), &indices[0]);
+			}
+		}
+		else {
+			for (size_t v = 0; v < vertex_data->vertexCount; v++){
+				indices.push_back((Ogre::uint32) v);
+			}
+		}
+
+		std::vector<Ogre::uint32> &triangles = geometry[i].indices;
+		switch (sub_mesh->operationType){
+			case Ogre::RenderOperation::OT_TRIANGLE_LIST:
+				triangles = indices;
+				break;
+			case Ogre::RenderOperation::OT_TRIANGLE_FAN:
+				for (size_t t = 2; t < indices.size(); t++){
+					triangles.push_back(indices[0]);
+					triangles.push_back(indices[t - 1]);
+					triangles.push_back(indices[t]);
+				}
+				break;
+			case Ogre::RenderOperation::OT_TRIANGLE_STRIP:
+				for (size_t t = 2; t < indices.size(); t++){
+					/* Every other triangle of a strip is wound the other way */
+					triangles.push_back(indices[t - 2]);
+					triangles.push_back(indices[(t % 2) ? t : t - 1]);
+					triangles.push_back(indices[(t % 2) ? t - 1 : t]);
+				}
+				break;
+			default:
+				/* Lines and points are not batched */
+				break;
+		}
+	}
+	return geometry;
+}
+
+
+void StaticBatcher::Build(Ogre::SceneNode *root, Batch &batch){
+
+	batch.sources.clear();
+	batch.num_source_draw_calls = 0;
+	batch.node = NULL;
+	batch.entities.clear();
+	CollectEntities(root, batch.sources);
+
+	Ogre::Matrix4 root_inverse = root->_getFullTransform().inverseAffine();
+	std::map<Ogre::String, Group> groups;
+
+	float region_size = region_size_;
+	std::map<Ogre::SceneNode *, float>::const_iterator size = region_sizes_.find(root);
+	if (size != region_sizes_.end()){
+		region_size = size->second;
+	}
+
+	for (size_t i = 0; i < batch.sources.size(); i++){
+		Ogre::Entity *entity = batch.sources[i];
+		const std::vector<SourceGeometry> &geometry = GetSourceGeometry(entity->getMesh());
+
+		/* Transform into the space of the root; normals by the inverse transpose */
+		Ogre::Matrix4 transform = root_inverse*entity->getParentSceneNode()->_getFullTransform();
+		Ogre::Matrix3 linear;
+		transform.extract3x3Matrix(linear);
+		Ogre::Matrix3 normal_transform = linear.Inverse().Transpose();
+
+		/* Entities go to the region that contains their centre. Regions are centred on the
+		   root, so nodes placed on its axes do not fall on a border */
+		Ogre::Vector3 center = transform*entity->getMesh()->getBounds().getCenter();
+		Ogre::String region = "@" + Ogre::StringConverter::toString((int) std::floor(center.x/region_size + 0.5f)) +
+		                      "," + Ogre::StringConverter::toString((int) std::floor(center.y/region_size + 0.5f)) +
+		                      "," + Ogre::StringConverter::toString((int) std::floor(center.z/region_size + 0.5f));
+
+		for (unsigned int s = 0; s < entity->getNumSubEntities() && s < geometry.size(); s++){
+			const SourceGeometry &source = geometry[s];
+			Ogre::String material_name = entity->getSubEntity(s)->getMaterialName();
+			Group &group = groups[material_name + region];
+			group.material_name = material_name;
+
+			Ogre::uint32 first_vertex = (Ogre::uint32) group.vertices.positions.size();
+			for (size_t v = 0; v < source.vertices.positions.size(); v++){
+				group.vertices.positions.push_back(transform*source.vertices.positions[v]);
+				group.vertices.normals.push_back((normal_transform*source.vertices.normals[v]).normalisedCopy());
+				group.vertices.colours.push_back(source.vertices.colours[v]);
+				group.vertices.uvs.push_back(source.vertices.uvs[v]);
+			}
+			for (size_t t = 0; t < source.indices.size(); t++){
+				group.indices.push_back(first_vertex + source.indices[t]);
+			}
+		}
+
+		batch.num_source_draw_calls += (int) entity->getNumSubEntities();
+		entity->setVisible(false);
+	}
+
+	if (groups.empty()){
+		return;
+	}
+
+	/* A mesh and an entity per group: no more draw calls than submeshes of one mesh would
+	   take, but each group gets bounds of its own for the occlusion culler */
+	batch.node = root->createChildSceneNode("StaticBatch" + Ogre::StringConverter::toString(num_batches_created_++));
+	for (std::map<Ogre::String, Group>::const_iterator it = groups.begin(); it != groups.end(); ++it){
+		/* Submeshes of lines or points add a group without triangles; a mesh of it would need
+		   zero-size buffers */
+		if (it->second.indices.empty()){
+			continue;
+		}
+		Ogre::String mesh_name = batch.node->getName() + "/" + Ogre::StringConverter::toString(batch.entities.size());
+		Ogre::MeshPtr mesh = CreateMesh(mesh_name, it->second);
+		VertexCompression::Compress(mesh, layout_);
+
+		Ogre::Entity *entity = scene_manager_->createEntity(mesh_name, mesh_name);
+		VertexCompression::ApplyDecode(entity);
+		batch.node->attachObject(entity);
+		batch.entities.push_back(entity);
+	}
+}
+
+
+void StaticBatcher::Destroy(Batch &batch){
+
+	if (batch.node){
+		batch.node->detachAllObjects();
+		for (size_t i = 0; i < batch.entities.size(); i++){
+			Ogre::String mesh_name = batch.entities[i]->getMesh()->getName();
+			scene_manager_->destroyEntity(batch.entities[i]);
+			Ogre::MeshManager::getSingleton().remove(mesh_name);
+		}
+		scene_manager_->destroySceneNode(batch.node);
+	}
+	batch.entities.clear();
+	batch.node = NULL;
+
+	for (size_t i = 0; i < batch.sources.size(); i++){
+		batch.sources[i]->setVisible(true);
+	}
+	batch.sources.clear();
+	batch.num_source_draw_calls = 0;
+}
+
+
+Ogre::MeshPtr StaticBatcher::CreateMesh(Ogre::String mesh_name, const Group &group){
+
+	Ogre::MeshPtr mesh = Ogre::MeshManager::getSingleton().createManual(mesh_name, resource_group_name_);
+	Ogre::AxisAlignedBox bounds;
+	float radius = 0.0f;
+	size_t num_vertices = group.vertices.positions.size();
+
+	/* Full layout; Compress() converts it afterwards like any generated mesh */
+	Ogre::SubMesh *sub_mesh = mesh->createSubMesh();
+	sub_mesh->useSharedVertices = false;
+	sub_mesh->operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
+	sub_mesh->setMaterialName(group.material_name);
+	sub_mesh->vertexData = OGRE_NEW Ogre::VertexData();
+	sub_mesh->vertexData->vertexCount = num_vertices;
+
+	Ogre::VertexDeclaration *declaration = sub_mesh->vertexData->vertexDeclaration;
+	size_t offset = 0;
+	offset += declaration->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_POSITION).getSize();
+	offset += declaration->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_NORMAL).getSize();
+	offset += declaration->addElement(0, offset, Ogre::VET_COLOUR, Ogre::VES_DIFFUSE).getSize();
+	offset += declaration->addElement(0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES, 0).getSize();
+
+	std::vector<float> vertices;
+	vertices.reserve(num_vertices*offset/sizeof(float));
+	for (size_t v = 0; v < num_vertices; v++){
+		const Ogre::Vector3 &position = group.vertices.positions[v];
+		const Ogre::Vector3 &normal = group.vertices.normals[v];
+		float colour;
+		memcpy(&colour, &group.vertices.colours[v], sizeof(float));
+		float vertex[] = { position.x, position.y, position.z, normal.x, normal.y, normal.z, colour, group.vertices.uvs[v].x, group.vertices.uvs[v].y };
+		vertices.insert(vertices.end(), vertex, vertex + 9);
+
+		bounds.merge(position);
+		radius = std::max(radius, position.length());
+	}
+
+	Ogre::HardwareVertexBufferSharedPtr vertex_buffer = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
+		offset, num_vertices, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	vertex_buffer->writeData(0, vertex_buffer->getSizeInBytes(), &vertices[0], true);
+	sub_mesh->vertexData->vertexBufferBinding->setBinding(0, vertex_buffer);
+
+	/* 16-bit indices whenever they fit */
+	Ogre::IndexData *index_data = sub_mesh->indexData;
+	index_data->indexStart = 0;
+	index_data->indexCount = group.indices.size();
+	if (num_vertices <= 65536){
+		std::vector<Ogre::uint16> short_indices(group.indices.begin(), group.indices.end());
+		index_data->indexBuffer = Ogre::HardwareBufferManager::getSingleton().createIndexBuffer(
+			Ogre::HardwareIndexBuffer::IT_16BIT, short_indices.size(), Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		index_data->indexBuffer->writeData(0, index_data->indexBuffer->getSizeInBytes(), &short_indices[0], true);
+	}
+	else {
+		index_data->indexBuffer = Ogre::HardwareBufferManager::getSingleton().createIndexBuffer(
+			Ogre::HardwareIndexBuffer::IT_32BIT, group.indices.size(), Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		index_data->indexBuffer->writeData(0, index_data->indexBuffer->getSizeInBytes(), &group.indices[0], true);
+	}
+
+	/* Unpadded, so that groups next to an occluder are not tested as larger than they are */
+	mesh->_setBounds(bounds, false);
+	mesh->_setBoundingSphereRadius(radius);
+	mesh->load();
+	return mesh;
+}
+
+
+} // namespace ogre_application;
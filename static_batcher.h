@@ -0,0 +1,95 @@
+#ifndef STATIC_BATCHER_H_
+#define STATIC_BATCHER_H_
+
+#include <vector>
+#include <map>
+
+#include "OGRE/OgreSceneManager.h"
+#include "OGRE/OgreSceneNode.h"
+#include "OGRE/OgreEntity.h"
+#include "OGRE/OgreMesh.h"
+
+#include "vertex_compression.h"
+
+namespace ogre_application {
+
+	/* Merges the entities of non-moving subtrees into few draw calls */
+	/* The node transforms of a subtree are baked into its vertices, relative to the subtree
+	   root, and the geometry is merged into one entity per material and spatial region, so
+	   that each region can still be culled on its own. The merged entities hang under the root, so the root itself may still move; only changes
+	   inside the subtree need a rebuild. Decoded source meshes are kept on the CPU, which
+	   makes rebuilding a matter of re-transforming vertices */
+	class StaticBatcher
+	{
+		public:
+			StaticBatcher(void);
+			~StaticBatcher(void);
+
+			// region_size: edge of the cubes that split a batch, in units of the subtree root
+			void Init(Ogre::SceneManager *scene_manager, Ogre::String resource_group_name, float region_size, VertexLayout layout);
+
+			// Layout of batches built afterwards
+			void SetVertexLayout(VertexLayout layout) { layout_ = layout; }
+			// Entities with any of these visibility flags keep drawing on their own
+			void SetExcludedFlags(Ogre::uint32 flags) { excluded_flags_ = flags; }
+
+			// Region size for the batches of one root, instead of the one given to Init
+			void SetRegionSize(Ogre::SceneNode *root, float region_size) { region_sizes_[root] = region_size; }
+
+			// Replace the entities under root by merged geometry
+			void MarkStatic(Ogre::SceneNode *root);
+			// Merge again after entities or nodes under root changed
+			void Rebuild(Ogre::SceneNode *root);
+			// Show the original entities again
+			void Unmark(Ogre::SceneNode *root);
+			bool IsStatic(Ogre::SceneNode *root) const { return batches_.find(root) != batches_.end(); }
+
+			// Draw calls of the original entities and of the merged ones, over all batches
+			int GetNumSourceDrawCalls(void) const;
+			int GetNumBatchedDrawCalls(void) const;
+
+		private:
+			/* The merged geometry of one subtree */
+			struct Batch
+			{
+				std::vector<Ogre::Entity *> sources; // Hidden while batched
+				int num_source_draw_calls;
+				Ogre::SceneNode *node;
+				std::vector<Ogre::Entity *> entities; // One per group
+			};
+
+			/* Geometry merged into one submesh */
+			struct Group
+			{
+				Ogre::String material_name;
+				DecodedVertices vertices;
+				std::vector<Ogre::uint32> indices;
+			};
+
+			/* Decoded copy of one submesh of a source mesh */
+			struct SourceGeometry
+			{
+				DecodedVertices vertices;
+				std::vector<Ogre::uint32> indices; // Triangle list
+			};
+
+			Ogre::SceneManager *scene_manager_;
+			Ogre::String resource_group_name_;
+			float region_size_;
+			VertexLayout layout_;
+			Ogre::uint32 excluded_flags_;
+			int num_batches_created_;
+			std::map<Ogre::SceneNode *, Batch> batches_;
+			std::map<Ogre::SceneNode *, float> region_sizes_; // By root
+			std::map<Ogre::String, std::vector<SourceGeometry> > source_geometry_; // By mesh name
+
+			void CollectEntities(Ogre::SceneNode *node, std::vector<Ogre::Entity *> &entities);
+			const std::vector<SourceGeometry> &GetSourceGeometry(const Ogre::MeshPtr &mesh);
+			void Build(Ogre::SceneNode *root, Batch &batch);
+			void Destroy(Batch &batch);
+			Ogre::MeshPtr CreateMesh(Ogre::String mesh_name, const Group &group);
+	};
+
+} // namespace ogre_application;
+
+#endif // STATIC_BATCHER_H_
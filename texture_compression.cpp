@@ -0,0 +1,332 @@
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "texture_compression.h"
+
+namespace ogre_application {
+
+/* DDS layout constants (see the DirectDraw Surface documentation) */
+const unsigned int dds_header_size_g = 124;
+const size_t dds_file_header_size_g = 4 + dds_header_size_g; // "DDS " magic + header
+const unsigned int dds_flags_g = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+const unsigned int dds_pixel_format_size_g = 32;
+const unsigned int dds_pixel_format_fourcc_g = 0x4;
+const unsigned int dds_caps_g = 0x8 | 0x1000 | 0x400000; // COMPLEX | TEXTURE | MIPMAP
+const size_t bc1_block_size_g = 8;
+
+
+static unsigned int ReadUint32(const unsigned char *data){
+
+	return (unsigned int) data[0] | ((unsigned int) data[1] << 8) | ((unsigned int) data[2] << 16) | ((unsigned int) data[3] << 24);
+}
+
+
+static void WriteUint32(unsigned char *data, unsigned int value){
+
+	data[0] = (unsigned char) (value & 0xff);
+	data[1] = (unsigned char) ((value >> 8) & 0xff);
+	data[2] = (unsigned char) ((value >> 16) & 0xff);
+	data[3] = (unsigned char) ((value >> 24) & 0xff);
+}
+
+
+/* Conversions between 8-bit RGB and the 5:6:5 endpoints of a BC1 block */
+static unsigned short PackRgb565(const float *colour){
+
+	int r = (int) (std::min(std::max(colour[0], 0.0f), 255.0f)*31.0f/255.0f + 0.5f);
+	int g = (int) (std::min(std::max(colour[1], 0.0f), 255.0f)*63.0f/255.0f + 0.5f);
+	int b = (int) (std::min(std::max(colour[2], 0.0f), 255.0f)*31.0f/255.0f + 0.5f);
+	return (unsigned short) ((r << 11) | (g << 5) | b);
+}
+
+
+static void UnpackRgb565(unsigned short packed, int *colour){
+
+	int r = (packed >> 11) & 0x1f;
+	int g = (packed >> 5) & 0x3f;
+	int b = packed & 0x1f;
+	colour[0] = (r << 3) | (r >> 2);
+	colour[1] = (g << 2) | (g >> 4);
+	colour[2] = (b << 3) | (b >> 2);
+}
+
+
+/* Expand the two endpoints into the four colour palette of a block */
+static void BuildPalette(unsigned short c0, unsigned short c1, int palette[4][4]){
+
+	UnpackRgb565(c0, palette[0]);
+	UnpackRgb565(c1, palette[1]);
+	palette[0][3] = 255;
+	palette[1][3] = 255;
+	for (int k = 0; k < 3; k++){
+		if (c0 > c1){
+			palette[2][k] = (2*palette[0][k] + palette[1][k])/3;
+			palette[3][k] = (palette[0][k] + 2*palette[1][k])/3;
+		}
+		else {
+			palette[2][k] = (palette[0][k] + palette[1][k])/2;
+			palette[3][k] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = (c0 > c1) ? 255 : 0;
+}
+
+
+static void EncodeBlock(const float pixels[16][3], unsigned char *out){
+
+	/* Find the principal axis of the block colours with a few power iterations */
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++){
+		for (int k = 0; k < 3; k++){
+			mean[k] += pixels[i][k]/16.0f;
+		}
+	}
+
+	float covariance[3][3] = { { 0.0f } };
+	for (int i = 0; i < 16; i++){
+		float d[3] = { pixels[i][0] - mean[0], pixels[i][1] - mean[1], pixels[i][2] - mean[2] };
+		for (int a = 0; a < 3; a++){
+			for (int b = 0; b < 3; b++){
+				covariance[a][b] += d[a]*d[b];
+			}
+		}
+	}
+
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 8; iteration++){
+		float next[3];
+		for (int a = 0; a < 3; a++){
+			next[a] = covariance[a][0]*axis[0] + covariance[a][1]*axis[1] + covariance[a][2]*axis[2];
+		}
+		float length = std::sqrt(next[0]*next[0] + next[1]*next[1] + next[2]*next[2]);
+		if (length < 1e-6f){
+			break; // Flat block, any axis will do
+		}
+		for (int a = 0; a < 3; a++){
+			axis[a] = next[a]/length;
+		}
+	}
+
+	/* The extreme projections on the axis become the endpoints */
+	int min_index = 0, max_index = 0;
+	float min_projection = 0.0f, max_projection = 0.0f;
+	for (int i = 0; i < 16; i++){
+		float projection = (pixels[i][0] - mean[0])*axis[0] + (pixels[i][1] - mean[1])*axis[1] + (pixels[i][2] - mean[2])*axis[2];
+		if (i == 0 || projection < min_projection){
+			min_projection = projection;
+			min_index = i;
+		}
+		if (i == 0 || projection > max_projection){
+			max_projection = projection;
+			max_index = i;
+		}
+	}
+
+	unsigned short c0 = PackRgb565(pixels[max_index]);
+	unsigned short c1 = PackRgb565(pixels[min_index]);
+	if (c0 < c1){
+		std::swap(c0, c1);
+	}
+
+	/* Pick the closest palette entry for every pixel */
+	unsigned int indices = 0;
+	if (c0 != c1){
+		int palette[4][4];
+		BuildPalette(c0, c1, palette);
+		for (int i = 0; i < 16; i++){
+			int best = 0;
+			float best_distance = 0.0f;
+			for (int p = 0; p < 4; p++){
+				float dr = pixels[i][0] - palette[p][0];
+				float dg = pixels[i][1] - palette[p][1];
+				float db = pixels[i][2] - palette[p][2];
+				float distance = dr*dr + dg*dg + db*db;
+				if (p == 0 || distance < best_distance){
+					best_distance = distance;
+					best = p;
+				}
+			}
+			indices |= (unsigned int) best << (2*i);
+		}
+	}
+
+	out[0] = (unsigned char) (c0 & 0xff);
+	out[1] = (unsigned char) (c0 >> 8);
+	out[2] = (unsigned char) (c1 & 0xff);
+	out[3] = (unsigned char) (c1 >> 8);
+	WriteUint32(out + 4, indices);
+}
+
+
+bool DdsTexture::Parse(const unsigned char *data, size_t size){
+
+	levels_.clear();
+	if (size < dds_file_header_size_g || memcmp(data, "DDS ", 4) != 0 || ReadUint32(data + 4) != dds_header_size_g){
+		return false;
+	}
+	if ((ReadUint32(data + 80) & dds_pixel_format_fourcc_g) == 0 || memcmp(data + 84, "DXT1", 4) != 0){
+		return false;
+	}
+
+	unsigned int height = ReadUint32(data + 12);
+	unsigned int width = ReadUint32(data + 16);
+	unsigned int num_levels = std::max(ReadUint32(data + 28), 1u);
+
+	size_t offset = dds_file_header_size_g;
+	for (unsigned int i = 0; i < num_levels; i++){
+		CompressedLevel level;
+		level.width = width;
+		level.height = height;
+		level.size = TextureCompression::GetBc1Size(width, height);
+		if (level.size > size - offset){
+			levels_.clear();
+			return false;
+		}
+		level.data = data + offset;
+		levels_.push_back(level);
+
+		offset += level.size;
+		width = std::max(width/2, 1u);
+		height = std::max(height/2, 1u);
+	}
+
+	return true;
+}
+
+
+void TextureCompression::GenerateMipChain(const RgbaImage &image, std::vector<RgbaImage> &levels){
+
+	levels.clear();
+	levels.push_back(image);
+
+	while (levels.back().width > 1 || levels.back().height > 1){
+		const RgbaImage &source = levels.back();
+		RgbaImage level;
+		level.width = std::max(source.width/2, 1u);
+		level.height = std::max(source.height/2, 1u);
+		level.pixels.resize(level.width*level.height*4);
+
+		/* 2x2 box filter; odd source sizes clamp to the last row or column */
+		for (unsigned int y = 0; y < level.height; y++){
+			unsigned int y0 = std::min(2*y, source.height - 1);
+			unsigned int y1 = std::min(2*y + 1, source.height - 1);
+			for (unsigned int x = 0; x < level.width; x++){
+				unsigned int x0 = std::min(2*x, source.width - 1);
+				unsigned int x1 = std::min(2*x + 1, source.width - 1);
+				for (int k = 0; k < 4; k++){
+					int sum = source.pixels[(y0*source.width + x0)*4 + k] + source.pixels[(y0*source.width + x1)*4 + k] +
+					          source.pixels[(y1*source.width + x0)*4 + k] + source.pixels[(y1*source.width + x1)*4 + k];
+					level.pixels[(y*level.width + x)*4 + k] = (unsigned char) ((sum + 2)/4);
+				}
+			}
+		}
+
+		levels.push_back(level);
+	}
+}
+
+
+size_t TextureCompression::GetBc1Size(unsigned int width, unsigned int height){
+
+	return (size_t) std::max((width + 3)/4, 1u)*std::max((height + 3)/4, 1u)*bc1_block_size_g;
+}
+
+
+void TextureCompression::EncodeBc1(const RgbaImage &image, unsigned char *out){
+
+	unsigned int blocks_x = std::max((image.width + 3)/4, 1u);
+	unsigned int blocks_y = std::max((image.height + 3)/4, 1u);
+
+	for (unsigned int by = 0; by < blocks_y; by++){
+		for (unsigned int bx = 0; bx < blocks_x; bx++){
+			float pixels[16][3];
+			for (int i = 0; i < 16; i++){
+				unsigned int x = std::min(bx*4 + (i % 4), image.width - 1);
+				unsigned int y = std::min(by*4 + (i / 4), image.height - 1);
+				const unsigned char *pixel = &image.pixels[(y*image.width + x)*4];
+				pixels[i][0] = pixel[0];
+				pixels[i][1] = pixel[1];
+				pixels[i][2] = pixel[2];
+			}
+			EncodeBlock(pixels, out + (by*blocks_x + bx)*bc1_block_size_g);
+		}
+	}
+}
+
+
+void TextureCompression::DecodeBc1(const unsigned char *blocks, unsigned int width, unsigned int height, RgbaImage &image){
+
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(width*height*4);
+
+	unsigned int blocks_x = std::max((width + 3)/4, 1u);
+	unsigned int blocks_y = std::max((height + 3)/4, 1u);
+
+	for (unsigned int by = 0; by < blocks_y; by++){
+		for (unsigned int bx = 0; bx < blocks_x; bx++){
+			const unsigned char *block = blocks + (by*blocks_x + bx)*bc1_block_size_g;
+			unsigned short c0 = (unsigned short) (block[0] | (block[1] << 8));
+			unsigned short c1 = (unsigned short) (block[2] | (block[3] << 8));
+			unsigned int indices = ReadUint32(block + 4);
+
+			int palette[4][4];
+			BuildPalette(c0, c1, palette);
+
+			for (int i = 0; i < 16; i++){
+				unsigned int x = bx*4 + (i % 4);
+				unsigned int y = by*4 + (i / 4);
+				if (x >= width || y >= height){
+					continue;
+				}
+				const int *colour = palette[(indices >> (2*i)) & 0x3];
+				unsigned char *pixel = &image.pixels[(y*width + x)*4];
+				for (int k = 0; k < 4; k++){
+					pixel[k] = (unsigned char) colour[k];
+				}
+			}
+		}
+	}
+}
+
+
+void TextureCompression::WriteDds(const std::vector<RgbaImage> &levels, std::vector<unsigned char> &out){
+
+	size_t total_size = dds_file_header_size_g;
+	for (size_t i = 0; i < levels.size(); i++){
+		total_size += GetBc1Size(levels[i].width, levels[i].height);
+	}
+	out.assign(total_size, 0);
+
+	/* Header */
+	memcpy(&out[0], "DDS ", 4);
+	WriteUint32(&out[4], dds_header_size_g);
+	WriteUint32(&out[8], dds_flags_g);
+	WriteUint32(&out[12], levels[0].height);
+	WriteUint32(&out[16], levels[0].width);
+	WriteUint32(&out[20], (unsigned int) GetBc1Size(levels[0].width, levels[0].height));
+	WriteUint32(&out[28], (unsigned int) levels.size());
+	WriteUint32(&out[76], dds_pixel_format_size_g);
+	WriteUint32(&out[80], dds_pixel_format_fourcc_g);
+	memcpy(&out[84], "DXT1", 4);
+	WriteUint32(&out[108], dds_caps_g);
+
+	/* Mip chain, largest level first */
+	size_t offset = dds_file_header_size_g;
+	for (size_t i = 0; i < levels.size(); i++){
+		EncodeBc1(levels[i], &out[offset]);
+		offset += GetBc1Size(levels[i].width, levels[i].height);
+	}
+}
+
+
+std::string TextureCompression::GetCompressedFileName(const std::string &file_name){
+
+	size_t dot = file_name.find_last_of('.');
+	return file_name.substr(0, dot) + ".dds";
+}
+
+
+} // namespace ogre_application;
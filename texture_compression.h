@@ -0,0 +1,63 @@
+#ifndef TEXTURE_COMPRESSION_H_
+#define TEXTURE_COMPRESSION_H_
+
+#include <string>
+#include <vector>
+
+namespace ogre_application {
+
+	/* An uncompressed 8-bit RGBA image */
+	struct RgbaImage
+	{
+		unsigned int width;
+		unsigned int height;
+		std::vector<unsigned char> pixels; // width*height*4 bytes, rows top to bottom
+	};
+
+	/* One mip level of a BC1 compressed texture */
+	struct CompressedLevel
+	{
+		unsigned int width;
+		unsigned int height;
+		const unsigned char *data; // Points into the DDS file contents
+		size_t size;
+	};
+
+	/* View of a BC1 (DXT1) DDS file with a full mip chain */
+	/* The levels point into the bytes given to Parse, which must stay alive */
+	class DdsTexture
+	{
+		public:
+			bool Parse(const unsigned char *data, size_t size); // Returns false if the file is not a BC1 DDS
+
+			unsigned int GetWidth(void) const { return levels_.empty() ? 0 : levels_[0].width; }
+			unsigned int GetHeight(void) const { return levels_.empty() ? 0 : levels_[0].height; }
+			size_t GetNumLevels(void) const { return levels_.size(); }
+			const CompressedLevel &GetLevel(size_t level) const { return levels_[level]; }
+
+		private:
+			std::vector<CompressedLevel> levels_;
+	};
+
+	/* Offline texture conversion: mip generation, BC1 encoding and DDS writing */
+	class TextureCompression
+	{
+		public:
+			// Box-filtered mip chain down to 1x1; level 0 is a copy of the input
+			static void GenerateMipChain(const RgbaImage &image, std::vector<RgbaImage> &levels);
+
+			// BC1 block compression; partial blocks at the borders repeat the edge pixels
+			static size_t GetBc1Size(unsigned int width, unsigned int height);
+			static void EncodeBc1(const RgbaImage &image, unsigned char *out);
+			static void DecodeBc1(const unsigned char *blocks, unsigned int width, unsigned int height, RgbaImage &image);
+
+			// Compress every level and write a DDS file with the whole chain
+			static void WriteDds(const std::vector<RgbaImage> &levels, std::vector<unsigned char> &out);
+
+			// "earth.png" -> "earth.dds"
+			static std::string GetCompressedFileName(const std::string &file_name);
+	};
+
+} // namespace ogre_application;
+
+#endif // TEXTURE_COMPRESSION_H_
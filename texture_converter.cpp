@@ -0,0 +1,170 @@
+#include <iostream>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "OGRE/OgreRoot.h"
+#include "OGRE/OgreImage.h"
+#include "OGRE/OgreDataStream.h"
+#include "OGRE/OgrePixelFormat.h"
+#include "OGRE/OgreTimer.h"
+
+#include "mapped_file.h"
+#include "texture_compression.h"
+
+/* Offline tool that converts the PNG/JPEG textures used by the materials into
+   BC1 compressed DDS files with a full mip chain, and benchmarks both load paths */
+
+using namespace ogre_application;
+
+/* Configuration constants */
+const Ogre::String log_filename_g = "TextureConverter.log";
+const int default_benchmark_iterations_g = 20;
+
+
+/* Read a whole file into memory */
+static bool ReadFile(const std::string &path, std::vector<unsigned char> &bytes){
+
+	std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+	if (!stream){
+		return false;
+	}
+	stream.seekg(0, std::ios::end);
+	bytes.resize((size_t) stream.tellg());
+	stream.seekg(0, std::ios::beg);
+	if (!bytes.empty()){
+		stream.read((char *) &bytes[0], bytes.size());
+	}
+	return !stream.fail();
+}
+
+
+/* Decode a PNG/JPEG file the same way Ogre does at startup and convert it to RGBA */
+static void DecodeImage(const std::string &path, RgbaImage &rgba){
+
+	std::vector<unsigned char> bytes;
+	if (!ReadFile(path, bytes) || bytes.empty()){
+		throw(std::runtime_error("Could not read " + path));
+	}
+
+	Ogre::DataStreamPtr stream(OGRE_NEW Ogre::MemoryDataStream(&bytes[0], bytes.size(), false, true));
+	Ogre::Image image;
+	image.load(stream, path.substr(path.find_last_of('.') + 1));
+
+	rgba.width = (unsigned int) image.getWidth();
+	rgba.height = (unsigned int) image.getHeight();
+	rgba.pixels.resize(rgba.width*rgba.height*4);
+	Ogre::PixelBox destination(rgba.width, rgba.height, 1, Ogre::PF_BYTE_RGBA, &rgba.pixels[0]);
+	Ogre::PixelUtil::bulkPixelConversion(image.getPixelBox(), destination);
+}
+
+
+static void Convert(const std::string &input, const std::string &output){
+
+	RgbaImage image;
+	DecodeImage(input, image);
+
+	std::vector<RgbaImage> levels;
+	TextureCompression::GenerateMipChain(image, levels);
+
+	std::vector<unsigned char> dds;
+	TextureCompression::WriteDds(levels, dds);
+
+	std::ofstream stream(output.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!stream){
+		throw(std::runtime_error("Could not write " + output));
+	}
+	stream.write((const char *) &dds[0], dds.size());
+
+	std::cout << input << " (" << image.width << "x" << image.height << ") -> " << output << ": "
+	          << levels.size() << " levels, " << dds.size() << " bytes" << std::endl;
+}
+
+
+static void Benchmark(const std::string &input, int iterations){
+
+	std::string compressed = TextureCompression::GetCompressedFileName(input);
+	Ogre::Timer timer;
+
+	/* Current path: decode the PNG/JPEG, upload RGBA8 and let the GPU build the mips */
+	RgbaImage image;
+	timer.reset();
+	for (int i = 0; i < iterations; i++){
+		DecodeImage(input, image);
+	}
+	double decode_ms = timer.getMicroseconds()/1000.0/iterations;
+
+	std::vector<RgbaImage> levels;
+	TextureCompression::GenerateMipChain(image, levels);
+	size_t uncompressed_bytes = 0;
+	for (size_t i = 0; i < levels.size(); i++){
+		uncompressed_bytes += levels[i].pixels.size();
+	}
+
+	/* Compressed path: map the DDS and hand the levels to the texture as they are */
+	MappedFile file;
+	DdsTexture dds;
+	timer.reset();
+	for (int i = 0; i < iterations; i++){
+		if (!file.Open(compressed) || !dds.Parse(file.GetData(), file.GetSize())){
+			throw(std::runtime_error("Could not load " + compressed + ", run the converter first"));
+		}
+		file.Close();
+	}
+	double map_ms = timer.getMicroseconds()/1000.0/iterations;
+
+	/* Software fallback: same, but every level is expanded to RGBA8 */
+	file.Open(compressed);
+	dds.Parse(file.GetData(), file.GetSize());
+	RgbaImage decoded;
+	timer.reset();
+	for (int i = 0; i < iterations; i++){
+		for (size_t level = 0; level < dds.GetNumLevels(); level++){
+			const CompressedLevel &compressed_level = dds.GetLevel(level);
+			TextureCompression::DecodeBc1(compressed_level.data, compressed_level.width, compressed_level.height, decoded);
+		}
+	}
+	double fallback_ms = timer.getMicroseconds()/1000.0/iterations;
+	size_t compressed_bytes = file.GetSize() - (size_t) (dds.GetLevel(0).data - file.GetData()); // Payload without the header
+
+	std::cout << input << " (" << image.width << "x" << image.height << ", " << iterations << " iterations)" << std::endl;
+	std::cout << "  decode PNG/JPEG:     " << decode_ms << " ms, " << uncompressed_bytes << " bytes with mips (RGBA8)" << std::endl;
+	std::cout << "  map BC1 DDS:         " << map_ms << " ms, " << compressed_bytes << " bytes with mips (BC1)" << std::endl;
+	std::cout << "  software BC1 decode: " << fallback_ms << " ms, " << uncompressed_bytes << " bytes with mips (RGBA8)" << std::endl;
+	std::cout << "  texture memory:      " << (double) uncompressed_bytes/compressed_bytes << "x smaller" << std::endl;
+}
+
+
+/* Usage:
+     TextureConverter <image> [output.dds]
+     TextureConverter --benchmark <image> [iterations] */
+int main(int argc, char *argv[]){
+
+	try {
+		/* The root registers the image codecs */
+		Ogre::Root root("", "", log_filename_g);
+
+		if (argc >= 3 && std::string(argv[1]) == "--benchmark"){
+			int iterations = (argc >= 4) ? atoi(argv[3]) : default_benchmark_iterations_g;
+			Benchmark(argv[2], std::max(iterations, 1));
+		}
+		else if (argc >= 2){
+			Convert(argv[1], (argc >= 3) ? argv[2] : TextureCompression::GetCompressedFileName(argv[1]));
+		}
+		else {
+			std::cerr << "Usage: TextureConverter <image> [output.dds]" << std::endl;
+			std::cerr << "       TextureConverter --benchmark <image> [iterations]" << std::endl;
+			return 1;
+		}
+	}
+	catch (std::exception &e){
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
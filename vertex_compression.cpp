@@ -0,0 +1,364 @@
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "OGRE/OgreSubMesh.h"
+#include "OGRE/OgreSubEntity.h"
+#include "OGRE/OgreHardwareBufferManager.h"
+#include "OGRE/OgreMath.h"
+
+#include "vertex_compression.h"
+
+namespace ogre_application {
+
+/* Texture coordinates are stored in 1/16384 steps, which covers [-2, 2] */
+const float uv_scale_g = 1.0f/16384.0f;
+const float short_max_g = 32767.0f;
+
+/* Quantization range of each mesh with short4 positions, see SetQuantization() */
+struct QuantizationRange
+{
+	Ogre::Vector3 scale;
+	Ogre::Vector3 bias;
+};
+static std::map<Ogre::String, QuantizationRange> quantization_ranges_g;
+
+
+/* Round and clamp to a signed short */
+static short QuantizeShort(float value){
+
+	value = std::max(-short_max_g, std::min(short_max_g, value));
+	return (short) Ogre::Math::IFloor(value + 0.5f);
+}
+
+
+/* Same mapping as EncodeNormal in GBufferPacking.glsl */
+static void EncodeOctahedral(Ogre::Vector3 n, float &x, float &y){
+
+	n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+	if (n.z >= 0.0f){
+		x = n.x;
+		y = n.y;
+	}
+	else {
+		x = (1.0f - std::abs(n.y))*(n.x >= 0.0f ? 1.0f : -1.0f);
+		y = (1.0f - std::abs(n.x))*(n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+}
+
+
+static Ogre::Vector3 DecodeOctahedral(float x, float y){
+
+	Ogre::Vector3 n(x, y, 1.0f - std::abs(x) - std::abs(y));
+	if (n.z < 0.0f){
+		n.x = (1.0f - std::abs(y))*(x >= 0.0f ? 1.0f : -1.0f);
+		n.y = (1.0f - std::abs(x))*(y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return n.normalisedCopy();
+}
+
+
+/* Rewrite one vertex data set into a single interleaved buffer of the smaller layout */
+static void CompressVertexData(Ogre::VertexData *vertex_data, VertexLayout layout, const Ogre::Vector4 &scale, const Ogre::Vector4 &bias, VertexCompressionStats &stats){
+
+	Ogre::VertexDeclaration *declaration = vertex_data->vertexDeclaration;
+	Ogre::VertexBufferBinding *binding = vertex_data->vertexBufferBinding;
+	size_t num_vertices = vertex_data->vertexCount;
+
+	/* Read back the current buffers */
+	std::map<unsigned short, std::vector<unsigned char> > sources;
+	const Ogre::VertexBufferBinding::VertexBufferBindingMap &bindings = binding->getBindings();
+	for (Ogre::VertexBufferBinding::VertexBufferBindingMap::const_iterator it = bindings.begin(); it != bindings.end(); ++it){
+		std::vector<unsigned char> &bytes = sources[it->first];
+		bytes.resize(it->second->getSizeInBytes());
+		it->second->readData(0, bytes.size(), &bytes[0]);
+		stats.bytes_before += bytes.size();
+	}
+
+	/* New type of every element */
+	Ogre::VertexDeclaration::VertexElementList elements = declaration->getElements();
+	std::vector<Ogre::VertexElementType> types;
+	std::vector<size_t> offsets;
+	size_t vertex_size = 0;
+	for (Ogre::VertexDeclaration::VertexElementList::const_iterator it = elements.begin(); it != elements.end(); ++it){
+		Ogre::VertexElementType type = it->getType();
+		if (it->getSemantic() == Ogre::VES_POSITION && type == Ogre::VET_FLOAT3 && layout == VERTEX_LAYOUT_QUANTIZED){
+			type = Ogre::VET_SHORT4;
+		}
+		else if (it->getSemantic() == Ogre::VES_NORMAL && type == Ogre::VET_FLOAT3){
+			type = Ogre::VET_SHORT2;
+		}
+		else if (it->getSemantic() == Ogre::VES_TEXTURE_COORDINATES && type == Ogre::VET_FLOAT2){
+			type = Ogre::VET_SHORT2;
+		}
+		types.push_back(type);
+		offsets.push_back(vertex_size);
+		vertex_size += Ogre::VertexElement::getTypeSize(type);
+	}
+
+	/* Convert every vertex and measure what the shader will decode */
+	std::vector<unsigned char> output(vertex_size*num_vertices);
+	for (size_t v = 0; v < num_vertices; v++){
+		size_t e = 0;
+		for (Ogre::VertexDeclaration::VertexElementList::const_iterator it = elements.begin(); it != elements.end(); ++it, ++e){
+			unsigned char *source = &sources[it->getSource()][v*declaration->getVertexSize(it->getSource()) + it->getOffset()];
+			unsigned char *target = &output[v*vertex_size + offsets[e]];
+			const float *value = (const float *) source;
+			short *packed = (short *) target;
+
+			if (types[e] == it->getType()){
+				memcpy(target, source, Ogre::VertexElement::getTypeSize(types[e]));
+			}
+			else if (it->getSemantic() == Ogre::VES_POSITION){
+				Ogre::Vector3 decoded;
+				for (int k = 0; k < 3; k++){
+					packed[k] = (scale[k] > 0.0f) ? QuantizeShort((value[k] - bias[k])/scale[k]) : 0;
+					decoded[k] = packed[k]*scale[k] + bias[k];
+				}
+				packed[3] = 0;
+				stats.max_position_error = std::max(stats.max_position_error, decoded.distance(Ogre::Vector3(value)));
+			}
+			else if (it->getSemantic() == Ogre::VES_NORMAL){
+				Ogre::Vector3 normal = Ogre::Vector3(value).normalisedCopy();
+				float x, y;
+				EncodeOctahedral(normal, x, y);
+				packed[0] = QuantizeShort(x*short_max_g);
+				packed[1] = QuantizeShort(y*short_max_g);
+				Ogre::Vector3 decoded = DecodeOctahedral(packed[0]/short_max_g, packed[1]/short_max_g);
+				float error = normal.angleBetween(decoded).valueDegrees();
+				stats.max_normal_error = std::max(stats.max_normal_error, error);
+			}
+			else {
+				for (int k = 0; k < 2; k++){
+					packed[k] = QuantizeShort(value[k]/uv_scale_g);
+					stats.max_uv_error = std::max(stats.max_uv_error, std::abs(packed[k]*uv_scale_g - value[k]));
+				}
+			}
+		}
+	}
+
+	/* Swap in the new buffer */
+	Ogre::HardwareVertexBufferSharedPtr buffer = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
+		vertex_size, num_vertices, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	if (num_vertices > 0){
+		buffer->writeData(0, buffer->getSizeInBytes(), &output[0], true);
+	}
+	stats.bytes_after += buffer->getSizeInBytes();
+	stats.num_vertices += num_vertices;
+
+	declaration->removeAllElements();
+	size_t e = 0;
+	for (Ogre::VertexDeclaration::VertexElementList::const_iterator it = elements.begin(); it != elements.end(); ++it, ++e){
+		declaration->addElement(0, offsets[e], types[e], it->getSemantic(), it->getIndex());
+	}
+	binding->unsetAllBindings();
+	binding->setBinding(0, buffer);
+}
+
+
+void VertexCompression::Compress(const Ogre::MeshPtr &mesh, VertexLayout layout, VertexCompressionStats *stats){
+
+	VertexCompressionStats local_stats;
+	if (!stats){
+		stats = &local_stats;
+	}
+	stats->num_vertices = 0;
+	stats->bytes_before = 0;
+	stats->bytes_after = 0;
+	stats->max_position_error = 0.0f;
+	stats->max_normal_error = 0.0f;
+	stats->max_uv_error = 0.0f;
+
+	/* Generated meshes are built in the full layout */
+	if (layout == VERTEX_LAYOUT_FULL){
+		return;
+	}
+
+	/* Positions are scaled to the bounds, which the mesh keeps unchanged for culling */
+	Ogre::Vector4 scale(1.0f, 1.0f, 1.0f, 1.0f);
+	Ogre::Vector4 bias(0.0f, 0.0f, 0.0f, uv_scale_g);
+	if (layout == VERTEX_LAYOUT_QUANTIZED){
+		const Ogre::AxisAlignedBox &bounds = mesh->getBounds();
+		Ogre::Vector3 center = bounds.getCenter();
+		Ogre::Vector3 half_size = bounds.getHalfSize()/short_max_g;
+		scale = Ogre::Vector4(half_size.x, half_size.y, half_size.z, 1.0f);
+		bias = Ogre::Vector4(center.x, center.y, center.z, uv_scale_g);
+		SetQuantization(mesh->getName(), half_size, center);
+	}
+
+	if (mesh->sharedVertexData){
+		CompressVertexData(mesh->sharedVertexData, layout, scale, bias, *stats);
+	}
+	for (unsigned short i = 0; i < mesh->getNumSubMeshes(); i++){
+		Ogre::SubMesh *sub_mesh = mesh->getSubMesh(i);
+		if (!sub_mesh->useSharedVertices){
+			CompressVertexData(sub_mesh->vertexData, layout, scale, bias, *stats);
+		}
+	}
+}
+
+
+void VertexCompression::GetDecode(const Ogre::MeshPtr &mesh, Ogre::Vector4 &scale, Ogre::Vector4 &bias){
+
+	scale = Ogre::Vector4(1.0f, 1.0f, 1.0f, 0.0f);
+	bias = Ogre::Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	/* All vertex data of a mesh share one layout, so the first one tells */
+	Ogre::VertexData *vertex_data = mesh->sharedVertexData;
+	if (!vertex_data && mesh->getNumSubMeshes() > 0){
+		vertex_data = mesh->getSubMesh(0)->vertexData;
+	}
+	if (!vertex_data){
+		return;
+	}
+
+	const Ogre::VertexElement *position = vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_POSITION);
+	if (position && position->getType() == Ogre::VET_SHORT4){
+		/* Bounds are padded again each time they are set, so they only stand in for meshes
+		   quantized without Compress() */
+		Ogre::Vector3 half_size, center;
+		if (!GetQuantization(mesh->getName(), half_size, center)){
+			const Ogre::AxisAlignedBox &bounds = mesh->getBounds();
+			center = bounds.getCenter();
+			half_size = bounds.getHalfSize()/short_max_g;
+		}
+		scale = Ogre::Vector4(half_size.x, half_size.y, half_size.z, 0.0f);
+		bias = Ogre::Vector4(center.x, center.y, center.z, 1.0f);
+	}
+	const Ogre::VertexElement *normal = vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_NORMAL);
+	if (normal && normal->getType() == Ogre::VET_SHORT2){
+		scale.w = 1.0f;
+	}
+	const Ogre::VertexElement *uv = vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_TEXTURE_COORDINATES);
+	if (uv && uv->getType() == Ogre::VET_SHORT2){
+		bias.w = uv_scale_g;
+	}
+}
+
+
+void VertexCompression::SetQuantization(const Ogre::String &mesh_name, const Ogre::Vector3 &scale, const Ogre::Vector3 &bias){
+
+	QuantizationRange &range = quantization_ranges_g[mesh_name];
+	range.scale = scale;
+	range.bias = bias;
+}
+
+
+bool VertexCompression::GetQuantization(const Ogre::String &mesh_name, Ogre::Vector3 &scale, Ogre::Vector3 &bias){
+
+	std::map<Ogre::String, QuantizationRange>::const_iterator it = quantization_ranges_g.find(mesh_name);
+	if (it == quantization_ranges_g.end()){
+		return false;
+	}
+	scale = it->second.scale;
+	bias = it->second.bias;
+	return true;
+}
+
+
+void VertexCompression::Decode(const Ogre::MeshPtr &mesh, Ogre::VertexData *vertex_data, DecodedVertices &vertices){
+
+	Ogre::Vector4 scale, bias;
+	GetDecode(mesh, scale, bias);
+
+	size_t num_vertices = vertex_data->vertexCount;
+	vertices.positions.assign(num_vertices, Ogre::Vector3::ZERO);
+	vertices.normals.assign(num_vertices, Ogre::Vector3::UNIT_Z);
+	vertices.colours.assign(num_vertices, 0xFFFFFFFF);
+	vertices.uvs.assign(num_vertices, Ogre::Vector2::ZERO);
+
+	const Ogre::VertexBufferBinding::VertexBufferBindingMap &bindings = vertex_data->vertexBufferBinding->getBindings();
+	for (Ogre::VertexBufferBinding::VertexBufferBindingMap::const_iterator it = bindings.begin(); it != bindings.end(); ++it){
+		std::vector<unsigned char> bytes(it->second->getSizeInBytes());
+		if (bytes.empty()){
+			continue;
+		}
+		it->second->readData(0, bytes.size(), &bytes[0]);
+
+		Ogre::VertexDeclaration::VertexElementList elements = vertex_data->vertexDeclaration->findElementsBySource(it->first);
+		size_t vertex_size = it->second->getVertexSize();
+		for (size_t v = 0; v < num_vertices; v++){
+			for (Ogre::VertexDeclaration::VertexElementList::const_iterator e = elements.begin(); e != elements.end(); ++e){
+				const unsigned char *source = &bytes[v*vertex_size + e->getOffset()];
+				const float *value = (const float *) source;
+				const short *packed = (const short *) source;
+
+				if (e->getSemantic() == Ogre::VES_POSITION){
+					if (e->getType() == Ogre::VET_SHORT4){
+						vertices.positions[v] = Ogre::Vector3(packed[0]*scale.x + bias.x, packed[1]*scale.y + bias.y, packed[2]*scale.z + bias.z);
+					}
+					else {
+						vertices.positions[v] = Ogre::Vector3(value);
+					}
+				}
+				else if (e->getSemantic() == Ogre::VES_NORMAL){
+					if (e->getType() == Ogre::VET_SHORT2){
+						vertices.normals[v] = DecodeOctahedral(packed[0]/short_max_g, packed[1]/short_max_g);
+					}
+					else {
+						vertices.normals[v] = Ogre::Vector3(value);
+					}
+				}
+				else if (e->getSemantic() == Ogre::VES_DIFFUSE){
+					memcpy(&vertices.colours[v], source, sizeof(Ogre::uint32));
+				}
+				else if (e->getSemantic() == Ogre::VES_TEXTURE_COORDINATES && e->getIndex() == 0){
+					if (e->getType() == Ogre::VET_SHORT2){
+						vertices.uvs[v] = Ogre::Vector2(packed[0]*bias.w, packed[1]*bias.w);
+					}
+					else {
+						vertices.uvs[v] = Ogre::Vector2(value[0], value[1]);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void VertexCompression::ApplyDecode(Ogre::Entity *entity){
+
+	Ogre::Vector4 scale, bias;
+	GetDecode(entity->getMesh(), scale, bias);
+	ApplyDecode(entity, scale, bias);
+}
+
+
+void VertexCompression::ApplyDecode(Ogre::Entity *entity, const Ogre::Vector4 &scale, const Ogre::Vector4 &bias){
+
+	for (unsigned int i = 0; i < entity->getNumSubEntities(); i++){
+		entity->getSubEntity(i)->setCustomParameter(0, scale);
+		entity->getSubEntity(i)->setCustomParameter(1, bias);
+	}
+}
+
+
+Ogre::String VertexCompression::GetLayoutName(VertexLayout layout){
+
+	switch (layout){
+		case VERTEX_LAYOUT_COMPACT:
+			return "compact";
+		case VERTEX_LAYOUT_QUANTIZED:
+			return "quantized";
+		default:
+			return "full";
+	}
+}
+
+
+bool VertexCompression::ParseLayoutName(const Ogre::String &name, VertexLayout &layout){
+
+	const VertexLayout layouts[] = { VERTEX_LAYOUT_FULL, VERTEX_LAYOUT_COMPACT, VERTEX_LAYOUT_QUANTIZED };
+	for (int i = 0; i < 3; i++){
+		if (name == GetLayoutName(layouts[i])){
+			layout = layouts[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,67 @@
+#ifndef VERTEX_COMPRESSION_H_
+#define VERTEX_COMPRESSION_H_
+
+#include <vector>
+
+#include "OGRE/OgreMesh.h"
+#include "OGRE/OgreEntity.h"
+#include "OGRE/OgreString.h"
+
+namespace ogre_application {
+
+	/* Vertex formats of the generated meshes */
+	enum VertexLayout {
+		VERTEX_LAYOUT_FULL, // float3 position and normal, float2 texture coordinates
+		VERTEX_LAYOUT_COMPACT, // float3 position, octahedral short2 normal, short2 texture coordinates
+		VERTEX_LAYOUT_QUANTIZED // As compact, with short4 positions scaled to the mesh bounds
+	};
+
+	/* Accuracy and size of a compressed mesh */
+	struct VertexCompressionStats
+	{
+		size_t num_vertices;
+		size_t bytes_before; // Vertex buffer sizes
+		size_t bytes_after;
+		float max_position_error; // In mesh units
+		float max_normal_error; // In degrees
+		float max_uv_error;
+	};
+
+	/* Attributes of a vertex data set, decoded from any layout */
+	struct DecodedVertices
+	{
+		std::vector<Ogre::Vector3> positions;
+		std::vector<Ogre::Vector3> normals;
+		std::vector<Ogre::uint32> colours; // Packed as in the vertex buffer, white if there were none
+		std::vector<Ogre::Vector2> uvs; // Zero if there were none
+	};
+
+	/* Rewrites the vertex buffers of a mesh in a smaller layout */
+	/* Colours are already packed into four bytes by ManualObject and are kept. The shaders
+	   decode the other attributes with the per-entity parameters set by ApplyDecode, so
+	   meshes of different layouts can share a material */
+	class VertexCompression
+	{
+		public:
+			static void Compress(const Ogre::MeshPtr &mesh, VertexLayout layout, VertexCompressionStats *stats = NULL);
+
+			// Set the decode parameters of VertexDecode.glsl on every subentity; needed for every layout
+			static void ApplyDecode(Ogre::Entity *entity);
+			// Same with the parameters of GetDecode(), for many entities of one mesh
+			static void ApplyDecode(Ogre::Entity *entity, const Ogre::Vector4 &scale, const Ogre::Vector4 &bias);
+			// Parameters for the layout of a mesh: scale.xyz, octahedral normal flag; bias.xyz, uv scale
+			static void GetDecode(const Ogre::MeshPtr &mesh, Ogre::Vector4 &scale, Ogre::Vector4 &bias);
+			// Range the short4 positions of a mesh were scaled to, kept by mesh name; Compress()
+			// sets it, and MeshCache stores it with the mesh, since Ogre pads the bounds it came from
+			static void SetQuantization(const Ogre::String &mesh_name, const Ogre::Vector3 &scale, const Ogre::Vector3 &bias);
+			static bool GetQuantization(const Ogre::String &mesh_name, Ogre::Vector3 &scale, Ogre::Vector3 &bias);
+			// Read back and decode the vertices of one of the mesh's vertex data sets
+			static void Decode(const Ogre::MeshPtr &mesh, Ogre::VertexData *vertex_data, DecodedVertices &vertices);
+
+			static Ogre::String GetLayoutName(VertexLayout layout);
+			static bool ParseLayoutName(const Ogre::String &name, VertexLayout &layout);
+	};
+
+} // namespace ogre_application;
+
+#endif // VERTEX_COMPRESSION_H_
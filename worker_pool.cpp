@@ -0,0 +1,130 @@
+#include "worker_pool.h"
+
+namespace ogre_application {
+
+
+WorkerPool::WorkerPool(void){
+
+	task_ = NULL;
+	count_ = 0;
+	next_index_ = 0;
+	num_busy_workers_ = 0;
+	generation_ = 0;
+	quit_ = false;
+}
+
+
+WorkerPool::~WorkerPool(void){
+
+	Shutdown();
+}
+
+
+void WorkerPool::Init(int num_threads){
+
+	Shutdown();
+
+	if (num_threads <= 0){
+		num_threads = (int) std::thread::hardware_concurrency();
+	}
+	if (num_threads <= 0){
+		num_threads = 1;
+	}
+
+	quit_ = false;
+	for (int i = 1; i < num_threads; i++){
+		workers_.push_back(std::thread(&WorkerPool::WorkerMain, this, generation_));
+	}
+}
+
+
+void WorkerPool::Shutdown(void){
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	work_ready_.notify_all();
+
+	for (size_t i = 0; i < workers_.size(); i++){
+		workers_[i].join();
+	}
+	workers_.clear();
+}
+
+
+void WorkerPool::ParallelFor(int count, const Task &task){
+
+	if (count <= 0){
+		return;
+	}
+
+	/* Not worth waking anyone up */
+	if (workers_.empty() || count == 1){
+		for (int i = 0; i < count; i++){
+			task(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		task_ = &task;
+		count_ = count;
+		next_index_ = 0;
+		num_busy_workers_ = (int) workers_.size();
+		generation_++;
+	}
+	work_ready_.notify_all();
+
+	RunItems();
+
+	/* Wait for the workers so the task can safely go out of scope */
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (num_busy_workers_ > 0){
+		work_done_.wait(lock);
+	}
+	task_ = NULL;
+}
+
+
+void WorkerPool::RunItems(void){
+
+	/* Items are handed out one at a time, which balances uneven items */
+	for (;;){
+		int index = next_index_++;
+		if (index >= count_){
+			break;
+		}
+		(*task_)(index);
+	}
+}
+
+
+void WorkerPool::WorkerMain(unsigned int start_generation){
+
+	unsigned int seen_generation = start_generation;
+	for (;;){
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (!quit_ && generation_ == seen_generation){
+				work_ready_.wait(lock);
+			}
+			if (quit_){
+				return;
+			}
+			seen_generation = generation_;
+		}
+
+		RunItems();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			num_busy_workers_--;
+		}
+		work_done_.notify_one();
+	}
+}
+
+
+} // namespace ogre_application;
@@ -0,0 +1,53 @@
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+namespace ogre_application {
+
+	/* Small pool of persistent worker threads for data-parallel loops */
+	/* The calling thread takes part in the work, so a pool of one thread runs everything inline */
+	class WorkerPool
+	{
+		public:
+			typedef std::function<void(int)> Task; // Called once per item index
+
+			WorkerPool(void);
+			~WorkerPool(void);
+
+			void Init(int num_threads); // 0 picks one thread per hardware core
+			int GetNumThreads(void) const { return (int) workers_.size() + 1; }
+
+			// Run task(i) for every i in [0, count) and wait until all of them finished
+			void ParallelFor(int count, const Task &task);
+
+		private:
+			std::vector<std::thread> workers_;
+			std::mutex mutex_;
+			std::condition_variable work_ready_;
+			std::condition_variable work_done_;
+
+			// State of the loop that is currently running
+			const Task *task_;
+			int count_;
+			std::atomic<int> next_index_;
+			int num_busy_workers_;
+			unsigned int generation_; // Incremented for every loop so workers wake up exactly once
+			bool quit_;
+
+			void WorkerMain(unsigned int start_generation);
+			void RunItems(void);
+			void Shutdown(void);
+
+			WorkerPool(const WorkerPool &);
+			WorkerPool &operator=(const WorkerPool &);
+	};
+
+} // namespace ogre_application;
+
+#endif // WORKER_POOL_H_